@@ -0,0 +1,260 @@
+/**
+ * @brief Benchmark of the front end, times preprocess, to_upper_str, tokenize
+ * and parse_list separately on synthetic sources and prints the throughput
+ * of every stage
+ *
+ * Usage: frontend [megabytes] [repetitions]
+ *
+ * Every stage runs on the output of the previous one, which is prepared
+ * outside the timed part. The best of the repetitions is reported.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include "ast.h"
+#include "err.h"
+#include "lexer.h"
+#include "parser.h"
+#include "preproc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_MEGABYTES 4
+#define DEFAULT_REPETITIONS 5
+
+/* depth of every expression of the nested source */
+#define NESTING_DEPTH 500
+
+/**
+ * @brief Growing buffer of a generated source
+ */
+struct buffer {
+  char *data;
+  size_t length;
+  size_t capacity;
+};
+
+/**
+ * @brief Appends a string to the buffer
+ *
+ * @param buf to append to
+ * @param text to append
+ * @return int 0 on success, -1 when out of memory
+ */
+static int append(struct buffer *buf, const char *text) {
+  size_t length = strlen(text);
+  char *data;
+
+  if (buf->length + length + 1 > buf->capacity) {
+    buf->capacity = 2 * (buf->length + length + 1);
+    data = realloc(buf->data, buf->capacity);
+    if (!data)
+      return -1;
+    buf->data = data;
+  }
+  memcpy(buf->data + buf->length, text, length + 1);
+  buf->length += length;
+  return 0;
+}
+
+/**
+ * @brief Appends one line of quoted numbers, integers and floats
+ *
+ * @param buf to append to
+ * @param line index of the line, varies the numbers
+ * @return int 0 on success
+ */
+static int gen_numeric(struct buffer *buf, long line) {
+  char item[32];
+  int err = append(buf, "(set 'data '(");
+  for (long i = 0; !err && i < 16; i++) {
+    snprintf(item, sizeof(item), i % 4 ? " %ld" : " %ld.25",
+             (line * 7919 + i * 13) % 1000003);
+    err = append(buf, item);
+  }
+  return err || append(buf, "))\n");
+}
+
+/**
+ * @brief Appends one line of calls with long symbols in lower case
+ *
+ * @param buf to append to
+ * @param line index of the line, varies the symbols
+ * @return int 0 on success
+ */
+static int gen_symbol(struct buffer *buf, long line) {
+  char item[160];
+  snprintf(item, sizeof(item),
+           "(set 'accumulated_value_%ld (max accumulated_value_%ld "
+           "previous_result_%ld intermediate_sum_%ld))\n",
+           line, line % 97, line % 89, line % 83);
+  return append(buf, item);
+}
+
+/**
+ * @brief Appends mostly comments and a short expression
+ *
+ * @param buf to append to
+ * @param line index of the line, varies the expression
+ * @return int 0 on success
+ */
+static int gen_comment(struct buffer *buf, long line) {
+  char item[64];
+  int err = append(buf, "; the comment lines are blanked by preprocess and "
+                        "then skipped by the lexer\n"
+                        ";; ------------------------------------------------"
+                        "--------------------------\n");
+  snprintf(item, sizeof(item), "(inc s %ld) ; running total\n", line % 100);
+  return err || append(buf, item);
+}
+
+/**
+ * @brief Appends one expression NESTING_DEPTH lists deep
+ *
+ * @param buf to append to
+ * @param line index of the line, varies the innermost value
+ * @return int 0 on success
+ */
+static int gen_nested(struct buffer *buf, long line) {
+  char item[32];
+  int err = 0;
+  for (int i = 0; !err && i < NESTING_DEPTH; i++)
+    err = append(buf, "(+ 1 ");
+  snprintf(item, sizeof(item), "%ld", line % 10);
+  err = err || append(buf, item);
+  for (int i = 0; !err && i < NESTING_DEPTH; i++)
+    err = append(buf, ")");
+  return err || append(buf, "\n");
+}
+
+static const struct {
+  const char *name;
+  int (*gen)(struct buffer *buf, long line);
+} inputs[] = {
+    {"numeric", gen_numeric},
+    {"symbol", gen_symbol},
+    {"comment", gen_comment},
+    {"nested", gen_nested},
+};
+
+/**
+ * @brief Seconds of a monotonic clock
+ *
+ * @return double
+ */
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Runs every stage on the source the given count of times
+ *
+ * @param source generated source, not modified
+ * @param length of the source
+ * @param repetitions count of runs of every stage
+ * @param stages out param, best time of each of the four stages
+ * @param token_count out param, count of tokens of the source
+ * @return err_t
+ */
+static err_t run_stages(const char *source, size_t length, int repetitions,
+                        double stages[4], int *token_count) {
+  char *code = malloc(length + 1), **tokens;
+  struct source_span *spans;
+  astnode *root;
+  double start, elapsed[4];
+  int count, curr_tok;
+  err_t err = ERR_NO_ERROR;
+
+  if (!code)
+    return ERR_OUT_OF_MEMORY;
+  for (int i = 0; i < 4; i++)
+    stages[i] = -1;
+
+  for (int rep = 0; !err && rep < repetitions; rep++) {
+    memcpy(code, source, length + 1);
+    start = now();
+    err = preprocess(code);
+    elapsed[0] = now() - start;
+    if (err)
+      break;
+
+    tokens = NULL;
+    spans = NULL;
+    start = now();
+    count = tokenize(code, &tokens, &spans);
+    elapsed[2] = now() - start;
+    if (count < 0) {
+      err = -count;
+      break;
+    }
+
+    start = now();
+    for (int i = 0; i < count; i++)
+      to_upper_str(tokens[i]);
+    elapsed[1] = now() - start;
+
+    root = NULL;
+    curr_tok = 0;
+    start = now();
+    err = parse_list(&root, (const char **)tokens, spans, &curr_tok);
+    elapsed[3] = now() - start;
+    if (!err && curr_tok != count)
+      err = ERR_SYNTAX_ERROR;
+
+    free_node(root);
+    free_tokens(tokens, spans, count);
+    *token_count = count;
+    for (int i = 0; i < 4; i++)
+      if (stages[i] < 0 || elapsed[i] < stages[i])
+        stages[i] = elapsed[i];
+  }
+  free(code);
+  return err;
+}
+
+int main(int argc, char **argv) {
+  static const char *names[4] = {"preprocess", "to_upper_str", "tokenize",
+                                 "parse_list"};
+  long megabytes = DEFAULT_MEGABYTES, repetitions = DEFAULT_REPETITIONS;
+  double stages[4];
+  int token_count = 0;
+  err_t err;
+
+  if (argc > 3 || (argc > 1 && (megabytes = atol(argv[1])) < 1) ||
+      (argc > 2 && (repetitions = atol(argv[2])) < 1)) {
+    fprintf(stderr, "Usage: %s [megabytes] [repetitions]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%-8s %-13s %10s %10s %12s\n", "input", "stage", "ms", "MB/s",
+         "Mtokens/s");
+  for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+    struct buffer buf = {0};
+    err = 0;
+    for (long line = 0; !err && buf.length < (size_t)megabytes << 20; line++)
+      err = inputs[i].gen(&buf, line);
+    if (err) {
+      fprintf(stderr, "%s: out of memory\n", argv[0]);
+      free(buf.data);
+      return 1;
+    }
+
+    err = run_stages(buf.data, buf.length, (int)repetitions, stages,
+                     &token_count);
+    if (err) {
+      fprintf(stderr, "%s: %s input failed with error %d\n", argv[0],
+              inputs[i].name, err);
+      free(buf.data);
+      return 1;
+    }
+
+    for (int s = 0; s < 4; s++)
+      printf("%-8s %-13s %10.2f %10.1f %12.2f\n", inputs[i].name, names[s],
+             stages[s] * 1e3, buf.length / stages[s] / (1 << 20),
+             token_count / stages[s] / 1e6);
+    free(buf.data);
+  }
+  return 0;
+}
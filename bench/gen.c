@@ -0,0 +1,180 @@
+/**
+ * @brief Generator of the benchmark workloads, prints a Lisp program of the
+ * given kind and size to stdout
+ *
+ * Usage: gen <workload> <size>
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Next number of the pseudo random sequence used by the samples,
+ * x = x * 7919 + 13 mod 1000003
+ *
+ * @param x in/out param, the state
+ * @return long
+ */
+static long next_random(long *x) {
+  *x = (*x * 7919 + 13) % 1000003;
+  return *x;
+}
+
+/**
+ * @brief Integer arithmetic in a loop of size iterations
+ *
+ * @param size count of iterations
+ */
+static void gen_arith(long size) {
+  printf("(set 's 0)\n");
+  printf("(set 'x 1)\n");
+  printf("(dotimes (i %ld)\n", size);
+  printf("  (set 'x (+ (* x 7919) 13))\n");
+  printf("  (set 'x (- x (* (/ x 1000003) 1000003)))\n");
+  printf("  (inc s (- x i))\n");
+  printf(")\n");
+  printf("(print s)\n");
+}
+
+/**
+ * @brief Arithmetic like gen_arith in a WHILE loop with an IF, only
+ * operators the first interpreter had, so older trees can run it too. The
+ * modulus keeps every product in 32 bits, the integers of those trees.
+ *
+ * @param size count of iterations
+ */
+static void gen_loop(long size) {
+  printf("(set 's 0)\n");
+  printf("(set 'x 1)\n");
+  printf("(set 'i 0)\n");
+  printf("(while (< i %ld)\n", size);
+  printf("  (set 'x (+ (* x 7919) 13))\n");
+  printf("  (set 'x (- x (* (/ x 10007) 10007)))\n");
+  printf("  (if (> x 5000) (inc s 1) (inc s 2))\n");
+  printf("  (inc i 1)\n");
+  printf(")\n");
+  printf("(print s)\n");
+}
+
+/**
+ * @brief Bubble sort of a literal list of size numbers, the loop of
+ * samples/bubble_sort.lisp
+ *
+ * @param size count of numbers
+ */
+static void gen_bubble(long size) {
+  long x = 1;
+  printf("(set 'arr '(");
+  for (long i = 0; i < size; i++)
+    printf("%s%ld", i % 20 ? " " : "\n  ", next_random(&x));
+  printf("\n))\n");
+  printf("(set 'swapped T)\n");
+  printf("(set 'len (length arr))\n");
+  printf("(while swapped\n");
+  printf("  (set 'i 1)\n");
+  printf("  (set 'swapped nil)\n");
+  printf("  (while (< i len)\n");
+  printf("    (set 'num1 (nth (- i 1) arr))\n");
+  printf("    (set 'num2 (nth i arr))\n");
+  printf("    (if (> num1 num2)\n");
+  printf("      (while T\n");
+  printf("        (set (nth (- i 1) arr) num2)\n");
+  printf("        (set (nth i arr) num1)\n");
+  printf("        (set 'swapped T)\n");
+  printf("        (brk)\n");
+  printf("      )\n");
+  printf("    )\n");
+  printf("    (inc i 1)\n");
+  printf("  )\n");
+  printf(")\n");
+  printf("(print (nth 0 arr))\n");
+}
+
+/**
+ * @brief A quoted literal list of size numbers, mostly parsing
+ *
+ * @param size count of numbers
+ */
+static void gen_literal(long size) {
+  long x = 1;
+  printf("(set 'big '(");
+  for (long i = 0; i < size; i++)
+    printf("%s%ld", i % 20 ? " " : "\n  ", next_random(&x));
+  printf("\n))\n");
+  printf("(print (length big))\n");
+}
+
+/**
+ * @brief An expression nested size levels deep, evaluated a few times
+ *
+ * @param size depth of nesting
+ */
+static void gen_nesting(long size) {
+  printf("(dotimes (i 100)\n");
+  printf("  (set 'depth ");
+  for (long i = 0; i < size; i++)
+    printf("(+ 1 ");
+  printf("0");
+  for (long i = 0; i < size; i++)
+    printf(")");
+  printf(")\n)\n");
+  printf("(print depth)\n");
+}
+
+/**
+ * @brief Sets size distinct variables and reads all of them back
+ *
+ * @param size count of variables
+ */
+static void gen_env(long size) {
+  for (long i = 0; i < size; i++)
+    printf("(set 'v%ld %ld)\n", i, i);
+  printf("(set 's 0)\n");
+  for (long i = 0; i < size; i++)
+    printf("(inc s v%ld)\n", i);
+  printf("(print s)\n");
+}
+
+/**
+ * @brief Size short lines for the REPL, read from stdin one by one
+ *
+ * @param size count of lines
+ */
+static void gen_repl(long size) {
+  printf("(set 's 0)\n");
+  for (long i = 0; i < size; i++)
+    printf("(inc s %ld)\n", i % 100);
+  printf("(print s)\n");
+}
+
+static const struct {
+  const char *name;
+  void (*gen)(long size);
+} workloads[] = {
+    {"arith", gen_arith},     {"loop", gen_loop},   {"bubble", gen_bubble},
+    {"literal", gen_literal}, {"nesting", gen_nesting}, {"env", gen_env},
+    {"repl", gen_repl},
+};
+
+int main(int argc, char **argv) {
+  long size;
+  char *end;
+
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s <workload> <size>\n", argv[0]);
+    return 1;
+  }
+  size = strtol(argv[2], &end, 10);
+  if (*end || size < 0) {
+    fprintf(stderr, "%s: invalid size %s\n", argv[0], argv[2]);
+    return 1;
+  }
+  for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+    if (!strcmp(workloads[i].name, argv[1])) {
+      workloads[i].gen(size);
+      return 0;
+    }
+  }
+  fprintf(stderr, "%s: unknown workload %s\n", argv[0], argv[1]);
+  return 1;
+}
@@ -0,0 +1,366 @@
+/**
+ * @brief Benchmark harness, generates the workloads, runs every one of them
+ * several times and compares the results with a stored baseline
+ *
+ * Usage: harness <interpreter> <gen> <workdir> <baseline.json> <results.json>
+ *                [scripts]
+ *
+ * BENCH_RUNS sets the count of timed runs per workload, 5 by default.
+ * BENCH_SLOW=1 adds the workloads that take minutes, among them every .lisp
+ * script of the scripts directory.
+ */
+#define _DEFAULT_SOURCE
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_RUNS 5
+#define MAX_RUNS 100
+#define MAX_SCRIPTS 256
+
+/* a median slower than the baseline by more than this is reported */
+#define REGRESSION_PERCENT 10.0
+
+/**
+ * @brief A workload, the generator kind and size and how it is run
+ */
+struct workload {
+  const char *name;
+  const char *kind; /**< NULL for a script */
+  const char *size; /**< path of the script for a script */
+  int from_stdin;   /**< fed to the REPL instead of run as a file */
+  int slow;         /**< only run with BENCH_SLOW=1 */
+};
+
+static const struct workload workloads[] = {
+    {"arith_1m", "arith", "1000000", 0, 0},
+    {"loop_1m", "loop", "1000000", 0, 0},
+    {"bubble_1k", "bubble", "1000", 0, 0},
+    {"bubble_10k", "bubble", "10000", 0, 1},
+    {"literal_1m", "literal", "1000000", 0, 0},
+    {"nesting_10k", "nesting", "10000", 0, 0},
+    {"env_10k", "env", "10000", 0, 0},
+    {"repl_100k", "repl", "100000", 1, 0},
+};
+
+/**
+ * @brief Results of a workload
+ */
+struct result {
+  double median_ms;
+  double p95_ms;
+  long peak_rss_kb;
+  long long allocs;
+};
+
+/**
+ * @brief Runs a program and waits for it
+ *
+ * @param argv program and its arguments, NULL terminated
+ * @param in path of the file for stdin or NULL
+ * @param out path of the file for stdout, /dev/null if NULL
+ * @param wall_ms out param, wall time of the run or NULL
+ * @param rss_kb out param, peak resident set size of the child or NULL
+ * @return int exit status of the program, -1 if it could not be run
+ */
+static int run_child(char *const argv[], const char *in, const char *out,
+                     double *wall_ms, long *rss_kb) {
+  struct timespec start, end;
+  struct rusage usage;
+  int status, fd;
+  pid_t pid;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  pid = fork();
+  if (pid < 0)
+    return -1;
+  if (!pid) {
+    fd = open(in ? in : "/dev/null", O_RDONLY);
+    if (fd < 0 || dup2(fd, STDIN_FILENO) < 0)
+      _exit(127);
+    fd = open(out ? out : "/dev/null", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || dup2(fd, STDOUT_FILENO) < 0)
+      _exit(127);
+    if (!out && dup2(fd, STDERR_FILENO) < 0)
+      _exit(127);
+    execv(argv[0], argv);
+    _exit(127);
+  }
+  if (wait4(pid, &status, 0, &usage) < 0)
+    return -1;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  if (wall_ms)
+    *wall_ms = (end.tv_sec - start.tv_sec) * 1e3 +
+               (end.tv_nsec - start.tv_nsec) / 1e6;
+  if (rss_kb)
+    *rss_kb = usage.ru_maxrss;
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/**
+ * @brief Orders doubles ascending
+ *
+ * @param a pointer to a double
+ * @param b pointer to a double
+ * @return int
+ */
+static int by_value(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * @brief Sums the allocations of all operators in a JSON profile written by
+ * the -p flag of the interpreter
+ *
+ * @param path of the profile
+ * @return long long the sum or -1 if the profile could not be read
+ */
+static long long sum_allocs(const char *path) {
+  char line[512], *field;
+  long long sum = 0;
+  FILE *in = fopen(path, "r");
+
+  if (!in)
+    return -1;
+  while (fgets(line, sizeof(line), in)) {
+    field = strstr(line, "\"allocs\": ");
+    if (field)
+      sum += atoll(field + strlen("\"allocs\": "));
+  }
+  fclose(in);
+  return sum;
+}
+
+/**
+ * @brief Reads the median of a workload from a results file, which holds one
+ * workload per line
+ *
+ * @param path of the results file
+ * @param name of the workload
+ * @return double the median in ms or a negative number if missing
+ */
+static double baseline_median(const char *path, const char *name) {
+  char line[512], key[128], *field;
+  double median = -1;
+  FILE *in = fopen(path, "r");
+
+  if (!in)
+    return -1;
+  snprintf(key, sizeof(key), "\"name\": \"%s\"", name);
+  while (fgets(line, sizeof(line), in)) {
+    field = strstr(line, "\"median_ms\": ");
+    if (strstr(line, key) && field) {
+      median = atof(field + strlen("\"median_ms\": "));
+      break;
+    }
+  }
+  fclose(in);
+  return median;
+}
+
+/**
+ * @brief Orders strings ascending
+ *
+ * @param a pointer to a string
+ * @param b pointer to a string
+ * @return int
+ */
+static int by_name(const void *a, const void *b) {
+  return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * @brief Lists the .lisp scripts of a directory as slow workloads named by
+ * the file without the extension
+ *
+ * @param dir directory of the scripts
+ * @param scripts out param, the workloads, names and paths are allocated
+ * @return int count of the scripts, -1 if the directory could not be read
+ */
+static int list_scripts(const char *dir, struct workload *scripts) {
+  char *files[MAX_SCRIPTS], path[1024];
+  struct dirent *entry;
+  size_t length;
+  int count = 0;
+  DIR *in = opendir(dir);
+
+  if (!in)
+    return -1;
+  while ((entry = readdir(in)) && count < MAX_SCRIPTS) {
+    length = strlen(entry->d_name);
+    if (length > 5 && !strcmp(entry->d_name + length - 5, ".lisp"))
+      files[count++] = strdup(entry->d_name);
+  }
+  closedir(in);
+  /* the order of readdir is arbitrary */
+  qsort(files, count, sizeof(char *), by_name);
+
+  for (int i = 0; i < count; i++) {
+    snprintf(path, sizeof(path), "%s/%s", dir, files[i]);
+    files[i][strlen(files[i]) - 5] = '\0';
+    scripts[i].name = files[i];
+    scripts[i].kind = NULL;
+    scripts[i].size = strdup(path);
+    scripts[i].from_stdin = 0;
+    scripts[i].slow = 1;
+  }
+  return count;
+}
+
+/**
+ * @brief Generates a workload and measures it, scripts are run as they are
+ *
+ * @param work the workload
+ * @param interpreter path of the interpreter
+ * @param gen path of the generator
+ * @param workdir directory for the generated files
+ * @param runs count of timed runs
+ * @param res out param, the results
+ * @return int 0 on success
+ */
+static int measure(const struct workload *work, char *interpreter, char *gen,
+                   const char *workdir, int runs, struct result *res) {
+  char source[1024], profile[1024];
+  double times[MAX_RUNS];
+  long rss;
+
+  snprintf(source, sizeof(source), "%s/%s.lisp", workdir, work->name);
+  snprintf(profile, sizeof(profile), "%s/%s.prof.json", workdir, work->name);
+
+  if (!work->kind) {
+    snprintf(source, sizeof(source), "%s", work->size);
+  } else {
+    char *gen_argv[] = {gen, (char *)work->kind, (char *)work->size, NULL};
+    if (run_child(gen_argv, NULL, source, NULL, NULL))
+      return -1;
+  }
+
+  char *file_argv[] = {interpreter, source, NULL};
+  char *repl_argv[] = {interpreter, NULL};
+  char *const *argv = work->from_stdin ? repl_argv : file_argv;
+  const char *in = work->from_stdin ? source : NULL;
+
+  res->peak_rss_kb = 0;
+  for (int i = 0; i < runs; i++) {
+    if (run_child(argv, in, NULL, &times[i], &rss))
+      return -1;
+    if (rss > res->peak_rss_kb)
+      res->peak_rss_kb = rss;
+  }
+  qsort(times, runs, sizeof(double), by_value);
+  res->median_ms = runs % 2 ? times[runs / 2]
+                            : (times[runs / 2 - 1] + times[runs / 2]) / 2;
+  res->p95_ms = times[(runs * 95 + 99) / 100 - 1];
+
+  /* allocations come from an untimed run, profiling slows it down */
+  res->allocs = -1;
+  if (!work->from_stdin) {
+    char *prof_argv[] = {interpreter, source, "--profile-out", profile,
+                         NULL};
+    if (!run_child(prof_argv, NULL, NULL, NULL, NULL))
+      res->allocs = sum_allocs(profile);
+  }
+  return 0;
+}
+
+/**
+ * @brief Measures a workload, prints it with its change against the baseline
+ * and appends it to the results
+ *
+ * @param work the workload
+ * @param argv arguments of the harness
+ * @param runs count of timed runs
+ * @param out results file
+ * @param first in/out param, nonzero until the first result is written
+ * @return int 0 on success
+ */
+static int report(const struct workload *work, char **argv, int runs,
+                  FILE *out, int *first) {
+  struct result res;
+  double base;
+
+  if (measure(work, argv[1], argv[2], argv[3], runs, &res)) {
+    printf("%-12s failed\n", work->name);
+    return -1;
+  }
+
+  base = baseline_median(argv[4], work->name);
+  printf("%-12s %10.1f %10.1f %10ld %12lld", work->name, res.median_ms,
+         res.p95_ms, res.peak_rss_kb, res.allocs);
+  if (base > 0) {
+    double change = 100.0 * (res.median_ms - base) / base;
+    printf(" %10.1f %+7.1f%%%s\n", base, change,
+           change > REGRESSION_PERCENT ? "  slower" : "");
+  } else {
+    printf(" %10s %8s\n", "-", "-");
+  }
+
+  fprintf(out,
+          "%s    {\"name\": \"%s\", \"median_ms\": %.1f, \"p95_ms\": %.1f, "
+          "\"peak_rss_kb\": %ld, \"allocs\": %lld}",
+          *first ? "" : ",\n", work->name, res.median_ms, res.p95_ms,
+          res.peak_rss_kb, res.allocs);
+  *first = 0;
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  static struct workload scripts[MAX_SCRIPTS];
+  int runs = DEFAULT_RUNS, slow = 0, failed = 0, script_count = 0, first = 1;
+  FILE *out;
+
+  if (argc != 6 && argc != 7) {
+    fprintf(stderr,
+            "Usage: %s <interpreter> <gen> <workdir> <baseline.json> "
+            "<results.json> [scripts]\n",
+            argv[0]);
+    return 1;
+  }
+  if (getenv("BENCH_RUNS"))
+    runs = atoi(getenv("BENCH_RUNS"));
+  if (runs < 1 || runs > MAX_RUNS) {
+    fprintf(stderr, "%s: BENCH_RUNS must be 1 to %d\n", argv[0], MAX_RUNS);
+    return 1;
+  }
+  slow = getenv("BENCH_SLOW") && !strcmp(getenv("BENCH_SLOW"), "1");
+  if (slow && argc == 7) {
+    script_count = list_scripts(argv[6], scripts);
+    if (script_count < 0) {
+      perror(argv[6]);
+      return 1;
+    }
+  }
+  mkdir(argv[3], 0755);
+
+  out = fopen(argv[5], "w");
+  if (!out) {
+    perror(argv[5]);
+    return 1;
+  }
+  fprintf(out, "{\n  \"runs\": %d,\n  \"workloads\": [\n", runs);
+
+  printf("%-12s %10s %10s %10s %12s %10s %8s\n", "workload", "median ms",
+         "p95 ms", "rss KB", "allocs", "base ms", "change");
+  for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+    if (workloads[i].slow && !slow)
+      continue;
+    if (report(&workloads[i], argv, runs, out, &first))
+      failed = 1;
+  }
+  for (int i = 0; i < script_count; i++)
+    if (report(&scripts[i], argv, runs, out, &first))
+      failed = 1;
+  fprintf(out, "\n  ]\n}\n");
+  fclose(out);
+  return failed;
+}
@@ -0,0 +1,13 @@
+; 64-bit sums stay on the fixnum path, factorials promote to bignums and
+; the large squares go through Karatsuba multiplication
+(print (sum (range 0 1000000)))
+(set 'f 1)
+(dotimes (i 3000)
+  (set 'f (* f (+ i 1)))
+)
+(set 'g (* f f))
+(dotimes (i 3000)
+  (set 'g (/ g (+ i 1)))
+)
+(print (= f g))
+(print (product (range 1 31)))
@@ -0,0 +1,10 @@
+; histogram and per-key totals of 10M rows with 1024 distinct keys, compare
+; with the interpreted loop of bench_count_by_loop.lisp
+(set 'rows (make-vector (range 0 10000000)))
+; i * 2^54 wraps around to (i mod 1024) * 2^54
+(set 'keys (v* rows 18014398509481984))
+(set 'counts (count-by keys))
+(set 'sums (sum-by keys rows))
+(print (length counts))
+(print (gethash 0 counts))
+(print (gethash 0 sums))
@@ -0,0 +1,14 @@
+; the histogram and totals of bench_count_by.lisp over 1M rows with GETHASH
+; and PUTHASH in an interpreted loop, a tenth of the rows
+(set 'rows (make-vector (range 0 1000000)))
+(set 'keys (v* rows 18014398509481984))
+(set 'counts (make-hash 1024))
+(set 'sums (make-hash 1024))
+(dotimes (i 1000000)
+  (set 'k (aref keys i))
+  (puthash k (+ (gethash k counts 0) 1) counts)
+  (puthash k (+ (gethash k sums 0) (aref rows i)) sums)
+)
+(print (length counts))
+(print (gethash 0 counts))
+(print (gethash 0 sums))
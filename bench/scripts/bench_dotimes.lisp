@@ -0,0 +1,12 @@
+; 1M iterations with the counter kept in C, compare with the WHILE loop of
+; bench_dotimes_while.lisp
+(set 's 0)
+(dotimes (i 1000000)
+  (inc s 1)
+)
+(print s)
+(set 's 0)
+(dolist (x (range 0 1000000))
+  (inc s 1)
+)
+(print s)
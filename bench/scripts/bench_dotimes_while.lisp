@@ -0,0 +1,8 @@
+; the same 1M iterations as bench_dotimes.lisp with a hand maintained counter
+(set 'i 0)
+(set 's 0)
+(while (< i 1000000)
+  (inc s 1)
+  (inc i 1)
+)
+(print s)
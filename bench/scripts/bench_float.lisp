@@ -0,0 +1,11 @@
+; packed double vectors go through the SIMD kernels, 20 passes over a
+; million elements plus the reductions
+(set 'v (make-vector 1000000 0.5))
+(set 'w (make-vector (range 0 1000000)))
+(dotimes (i 20)
+  (set 'v (v+ (v* v 0.5) w))
+)
+(print (sum v))
+(print (reduce-max v))
+(print (reduce-min (v- v w)))
+(print (/ (sum w) 1000000.0))
@@ -0,0 +1,21 @@
+; 5M inserts and 5M lookups over 1M distinct keys in a hash table,
+; compare with the linear scans of bench_hash_scan.lisp
+(set 'h (make-hash))
+(set 'i 0)
+(set 'k 0)
+(while (< i 5000000)
+  (puthash k i h)
+  (inc k 7919)
+  (if (>= k 1000000) (dec k 1000000))
+  (inc i 1)
+)
+(print (length h))
+(set 'i 0)
+(set 'found 0)
+(while (< i 5000000)
+  (if (>= (gethash k h -1) 0) (inc found 1))
+  (inc k 7919)
+  (if (>= k 1000000) (dec k 1000000))
+  (inc i 1)
+)
+(print found)
@@ -0,0 +1,25 @@
+; looking up 2000 keys by a linear scan of a list of 2000 keys,
+; compare with bench_hash.lisp
+(set 'keys nil)
+(set 'i 0)
+(while (< i 2000)
+  (push keys (* i 7))
+  (inc i 1)
+)
+(set 'i 0)
+(set 'found 0)
+(while (< i 2000)
+  (set 'j 0)
+  (while (< j 2000)
+    (if (= (nth j keys) (* i 7))
+      (while T
+        (inc found 1)
+        (set 'j 2000)
+        (brk)
+      )
+    )
+    (inc j 1)
+  )
+  (inc i 1)
+)
+(print found)
@@ -0,0 +1,24 @@
+; top 10 of 1M pseudo random numbers with TOP-K, then a priority queue
+; drained in order, compare with bench_heap_sort.lisp
+(set 'v (make-vector 1000000 0))
+(set 'x 1)
+(dotimes (i 1000000)
+  (set 'x (+ (* x 7919) 13))
+  (set 'x (- x (* (/ x 1000003) 1000003)))
+  (set (aref v i) x)
+)
+(dotimes (i 20)
+  (top-k 10 v)
+)
+(print (top-k 10 v))
+
+(set 'h (make-heap nil v))
+(set 'last 0)
+(set 'ordered t)
+(dotimes (i 100000)
+  (set 'x (heap-pop h))
+  (if (< x last) (set 'ordered nil) nil)
+  (set 'last x)
+)
+(print ordered)
+(print (heap-size h))
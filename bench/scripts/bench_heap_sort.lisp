@@ -0,0 +1,18 @@
+; top 10 of 1M pseudo random numbers by sorting the whole vector,
+; compare with bench_heap.lisp
+(set 'v (make-vector 1000000 0))
+(set 'x 1)
+(dotimes (i 1000000)
+  (set 'x (+ (* x 7919) 13))
+  (set 'x (- x (* (/ x 1000003) 1000003)))
+  (set (aref v i) x)
+)
+(dotimes (i 20)
+  (sort v t)
+)
+(set 's (sort v t))
+(set 'top '())
+(dotimes (i 10)
+  (push top (aref s i))
+)
+(print top)
@@ -0,0 +1,10 @@
+; 512x512 matrix product with the cache-blocked MATMUL, plus transpose and
+; the row and column reductions, compare with bench_matmul_lists.lisp
+(set 'n 512)
+(set 'a (make-matrix n n (make-vector (range 0 (* n n)))))
+(set 'b (transpose a))
+(set 'c (matmul a b))
+(print (mref c 511 511))
+(print (reduce-max (row-sum c)))
+(print (reduce-min (col-min c)))
+(print (sum (col-sum (transpose c))))
@@ -0,0 +1,7 @@
+; 2048x2048 matrix product, the operands no longer fit any cache level so
+; this one shows the effect of the tiling
+(set 'n 2048)
+(set 'a (make-matrix n n (make-vector (range 0 (* n n)))))
+(set 'c (matmul a (transpose a)))
+(print (mref c 2047 2047))
+(print (sum (row-sum c)))
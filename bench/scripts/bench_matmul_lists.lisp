@@ -0,0 +1,18 @@
+; 128x128 product of lists of lists with NTH, compare with bench_matmul.lisp
+(set 'n 128)
+(set 'a '())
+(dotimes (i n)
+  (set 'row '())
+  (dotimes (j n)
+    (push row (+ (* i n) j)))
+  (push a row))
+(set 'c '())
+(dotimes (i n)
+  (set 'row '())
+  (dotimes (j n)
+    (set 's 0)
+    (dotimes (k n)
+      (set 's (+ s (* (nth k (nth i a)) (nth j (nth k a))))))
+    (push row s))
+  (push c row))
+(print (nth 127 (nth 127 c)))
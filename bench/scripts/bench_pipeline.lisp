@@ -0,0 +1,9 @@
+; dot product of two 200k element lists, fused into a single pass without an
+; intermediate list, compare with bench_pipeline_unfused.lisp
+(set 'a (mapcar '+ (range 0 200000)))
+(set 'b (mapcar '- (range 0 200000) 7))
+(dotimes (i 10)
+  (set 'dot (reduce '+ (mapcar '* a b)))
+)
+(print dot)
+(print (reduce 'max (remove-if-not '< (mapcar '* a 3) 1000)))
@@ -0,0 +1,8 @@
+; the dot product of bench_pipeline.lisp with the products stored in a list
+(set 'a (mapcar '+ (range 0 200000)))
+(set 'b (mapcar '- (range 0 200000) 7))
+(dotimes (i 10)
+  (set 'products (mapcar '* a b))
+  (set 'dot (sum products))
+)
+(print dot)
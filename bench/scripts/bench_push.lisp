@@ -0,0 +1,9 @@
+; building a list of 1M numbers by appending in place
+(set 'l nil)
+(set 'i 0)
+(while (< i 1000000)
+  (push l i)
+  (inc i 1)
+)
+(print (length l))
+(print (sum l))
@@ -0,0 +1,14 @@
+; reductions over a lazy range of 100M numbers take constant memory,
+; compare with the counter loop of bench_range_while.lisp
+(set 'r (range 0 100000000))
+(print (length r))
+(print (sum r))
+(print (reduce-max r))
+(print (count-if-eq 31337 r))
+(set 'i 0)
+(set 's 0)
+(while (< i 1000000)
+  (inc s (nth i r))
+  (inc i 1)
+)
+(print s)
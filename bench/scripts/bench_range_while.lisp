@@ -0,0 +1,8 @@
+; summing 0..1M with a hand maintained counter, compare with bench_range.lisp
+(set 'i 0)
+(set 's 0)
+(while (< i 1000000)
+  (inc s i)
+  (inc i 1)
+)
+(print s)
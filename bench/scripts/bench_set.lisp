@@ -0,0 +1,15 @@
+; set operations on 200k element lists, every call builds a hash index of
+; its arguments and runs in linear time
+(set 'a (mapcar 'min (range 0 200000) 150000))
+(set 'b (mapcar '+ (range 0 200000 2) 50000))
+(dotimes (i 10)
+  (set 'd (distinct a))
+  (set 'u (union a b))
+  (set 'n (intersection a b))
+  (set 's (set-difference a b))
+)
+(print (length d))
+(print (length u))
+(print (length n))
+(print (length s))
+(print (/= 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25))
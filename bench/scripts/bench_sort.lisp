@@ -0,0 +1,48 @@
+; sorting with the native SORT, compare with bench_sort_bubble.lisp
+(set 'arr '(
+  8980 1247 5666 9806 9924 4728 1421 8361 5633 6437 6807 305 529 1699 7286 3683 5727 1401 8157 5395
+  9957 8884 6875 3266 7327 2792 3595 7109 6685 9217 8577 3217 8906 6921 4888 4559 8386 3602 6729 7741
+  8449 2354 5031 4903 9618 7723 6509 1625 6016 2279 4326 2457 5581 1134 9045 6518 2675 6800 6979 7644
+  4608 2550 5259 3362 4560 249 358 6529 6788 8987 2226 7150 2470 4754 155 791 646 5043 1974 121
+  8491 958 631 8434 136 2479 2856 7358 6055 3778 1077 453 3157 4212 8189 365 2078 3194 1847 2710
+  551 6198 3659 3305 3331 8720 3991 5462 3718 17 1888 9387 4134 5158 3789 6795 908 5277 6751 4822
+  9431 2675 4720 6676 1903 7124 862 6198 6729 8191 443 5323 6379 2242 2464 2791 5642 7714 6615 8414
+  1411 5323 3250 7779 729 7257 3639 9643 3834 7301 2845 8397 5567 2739 2881 513 7467 867 8990 7597
+  5112 890 1739 4946 3806 5247 3587 1918 3125 9868 2697 3307 1755 4103 5208 5917 144 2449 6059 3093
+  3749 7091 3605 4096 4124 8874 5506 5236 6416 7562 4893 3433 1865 2659 9601 9217 1192 4205 1194 1693
+  3642 3346 2102 668 4511 6012 5222 1107 4695 1743 5550 6909 5987 2021 6009 4726 2029 8806 5675 2160
+  8643 2866 8349 256 7233 3829 5187 3475 7145 3430 3477 6562 7293 6180 8727 8415 981 3300 4008 7438
+  5843 5198 8312 4857 8701 9119 3553 4165 8255 3801 3757 3436 3980 4050 3366 7756 4991 692 1745 6959
+  2356 172 4440 9482 9915 5555 6503 9890 9478 5053 1125 4074 1485 652 1822 4901 2912 2812 6241 5189
+  2483 8885 7552 2646 1846 6013 2529 388 695 8342 6610 2671 6751 38 1458 8363 6511 6984 3078 9976
+  9843 5172 3230 1688 4100 4490 269 9237 1383 5535 4585 1407 146 9315 4331 9196 8743 8901 2142 7395
+  3404 5495 5899 3879 3423 5287 3385 4600 9998 3960 3530 50 6292 2934 5932 4234 8259 1958 4197 9520
+  376 3879 7320 7938 9844 9955 2949 1831 5732 3685 1942 3253 9429 8217 9753 4653 363 5111 6677 8454
+  8873 8864 8203 583 6957 1506 3647 5230 2350 2152 484 5802 7178 4091 32 644 9939 3513 8947 4228
+  8450 2419 3599 1028 8867 1991 4241 5098 4063 274 1415 5616 9671 5327 3285 5452 1233 5686 3945 7987
+  4093 3287 2504 6260 2684 403 4697 4438 5922 7323 9233 8139 9317 4464 4402 5304 5712 1356 5568 8610
+  2500 462 3712 3744 7984 433 2694 6030 3869 481 0 6834 5946 445 3759 8492 2570 2960 792 6861
+  5581 6711 4934 614 2155 4971 5861 7986 7844 4540 6269 6006 7262 5456 8904 6149 693 1260 9012 988
+  4578 9059 4658 7458 8331 4455 453 5343 827 5908 2960 7361 3998 326 7595 5557 4224 4920 8113 5399
+  2307 8707 4061 333 5750 8540 765 5029 1061 728 2726 3448 7616 3975 2514 703 2159 5818 3520 3918
+))
+(set 'i 0)
+(while (< i 1000)
+  (sort arr)
+  (inc i 1)
+)
+(print (sort arr))
+
+; 1M pseudo random numbers in a vector
+(set 'v (make-vector 1000000 0))
+(set 'x 1)
+(set 'i 0)
+(while (< i 1000000)
+  (set 'x (+ (* x 75) 74))
+  (set 'x (- x (* (/ x 65537) 65537)))
+  (set (aref v i) x)
+  (inc i 1)
+)
+(sort! v)
+(print (aref v 0))
+(print (aref v 999999))
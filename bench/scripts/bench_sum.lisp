@@ -0,0 +1,11 @@
+; summing a vector of 1M numbers with the native reductions,
+; compare with bench_sum_while.lisp
+(set 'v (make-vector 1000000 3))
+(set 'i 0)
+(while (< i 100)
+  (sum v)
+  (reduce-max v)
+  (count-if-eq 3 v)
+  (inc i 1)
+)
+(print (sum v))
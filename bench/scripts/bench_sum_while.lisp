@@ -0,0 +1,10 @@
+; summing a vector of 1M numbers with an interpreted loop,
+; compare with bench_sum.lisp
+(set 'v (make-vector 1000000 3))
+(set 'i 0)
+(set 's 0)
+(while (< i 1000000)
+  (inc s (aref v i))
+  (inc i 1)
+)
+(print s)
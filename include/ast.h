@@ -1,9 +1,14 @@
 #include "err.h"
+#include "lexer.h"
+#include <stddef.h>
+#include <stdint.h>
 
 #ifndef AST_H
 #define AST_H
 
 typedef struct Env env;
+struct HashTable;
+struct Bignum;
 
 /**
  * @brief Type of the AST node, to distinquish what the node represents
@@ -13,6 +18,22 @@ enum node_type {
   NUMBER,
   SYMBOL,
   LIST,
+  VECTOR,
+  HASH,
+  RANGE,
+  BIGNUM,
+  FLOAT,
+  MATRIX,
+  HEAP,
+};
+
+/**
+ * @brief Element type of the packed VECTOR nodes
+ */
+enum vector_kind {
+  VEC_INT32,
+  VEC_INT64,
+  VEC_F64,
 };
 
 /**
@@ -27,22 +48,80 @@ enum node_origin {
 };
 
 /**
- * @brief An abstract syntax tree node representing either LIST, SYMBOL, BOOLEAN or a
- * NUMBER. List nodes can recursively contain other nodes.
+ * @brief An abstract syntax tree node representing either LIST, SYMBOL, BOOLEAN,
+ * NUMBER, VECTOR, a HASH table, a lazy RANGE of integers, a BIGNUM, a
+ * FLOAT, a MATRIX or a HEAP. List nodes can recursively contain other nodes.
+ *
+ * A NUMBER holds a 64-bit integer, integers outside of that range are BIGNUM
+ * nodes, so the two never represent the same value. A FLOAT holds a double.
+ * A MATRIX holds rows * cols 64-bit integers in one row-major buffer.
+ * A HEAP is a binary heap of `count` owned VARIABLE nodes in the array at
+ * `items`, the smallest item on top, or the largest if `descending` is set.
+ *
+ * A list node owns the array starting at `base`, its elements are the `count`
+ * items starting at `children`, which may point past the start of `base` when
+ * leading items were dropped. A list with NULL `base` and nonzero `count` is a
+ * view, it borrows the children of another list and owns neither the array
+ * nor the items. `capacity` is the count of slots allocated at `base`, the
+ * array grows geometrically so appending is amortized constant time.
+ *
+ * Nodes built by the parser carry the span of source they were read from, a
+ * list from its opening bracket or quote to its closing bracket.
  */
 typedef struct ASTnode {
   enum node_type type;
   enum node_origin origin;
+  struct source_span span; /**< source of parsed nodes, zero otherwise */
   union {
-    int value;
+    int64_t value;
+    double real;
     char *symbol;
     struct {
       struct ASTnode **children;
       int count;
+      struct ASTnode **base;
+      int capacity;
     } list;
+    struct {
+      void *data;
+      int count;
+      enum vector_kind kind;
+    } vector;
+    struct HashTable *hash;
+    struct {
+      int64_t start;
+      int64_t step;
+      int count;
+    } range;
+    struct Bignum *big;
+    struct {
+      int64_t *data;
+      int rows;
+      int cols;
+    } matrix;
+    struct {
+      struct ASTnode **items;
+      int count;
+      int capacity;
+      int descending;
+    } heap;
   } as;
 } astnode;
 
+/**
+ * @brief Count of nodes allocated since the start of the program
+ */
+extern uint64_t node_allocs;
+
+/**
+ * @brief Count of eval_node calls since the start of the program
+ */
+extern uint64_t node_evals;
+
+/**
+ * @brief Count of nodes freed since the start of the program
+ */
+extern uint64_t node_frees;
 
 /**
  * @brief Allocates and returns empty list node.
@@ -73,7 +152,68 @@ astnode *get_bool_node(int truthy);
  * @param value integer value for the node
  * @return astnode* or NULL if memory could not be allocated
  */
-astnode *get_number_node(int value);
+astnode *get_number_node(int64_t value);
+
+/**
+ * @brief Allocates and returns a float node representing the value
+ *
+ * @param real floating point value for the node
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_float_node(double real);
+
+/**
+ * @brief Allocates and returns a vector node with count zeroed elements
+ *
+ * @param kind element type of the vector
+ * @param count number of elements
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_vector_node(enum vector_kind kind, int count);
+
+/**
+ * @brief Allocates and returns an empty hash table node
+ *
+ * @param expected count of entries to make room for
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_hash_node(int expected);
+
+/**
+ * @brief Allocates and returns a range node of count integers
+ *
+ * @param start first element
+ * @param step difference of consecutive elements
+ * @param count number of elements
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_range_node(int64_t start, int64_t step, int count);
+
+/**
+ * @brief Allocates and returns a bignum node, the node takes over the number
+ *
+ * @param big value for the node
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_bignum_node(struct Bignum *big);
+
+/**
+ * @brief Allocates and returns a matrix node with rows * cols zeroed elements
+ *
+ * @param rows number of rows
+ * @param cols number of columns
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_matrix_node(int rows, int cols);
+
+/**
+ * @brief Allocates and returns an empty heap node
+ *
+ * @param descending keep the largest item on top if nonzero
+ * @param expected count of items to make room for
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_heap_node(int descending, int expected);
 
 /**
  * @brief appends given node to parents children array
@@ -84,6 +224,41 @@ astnode *get_number_node(int value);
  */
 err_t add_child_node(astnode *parent, astnode *child);
 
+/**
+ * @brief Makes sure the list owns a children array with room for at least
+ * `needed` items, so that appending up to that count does not reallocate.
+ * A view gets its own copy of the array, leading free slots left by dropped
+ * items are reused before the array grows. While any view is alive the items
+ * move to a new array instead, the old one is freed after the last view.
+ *
+ * @param list LIST type node
+ * @param needed count of items the list should hold without reallocation
+ * @return err_t
+ */
+err_t reserve_children(astnode *list, int needed);
+
+/**
+ * @brief Makes a view of the list node without the first `skip` items, no
+ * children are copied. A temporary list is reused in place, dropping (and
+ * freeing) the skipped items, otherwise a new temporary node borrowing the
+ * children of the original list is returned.
+ *
+ * @param list LIST type node
+ * @param skip count of leading items to leave out, 0 <= skip < count
+ * @param out_node out param, the resulting TEMPORARY list node
+ * @return err_t
+ */
+err_t get_list_view(astnode *list, int skip, astnode **out_node);
+
+/**
+ * @brief Checks whether the view node borrows a part of the list node children
+ *
+ * @param view possible view node
+ * @param list LIST type node
+ * @return int 1 if view is a view into the list, 0 otherwise
+ */
+int is_view_of(const astnode *view, const astnode *list);
+
 /**
  * @brief Base function for node evaluation
  * puts the result node into out_node argument
@@ -115,6 +290,14 @@ err_t make_deep_copy(astnode *original_node, astnode **new_node,
  * - Symbols are printed as their string names (e.g., add).
  * - Lists are printed as parentheses containing space-separated child nodes
  *   (e.g., (add 1 2)).
+ * - Vectors are printed as their elements prefixed with hash (e.g., #(1 2)).
+ * - Hash tables are printed as key value pairs in no particular order
+ *   (e.g., #H((A 1) (B 2))).
+ * - Ranges are printed as the list of their elements.
+ * - Matrices are printed as the list of their rows prefixed with #2A
+ *   (e.g., #2A((1 2) (3 4))).
+ * - Heaps are printed as their items prefixed with #HEAP, the top first and
+ *   the rest in heap order (e.g., #HEAP(1 3 2)).
  * - NULL nodes are printed as NIL.
  */
 void print_node(astnode *node);
@@ -126,6 +309,41 @@ void print_node(astnode *node);
  */
 void free_node(astnode *node);
 
+/**
+ * @brief Frees the node itself but not its content, for nodes whose content
+ * was moved to another node
+ *
+ * @param node to free, may be NULL
+ */
+void free_node_shell(astnode *node);
+
+/**
+ * @brief Bytes of the node and everything it holds except its child nodes
+ *
+ * @param node to measure
+ * @return size_t
+ */
+size_t node_bytes(const astnode *node);
+
+/**
+ * @brief Makes every node allocated from now on carry a header linking it
+ * into the live nodes, so next_live_node can walk them. Has to be called
+ * before the first node is allocated.
+ *
+ * @return err_t
+ */
+err_t track_live_nodes(void);
+
+/**
+ * @brief Walks all allocated nodes that were not freed yet, in order of
+ * allocation, when they are tracked
+ *
+ * @param node the previous node or NULL for the first one
+ * @return const astnode* the next live node or NULL after the last one, NULL
+ * right away unless track_live_nodes was called
+ */
+const astnode *next_live_node(const astnode *node);
+
 /**
  * @brief Frees any memory asociated with the node and in the AST tree below it
  * but not the node itself.
@@ -134,6 +352,15 @@ void free_node(astnode *node);
  */
 void free_node_content(astnode *node);
 
+/**
+ * @brief Frees the content of a variable about to be reassigned, a list
+ * borrowed by views keeps its children until the last view is gone
+ *
+ * @param node to free
+ * @return err_t
+ */
+err_t free_var_content(astnode *node);
+
 /**
  * @brief Recursively free the whole AST tree, but leave out non-temporary nodes
  * it expects non-temporary astnodes to not have any temporary subnodes,
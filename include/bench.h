@@ -0,0 +1,21 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "ast.h"
+#include "err.h"
+
+/**
+ * @brief Evaluates a parsed program the given count of times, every time in
+ * a fresh environment, and prints the min, median and p99 latency of the
+ * evaluations with their node evaluations and allocations to stderr
+ *
+ * @param root list of the outer expressions from parse_source
+ * @param source_code the source the spans of the expressions point to
+ * @param iterations count of evaluations
+ * @param verbose print every expression and its result in every iteration
+ * @return err_t of the first failed evaluation
+ */
+err_t bench_program(astnode *root, const char *source_code, long iterations,
+                    int verbose);
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef BIGNUM_H
+#define BIGNUM_H
+
+#include "ast.h"
+#include "err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* operand size in limbs from which multiplication switches to Karatsuba */
+#define KARATSUBA_THRESHOLD 32
+
+/**
+ * @brief Arbitrary precision integer, sign and magnitude. The magnitude is
+ * stored in 32-bit limbs, least significant first, without leading zero limbs.
+ * Zero has no limbs.
+ */
+typedef struct Bignum {
+  int sign;
+  int count;
+  int capacity; /**< limbs allocated, at least one */
+  uint32_t *limbs;
+} bignum;
+
+/**
+ * @brief Arithmetic operations on integers
+ */
+enum int_op {
+  INT_ADD,
+  INT_SUB,
+  INT_MUL,
+  INT_DIV,
+};
+
+/**
+ * @brief Allocates a bignum holding the value
+ *
+ * @param value to convert
+ * @return bignum* or NULL if memory could not be allocated
+ */
+bignum *bignum_from_int(int64_t value);
+
+/**
+ * @brief Parses a decimal integer literal with an optional sign
+ *
+ * @param s digits to parse, must be a valid number
+ * @return bignum* or NULL if memory could not be allocated
+ */
+bignum *bignum_parse(const char *s);
+
+/**
+ * @brief Formats the bignum as a decimal string
+ *
+ * @param big number to format
+ * @return char* to be freed by the caller or NULL if memory could not be
+ * allocated
+ */
+char *bignum_to_string(const bignum *big);
+
+/**
+ * @brief Makes a copy of the bignum
+ *
+ * @param big number to copy
+ * @return bignum* or NULL if memory could not be allocated
+ */
+bignum *bignum_copy(const bignum *big);
+
+/**
+ * @brief Frees the bignum
+ *
+ * @param big number to free, may be NULL
+ */
+void bignum_free(bignum *big);
+
+/**
+ * @brief Bytes allocated for the bignum
+ *
+ * @param big number to measure
+ * @return size_t
+ */
+size_t bignum_bytes(const bignum *big);
+
+/**
+ * @brief Converts the bignum to a 64-bit integer if it fits
+ *
+ * @param big number to convert
+ * @param value out param, the converted value
+ * @return int 1 if the number fits, 0 otherwise
+ */
+int bignum_to_int(const bignum *big, int64_t *value);
+
+/**
+ * @brief Converts the bignum to the nearest double, infinity if it is too
+ * large
+ *
+ * @param big number to convert
+ * @return double
+ */
+double bignum_to_double(const bignum *big);
+
+/**
+ * @brief Compares two bignums
+ *
+ * @param a first number
+ * @param b second number
+ * @return int negative if a < b, 0 if equal, positive if a > b
+ */
+int bignum_cmp(const bignum *a, const bignum *b);
+
+/**
+ * @brief Computes a op b, division truncates toward zero like C does
+ *
+ * @param op operation to apply
+ * @param a left operand
+ * @param b right operand, nonzero for INT_DIV
+ * @return bignum* or NULL if memory could not be allocated
+ */
+bignum *bignum_arith(enum int_op op, const bignum *a, const bignum *b);
+
+/**
+ * @brief Checks whether the node is an integer, a NUMBER or BIGNUM node
+ *
+ * @param node to check
+ * @return int 1 if it is, 0 otherwise
+ */
+int is_integer(const astnode *node);
+
+/**
+ * @brief Compares two integer nodes without allocating
+ *
+ * @param a NUMBER or BIGNUM node
+ * @param b NUMBER or BIGNUM node
+ * @return int negative if a < b, 0 if equal, positive if a > b
+ */
+int compare_integers(const astnode *a, const astnode *b);
+
+/**
+ * @brief Applies op to an integer accumulator, which is the fixnum `*fix`
+ * while `*big` is NULL and the bignum `*big` otherwise. The fixnum path uses
+ * overflow checked machine arithmetic and does not allocate, results that do
+ * not fit 64 bits move the accumulator to a bignum and back once they fit.
+ *
+ * @param op operation to apply
+ * @param fix in/out param, fixnum accumulator
+ * @param big in/out param, bignum accumulator or NULL, on failure it is kept
+ * @param arg NUMBER or BIGNUM right operand
+ * @return err_t
+ */
+err_t integer_apply(enum int_op op, int64_t *fix, bignum **big,
+                    const astnode *arg);
+
+/**
+ * @brief Makes a TEMPORARY node for an integer accumulator, a BIGNUM node
+ * taking over `big` if it is not NULL and a NUMBER node otherwise
+ *
+ * @param fix fixnum accumulator
+ * @param big bignum accumulator or NULL, freed on failure
+ * @param out_node out param, the new node
+ * @return err_t
+ */
+err_t get_integer_node(int64_t fix, bignum *big, astnode **out_node);
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* slots per group of control bytes, probed together */
+#define HASH_GROUP_WIDTH 16
+
+/**
+ * @brief Entry of a hash table, the key is an atom stored inline
+ */
+struct hash_slot {
+  astnode *value;
+  union {
+    int64_t value;
+    char *symbol;
+  } key;
+  enum node_type key_type;
+};
+
+/**
+ * @brief Open addressing hash table with Swiss table style metadata.
+ *
+ * Every slot has a control byte, either EMPTY, DELETED or the low 7 bits of
+ * the key hash. Lookups compare a whole group of control bytes at once and
+ * only look at the keys of matching slots. `capacity` is a power of two
+ * multiple of HASH_GROUP_WIDTH. Values are owned VARIABLE nodes.
+ */
+typedef struct HashTable {
+  uint8_t *ctrl;
+  struct hash_slot *slots;
+  int capacity;
+  int count;
+  int deleted;
+} hashtable;
+
+/**
+ * @brief Checks whether the node can be used as a hash table key, keys are
+ * numbers, symbols and booleans
+ *
+ * @param key node to check
+ * @return int 1 if the node is a valid key, 0 otherwise
+ */
+int is_hash_key(const astnode *key);
+
+/**
+ * @brief Hashes a key node
+ *
+ * @param key a valid key node
+ * @return uint64_t
+ */
+uint64_t hash_node(const astnode *key);
+
+/**
+ * @brief Allocates an empty hash table
+ *
+ * @param expected count of entries to make room for
+ * @return hashtable* or NULL if memory could not be allocated
+ */
+hashtable *hash_table_new(int expected);
+
+/**
+ * @brief Frees the hash table with all its keys and values
+ *
+ * @param table to free, may be NULL
+ */
+void hash_table_free(hashtable *table);
+
+/**
+ * @brief Bytes allocated for the table, its slots and symbol keys, not the
+ * values
+ *
+ * @param table to measure
+ * @return size_t
+ */
+size_t hash_table_bytes(const hashtable *table);
+
+/**
+ * @brief Makes a deep copy of the hash table, values are copied with the
+ * given origin
+ *
+ * @param table to copy
+ * @param out_table out param, the new table
+ * @param origin of the copied values
+ * @return err_t
+ */
+err_t hash_table_copy(const hashtable *table, hashtable **out_table,
+                      enum node_origin origin);
+
+/**
+ * @brief Looks up the value stored under the key
+ *
+ * @param table to search
+ * @param key a valid key node
+ * @return astnode* the stored value or NULL if the key is missing
+ */
+astnode *hash_table_get(const hashtable *table, const astnode *key);
+
+/**
+ * @brief Stores the value under the key, replacing and freeing the previous
+ * value. The table takes ownership of the value node.
+ *
+ * @param table to insert into
+ * @param key a valid key node, it is copied
+ * @param value node to store
+ * @return err_t
+ */
+err_t hash_table_put(hashtable *table, const astnode *key, astnode *value);
+
+/**
+ * @brief Removes the key and frees its value
+ *
+ * @param table to remove from
+ * @param key a valid key node
+ * @return int 1 if the key was present, 0 otherwise
+ */
+int hash_table_remove(hashtable *table, const astnode *key);
+
+/**
+ * @brief Iterates over the entries of the table. Start with *pos = 0.
+ *
+ * @param table to iterate
+ * @param pos iteration state, index of the next slot
+ * @return struct hash_slot* the next entry or NULL at the end
+ */
+struct hash_slot *hash_table_next(const hashtable *table, int *pos);
+
+/**
+ * @brief Creates a new hash table, (make-hash [expected-count]).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result HASH node with TEMPORARY
+ * origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_make_hash(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Returns the value stored under the key, (gethash key table
+ * [default]). Returns the default or NIL when the key is missing.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the stored node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_gethash(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Stores a value under the key, (puthash key value table).
+ * The table must be a variable.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the stored node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_puthash(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Assigns to a hash table entry, (set (gethash key table) value).
+ * Called by SET, as missing keys have no node that could be replaced.
+ * @param list_node List node of the SET operator
+ * @param result_node out param pointer to the stored node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_set_gethash(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Removes the key from a hash table variable, (remhash key table).
+ * Returns T if the key was present, NIL otherwise.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result BOOLEAN node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_remhash(astnode *list_node, astnode **result_node, env *env);
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+
+/**
+ * @brief Adds an item to a HEAP node, O(log n). The heap takes over the item,
+ * which must have VARIABLE origin.
+ *
+ * @param heap HEAP type node
+ * @param item node to add
+ * @return err_t
+ */
+err_t heap_push(astnode *heap, astnode *item);
+
+/**
+ * @brief Removes the top item of a nonempty HEAP node, O(log n). The caller
+ * takes over the returned VARIABLE node.
+ *
+ * @param heap HEAP type node
+ * @return astnode* the former top item
+ */
+astnode *heap_pop(astnode *heap);
+
+/**
+ * @brief Creates a new heap, (make-heap [descending [sequence]]). The
+ * smallest item is on top unless descending is T. Items of the list, vector
+ * or range are added in linear time.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result HEAP node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_make_heap(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Adds the evaluated arguments to a heap held by a variable,
+ * (heap-push heap item...). Returns the variable.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the variable HEAP node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_heap_push(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Removes and returns the top item of a heap, (heap-pop heap).
+ * Returns NIL when the heap is empty.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the removed TEMPORARY node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_heap_pop(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Returns the top item of a heap without removing it, (heap-peek
+ * heap). Returns NIL when the heap is empty.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the top node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_heap_peek(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Returns the count of items in a heap, (heap-size heap).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result NUMBER node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_heap_size(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Returns the k largest items of a list, vector or range from the
+ * largest down, (top-k k sequence). Only a heap of the k best items seen so
+ * far is kept, so it runs in O(n log k). The list shares the items of a list
+ * argument.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result TEMPORARY LIST node,
+ * NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_top_k(astnode *list_node, astnode **result_node, env *env);
+
+#endif
@@ -1,30 +1,44 @@
 #ifndef LEXER
 #define LEXER
 
+/**
+ * @brief Part of the source code a token or node was read from
+ */
+struct source_span {
+  int offset; /**< byte offset of the first character */
+  int length; /**< count of bytes */
+  int line;   /**< line of the first character counted from 1, 0 if none */
+};
+
 /**
  * @brief Tokenize Lisp-like source code into strings.
  *
- * Splits on spaces (' ') and tabs and treats each of the characters `'`, `(`,
- * `)` as standalone one-character tokens. The input is not modified.
+ * Splits on spaces (' '), tabs and line feeds and treats each of the
+ * characters `'`, `(`, `)` as standalone one-character tokens. The input is
+ * not modified.
  *
  * On success, allocates a NULL-terminated array of N heap-allocated,
- * NULL-terminated token strings and stores it in *tokens.
+ * NULL-terminated token strings and stores it in *tokens, and an array of the
+ * N token spans in *spans.
  *
- * Its caller responsibility to free each token and the token array on success
+ * Its caller responsibility to free the tokens and spans on success with
+ * free_tokens
  *
  * @param source_code NUL-terminated input string.
  * @param tokens out param; must point to a char** initialized to NULL.
+ * @param spans out param; where every token is in the source.
  * @return number of tokens on success; negative err_t on failure.
  */
-int tokenize(const char *source_code, char ***tokens);
+int tokenize(const char *source_code, char ***tokens,
+             struct source_span **spans);
 
 /**
- * @brief Split preprocessed source into top-level Lisp expressions.
+ * @brief Frees the tokens and spans returned by tokenize
  *
- * @param source_code NUL-terminated preprocessed input string.
- * @param tokens out param; receives NULL-terminated array of expressions.
- * @return number of expressions on success; negative err_t on failure.
+ * @param tokens NULL-terminated array of the tokens, may be NULL
+ * @param spans array of the spans
+ * @param token_count count of the tokens
  */
-int extr_expr(const char *source_code, char ***outer_expr);
+void free_tokens(char **tokens, struct source_span *spans, int token_count);
 
-#endif
\ No newline at end of file
+#endif
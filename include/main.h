@@ -2,6 +2,7 @@
 #ifndef MAIN_H
 #define MAIN_H
 
+#include "ast.h"
 #include "env.h"
 #include "err.h"
 
@@ -19,8 +20,12 @@ int main(int argc, char **argv);
  * @brief Handles arguments and either beigns the interpret loop or evaluates
  * given Lisp source code and exits
  *
- * The arguments are hardcoded, because so far if there are 2 or 3 args, they
- * can only have one meaning
+ * The options may come before or after the file: -v or -vv, -p, or
+ * --profile-out with the path of a JSON file for the profile, -s with the path
+ * of the folded stacks of the samples, -F with the rate of sampling, --bench
+ * with a count of evaluations of the parsed file, --trace with the path of a
+ * Chrome trace of the top-level forms and operator calls up to --trace-depth
+ * and --mem-stats, which also works for the interpret loop
  *
  * @param argc count of elements in the argv array
  * @param argv array of argument values
@@ -28,6 +33,35 @@ int main(int argc, char **argv);
  */
 err_t run(int argc, char **argv);
 
+/**
+ * @brief Preprocesses, tokenizes and parses the source code. Only the tokens
+ * are upper cased, so the spans of the nodes point to the source as written.
+ *
+ * @param source_code to parse, comments are blanked in place
+ * @param root out param, list of the outer expressions, NULL on failure
+ * @return err_t
+ */
+err_t parse_source(char *source_code, astnode **root);
+
+/**
+ * @brief Evaluates the outer expressions of a parsed program in order and
+ * prints their results in verbose mode
+ *
+ * At verbose level 2 every result is followed by the elapsed microseconds of
+ * the evaluation, the count of eval_node calls and the bytes the expression
+ * left allocated once its temporary result is freed, and the program by a
+ * line with their totals.
+ *
+ * @param root list of the outer expressions from parse_source
+ * @param source_code the source the spans of the expressions point to
+ * @param verbose 1 to print every expression and its result, 2 to add their
+ * cost
+ * @param env environment for evaluation
+ * @return err_t of the first failed expression
+ */
+err_t eval_program(astnode *root, const char *source_code, int verbose,
+                   env *env);
+
 /**
  * @brief Tokenizes, parses the source code and evaluates all outer expressions
  * and prints their result
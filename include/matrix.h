@@ -0,0 +1,110 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include <stdint.h>
+
+/* rows of the left operand and columns of the right operand of MATMUL are
+ * processed in tiles, so the tile of the right operand stays in the cache
+ * while it is used for every row of the left one (64 x 256 x 8 B = 128 KiB) */
+#define MATMUL_BLOCK_K 64
+#define MATMUL_BLOCK_J 256
+
+/* side of the square tiles copied by TRANSPOSE */
+#define TRANSPOSE_BLOCK 32
+
+/**
+ * @brief Returns a pointer to the element in row i and column j of a MATRIX
+ * node, no bounds checking
+ *
+ * @param mat MATRIX type node
+ * @param i row index
+ * @param j column index
+ * @return int64_t*
+ */
+int64_t *matrix_at(const astnode *mat, int i, int j);
+
+/**
+ * @brief Converts a LIST node of rows, LIST nodes of NUMBER nodes of the same
+ * length, into a new MATRIX node.
+ * Fails with syntax error when the rows are ragged or an item is not a number.
+ *
+ * @param list LIST type node
+ * @param out_node out param, the new matrix with UNSET origin
+ * @return err_t
+ */
+err_t list_to_matrix(const astnode *list, astnode **out_node);
+
+/**
+ * @brief Creates a new matrix. Called either with the rows and columns and
+ * an optional initial value or integer vector of rows * cols elements in row
+ * major order (make-matrix 2 3 0), or with a list of rows to pack
+ * (make-matrix '((1 2) (3 4))).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result MATRIX node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_make_matrix(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Returns the element of a matrix in the row and column as a NUMBER
+ * node, (mref matrix row column).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result NUMBER node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_mref(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Assigns to a matrix element, (set (mref matrix row column) value).
+ * Called by SET, as matrix elements are not nodes that could be replaced.
+ * The matrix must be a variable.
+ * @param list_node List node of the SET operator
+ * @param result_node out param pointer to the stored NUMBER node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_set_mref(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Matrix product, (matmul a b). The columns of a must match the rows
+ * of b. The product is computed in cache sized tiles with a packed inner
+ * kernel and wraps around on overflow like the vector arithmetic.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result MATRIX node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_matmul(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Returns the transposed copy of a matrix, (transpose matrix).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result MATRIX node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_transpose(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Reduces every row or every column of a matrix into a vector,
+ * ROW-SUM, ROW-MIN, ROW-MAX, COL-SUM, COL-MIN and COL-MAX. Sums wrap around
+ * on overflow, minimum and maximum need a nonempty row or column.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result VECTOR node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_matrix_reduce(astnode *list_node, astnode **result_node, env *env);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Owners of the accounted heap memory. Nodes own their payload, the
+ * children arrays, vector data, hash tables and bignums.
+ */
+enum mem_owner {
+  MEM_NODES,
+  MEM_ENV,
+  MEM_LEXER,
+  MEM_OWNERS,
+};
+
+/**
+ * @brief Bytes held now and at most so far
+ */
+struct mem_usage {
+  int64_t current;
+  int64_t peak;
+};
+
+/**
+ * @brief Usage of every owner and of all of them together, the total peak is
+ * the peak of the sum, not the sum of the peaks
+ */
+extern struct mem_usage mem_usage[MEM_OWNERS];
+extern struct mem_usage mem_total;
+
+/**
+ * @brief Accounts bytes allocated by the owner
+ *
+ * @param owner of the memory
+ * @param bytes allocated
+ */
+void mem_charge(enum mem_owner owner, size_t bytes);
+
+/**
+ * @brief Accounts bytes freed by the owner
+ *
+ * @param owner of the memory
+ * @param bytes freed
+ */
+void mem_discharge(enum mem_owner owner, size_t bytes);
+
+/**
+ * @brief Prints the current and peak bytes of every owner and the live nodes
+ * with their bytes by type and origin, or only their count unless the nodes
+ * are tracked, see track_live_nodes
+ *
+ * @param out stream to print to
+ * @return err_t
+ */
+err_t mem_report(FILE *out);
+
+/**
+ * @brief Prints the memory report of mem_report to stderr, (room). Returns
+ * the count of bytes currently held. The live nodes are listed by type and
+ * origin only when the program runs with --mem-stats.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result number node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_room(astnode *list_node, astnode **result_node, env *env);
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef NUMBER_H
+#define NUMBER_H
+
+#include "ast.h"
+#include "bignum.h"
+#include "err.h"
+#include <stdint.h>
+
+/**
+ * @brief Accumulator of mixed arithmetic. It stays an integer, the fixnum
+ * `fix` while `big` is NULL and the bignum `big` otherwise, until a FLOAT
+ * operand turns it into the double `real`.
+ */
+typedef struct NumAcc {
+  int is_float;
+  double real;
+  int64_t fix;
+  bignum *big;
+} num_acc;
+
+/**
+ * @brief Checks whether the node is a number, a NUMBER, BIGNUM or FLOAT node
+ *
+ * @param node to check
+ * @return int 1 if it is, 0 otherwise
+ */
+int is_numeric(const astnode *node);
+
+/**
+ * @brief Converts a NUMBER, BIGNUM or FLOAT node to a double
+ *
+ * @param node to convert
+ * @return double
+ */
+double to_real(const astnode *node);
+
+/**
+ * @brief Compares two numeric nodes by value, integers and floats exactly.
+ * NaN is ordered after every other number and equal to itself, so sorting
+ * stays a total order.
+ *
+ * @param a NUMBER, BIGNUM or FLOAT node
+ * @param b NUMBER, BIGNUM or FLOAT node
+ * @return int negative if a < b, 0 if equal, positive if a > b
+ */
+int compare_numbers(const astnode *a, const astnode *b);
+
+/**
+ * @brief Applies op to the accumulator. Integers use integer_apply, once
+ * either side is a FLOAT the accumulator is converted and the operation is
+ * done in double precision, INT_DIV then being a true division.
+ *
+ * @param op operation to apply
+ * @param acc in/out param, the accumulator
+ * @param arg NUMBER, BIGNUM or FLOAT right operand
+ * @return err_t
+ */
+err_t number_apply(enum int_op op, num_acc *acc, const astnode *arg);
+
+/**
+ * @brief Makes a TEMPORARY node for the accumulator, a FLOAT node if it holds
+ * a double and an integer node otherwise. The accumulator bignum is taken
+ * over by the node or freed.
+ *
+ * @param acc the accumulator
+ * @param out_node out param, the new node
+ * @return err_t
+ */
+err_t get_acc_node(num_acc *acc, astnode **out_node);
+
+/**
+ * @brief Prints a double with the fewest digits that read back to the same
+ * value, always with a decimal point or exponent so it reads back as a FLOAT
+ *
+ * @param real value to print
+ */
+void print_float(double real);
+
+#endif
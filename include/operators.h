@@ -7,10 +7,11 @@
 
 
 /**
- * @brief Evaluates and sums the arguments and returns a new NUMBER node.
- * All arguments must evaluate to NUMBER nodes or a syntax error is returned.
+ * @brief Evaluates and sums the arguments and returns a new integer node, a
+ * BIGNUM if the sum does not fit 64 bits and a NUMBER otherwise. All arguments
+ * must evaluate to NUMBER or BIGNUM nodes or a syntax error is returned.
  * @param list_node List node containing the operator and arguments
- * @param result_node out param pointer to the result NUMBER node with TEMPORARY
+ * @param result_node out param pointer to the result node with TEMPORARY
  * origin, NULL on failure
  * @param env The environment for variable lookup and evaluation
  * @return err_t
@@ -19,10 +20,10 @@ err_t oper_add(astnode *list_node, astnode **result_node, env *env);
 
 /**
  * @brief Evaluates and subtracts all other arguments after the first one and
- * returns a new NUMBER node. All arguments must evaluate to NUMBER nodes or a
- * syntax error is returned.
+ * returns a new integer node, promoted to a BIGNUM on overflow. All arguments
+ * must evaluate to NUMBER or BIGNUM nodes or a syntax error is returned.
  * @param list_node List node containing the operator
- * @param result_node out param pointer to the result NUMBER node with TEMPORARY
+ * @param result_node out param pointer to the result node with TEMPORARY
  * origin, NULL on failure
  * @param env The environment for variable lookup and evaluation
  * @return err_t
@@ -31,10 +32,10 @@ err_t oper_sub(astnode *list_node, astnode **result_node, env *env);
 
 /**
  * @brief Evaluates and multiplies the arguments with eachother and returns a
- * new NUMBER node. All arguments must evaluate to NUMBER nodes or a syntax
- * error is returned.
+ * new integer node, promoted to a BIGNUM on overflow. All arguments must
+ * evaluate to NUMBER or BIGNUM nodes or a syntax error is returned.
  * @param list_node List node containing the operator
- * @param result_node out param pointer to the result NUMBER node with TEMPORARY
+ * @param result_node out param pointer to the result node with TEMPORARY
  * origin, NULL on failure
  * @param env The environment for variable lookup and evaluation
  * @return err_t
@@ -42,11 +43,11 @@ err_t oper_sub(astnode *list_node, astnode **result_node, env *env);
 err_t oper_mul(astnode *list_node, astnode **result_node, env *env);
 
 /**
- * @brief Evaluates and divides first by all other arguments and returns a new
- * NUMBER node. All arguments must evaluate to NUMBER nodes or a syntax error is
- * returned.
+ * @brief Evaluates and divides first by all other arguments, truncating, and
+ * returns a new integer node. All arguments must evaluate to NUMBER or BIGNUM
+ * nodes or a syntax error is returned.
  * @param list_node List node containing the operator
- * @param result_node out param pointer to the result NUMBER node with TEMPORARY
+ * @param result_node out param pointer to the result node with TEMPORARY
  * origin, NULL on failure
  * @param env The environment for variable lookup and evaluation
  * @return err_t
@@ -55,7 +56,8 @@ err_t oper_div(astnode *list_node, astnode **result_node, env *env);
 
 /**
  * @brief Increments a variable by a value and returns the updated variable
- * node. The first argument must be a variable node, the second a NUMBER node.
+ * node. The first argument must be an integer variable node, the second an
+ * integer node. The variable turns into a BIGNUM when it leaves 64 bits.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the updated variable node, NULL on
  * failure
@@ -66,7 +68,8 @@ err_t oper_inc(astnode *list_node, astnode **result_node, env *env);
 
 /**
  * @brief Decrements a variable by a value and returns the updated variable
- * node. The first argument must be a variable node, the second a NUMBER node.
+ * node. The first argument must be an integer variable node, the second an
+ * integer node. The variable turns into a BIGNUM when it leaves 64 bits.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the updated variable node, NULL on
  * failure
@@ -77,7 +80,8 @@ err_t oper_dec(astnode *list_node, astnode **result_node, env *env);
 
 /**
  * @brief Checks if all arguments are equal and returns a BOOLEAN node.
- * All arguments must evaluate to NUMBER nodes or a syntax error is returned.
+ * All arguments must evaluate to NUMBER or BIGNUM nodes or a syntax error is
+ * returned.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the result BOOLEAN node, NULL on
  * failure
@@ -88,7 +92,8 @@ err_t oper_eql(astnode *list_node, astnode **result_node, env *env);
 
 /**
  * @brief Checks if all arguments are non-equal and returns a BOOLEAN node.
- * All arguments must evaluate to NUMBER nodes or a syntax error is returned.
+ * All arguments must evaluate to NUMBER or BIGNUM nodes or a syntax error is
+ * returned.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the result BOOLEAN node, NULL on
  * failure
@@ -99,8 +104,8 @@ err_t oper_noneql(astnode *list_node, astnode **result_node, env *env);
 
 /**
  * @brief Compares arguments according to the relational operator (<, >, <=, >=)
- * and returns a BOOLEAN node. All arguments must evaluate to NUMBER nodes or a
- * syntax error is returned.
+ * and returns a BOOLEAN node. All arguments must evaluate to NUMBER or BIGNUM
+ * nodes or a syntax error is returned.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the result BOOLEAN node, NULL on
  * failure
@@ -110,12 +115,12 @@ err_t oper_noneql(astnode *list_node, astnode **result_node, env *env);
 err_t oper_grt_lwr(astnode *list_node, astnode **result_node, env *env);
 
 /**
- * @brief Returns the minimum or maximum value among the arguments as a NUMBER
- * node. All arguments must evaluate to NUMBER nodes or a syntax error is
- * returned.
+ * @brief Returns the minimum or maximum value among the arguments as a new
+ * integer node. All arguments must evaluate to NUMBER or BIGNUM nodes or a
+ * syntax error is returned.
  * @param list_node List node containing the operator
- * @param result_node out param pointer to the result NUMBER node, NULL on
- * failure
+ * @param result_node out param pointer to the result node with TEMPORARY
+ * origin, NULL on failure
  * @param env The environment for variable lookup and evaluation
  * @return err_t
  */
@@ -165,7 +170,8 @@ err_t oper_list(astnode *list_node, astnode **result_node, env *env);
 err_t oper_atom(astnode *list_node, astnode **result_node, env *env);
 
 /**
- * @brief Returns the first element of a list argument.
+ * @brief Returns the first element of a list argument, a new NUMBER node for
+ * a range argument.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the CAR node, NULL on failure
  * @param env The environment for variable lookup and evaluation
@@ -175,6 +181,8 @@ err_t oper_car(astnode *list_node, astnode **result_node, env *env);
 
 /**
  * @brief Returns the rest of the list after the first element in a list node.
+ * The result is a view into the argument list, no children are copied, or a
+ * shorter range for a range argument.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the CDR list node, NULL on failure
  * @param env The environment for variable lookup and evaluation
@@ -182,8 +190,21 @@ err_t oper_car(astnode *list_node, astnode **result_node, env *env);
  */
 err_t oper_cdr(astnode *list_node, astnode **result_node, env *env);
 
+/**
+ * @brief Returns the list without its first n elements as a list node.
+ * The result is a view into the argument list, no children are copied, or a
+ * shorter range for a range argument.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result list node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_nthcdr(astnode *list_node, astnode **result_node, env *env);
+
 /**
  * @brief Returns the nth element of a list argument without evaluating it.
+ * For a vector or range argument a new NUMBER node with the element value is
+ * returned.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the nth node, NULL on failure
  * @param env The environment for variable lookup and evaluation
@@ -192,7 +213,8 @@ err_t oper_cdr(astnode *list_node, astnode **result_node, env *env);
 err_t oper_nth(astnode *list_node, astnode **result_node, env *env);
 
 /**
- * @brief Returns the length of a list argument as a NUMBER node.
+ * @brief Returns the length of a list, vector or range argument, or the count
+ * of entries of a hash table, as a NUMBER node.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the result NUMBER node, NULL on
  * failure
@@ -201,6 +223,42 @@ err_t oper_nth(astnode *list_node, astnode **result_node, env *env);
  */
 err_t oper_len(astnode *list_node, astnode **result_node, env *env);
 
+/**
+ * @brief Appends the evaluated arguments to the end of a list held by a
+ * variable, (push list item...). The list grows in place in amortized
+ * constant time, returns the variable.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the variable LIST node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_push(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Appends all items of the second list argument to the end of a list
+ * held by a variable, (append! list other). Returns the variable.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the variable LIST node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_append_in_place(astnode *list_node, astnode **result_node,
+                           env *env);
+
+/**
+ * @brief Preallocates room for n items in a list held by a variable, so that
+ * pushing up to n items does not reallocate, (reserve list n). Returns the
+ * variable.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the variable LIST node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_reserve(astnode *list_node, astnode **result_node, env *env);
+
 /**
  * @brief Evaluates a conditional expression and returns the result of the
  * true(3rd arg) or false branch(4th arg).
@@ -221,6 +279,29 @@ err_t oper_if(astnode *list_node, astnode **result_node, env *env);
  */
 err_t oper_while(astnode *list_node, astnode **result_node, env *env);
 
+/**
+ * @brief Evaluates the body count times with the variable bound to 0, 1, ...
+ * count - 1, (dotimes (var count [result]) body...). The counter is kept in C
+ * and stored into the variable in place. Returns the result form or NIL.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_dotimes(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Evaluates the body once for every element of a list, vector or range
+ * with the variable bound to the element, (dolist (var sequence [result])
+ * body...). Numbers are stored into the variable in place, other elements are
+ * copied like SET does. Returns the result form or NIL.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_dolist(astnode *list_node, astnode **result_node, env *env);
+
 /**
  * @brief Breaks out of a loop, returning CONTROL_BREAK.
  * @param list_node List node containing the operator
@@ -266,4 +347,13 @@ extern struct operator_entry operators[];
  * @brief Number of supported operators in the operators array.
  */
 extern int oper_count;
+
+/**
+ * @brief Looks the operator up by its symbol through a hash index of the
+ * operators array, built on first use
+ *
+ * @param symbol SYMBOL type node
+ * @return int index of the operator in the operators array, -1 if unknown
+ */
+int find_operator(const astnode *symbol);
 #endif
\ No newline at end of file
@@ -1,9 +1,19 @@
 #include "ast.h"
 #include "err.h"
+#include "lexer.h"
 
 #ifndef PARSER_H
 #define PARSER_H
 
+/**
+ * Compile-time switch for packed literals.
+ * Define PARSE_NUMERIC_VECTORS to 1 to parse quoted lists of numbers, like
+ * '(1 2 3), directly into VECTOR nodes, or 0 to keep them as lists.
+ */
+#ifndef PARSE_NUMERIC_VECTORS
+#define PARSE_NUMERIC_VECTORS 0
+#endif
+
 /**
  * Grammar:
  * L(list) -> EL | e
@@ -22,11 +32,13 @@
  *
  * @param out_node root of resulting AST, NULL on failure
  * @param tokens array of all tokens to process
+ * @param spans where the tokens are in the source
  * @param curr_tok index into tokens pointing to current token to parse
  * @return err_t error ERR_NO_ERROR on success, otherwise syntax error or
  * out_of_memory
  */
-err_t parse_list(astnode **out_node, const char **tokens, int *curr_tok);
+err_t parse_list(astnode **out_node, const char **tokens,
+                 const struct source_span *spans, int *curr_tok);
 
 /**
  * @brief Parser for grammar rule: "E -> 'E | (L) | C | S"
@@ -34,7 +46,7 @@ err_t parse_list(astnode **out_node, const char **tokens, int *curr_tok);
  * Decides form by current token and builds AST:
  *  - 'E  -> (quote <expr>)
  *  - (L) -> parse_list(...) until ')'
- *  - C   -> number node (digits only)
+ *  - C   -> number node (digits only) or float node (decimal literal)
  *  - S   -> symbol node (printable token)
  *
  * Advances curr_tok past the whole expression. Expects "'", "(", ")"
@@ -42,9 +54,11 @@ err_t parse_list(astnode **out_node, const char **tokens, int *curr_tok);
  *
  * @param out_node root of resulting AST, NULL on failure
  * @param tokens array of all tokens to process
+ * @param spans where the tokens are in the source
  * @param curr_tok index into tokens pointing to current token
  * @return err_t ERR_NO_ERROR on success, otherwise syntax/out_of_memory
  */
-err_t parse_expr(astnode **out_node, const char **tokens, int *curr_tok);
+err_t parse_expr(astnode **out_node, const char **tokens,
+                 const struct source_span *spans, int *curr_tok);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+
+/**
+ * @brief Applies a builtin function to the elements of the sequences at the
+ * same index and returns the list of results, (mapcar 'function sequence...).
+ * The function is one of + - * / MIN MAX = /= < > <= >= ATOM. An atom argument
+ * is passed to every call, the result is as long as the shortest sequence.
+ * Nested MAPCAR and REMOVE-IF-NOT arguments are fused into a single pass.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result LIST node with TEMPORARY
+ * origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_mapcar(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Returns the elements of the first sequence for which the builtin
+ * predicate holds, (remove-if-not 'predicate sequence [argument...]). The
+ * predicate gets the elements at the same index of all arguments, so
+ * (remove-if-not '> xs 0) keeps the positive numbers. Nested MAPCAR and
+ * REMOVE-IF-NOT arguments are fused into a single pass.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result LIST node with TEMPORARY
+ * origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_remove_if_not(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Folds the sequence with a builtin arithmetic function, (reduce
+ * 'function sequence [initial]). An empty sequence without initial value
+ * gives 0 for + and 1 for *, an error otherwise. A nested MAPCAR or
+ * REMOVE-IF-NOT argument is consumed element by element without building the
+ * intermediate list.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result number node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_fold(astnode *list_node, astnode **result_node, env *env);
+
+#endif
@@ -4,7 +4,8 @@
 #include "err.h"
 
 /**
- * @brief Replaces Lisp comments and line separators with spaces
+ * @brief Replaces Lisp comments and carriage returns with spaces. Line feeds
+ * are kept, so the lexer can tell the line of every token.
  *
  * @param code_string Lisp source code
  * @return -1 if code_string is NULL
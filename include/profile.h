@@ -0,0 +1,126 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/* modes of profiling, bits of the profiling flag */
+#define PROFILE_OPERATORS 1
+#define PROFILE_SAMPLES 2
+#define PROFILE_TRACE 4
+
+/* samples per second of CPU time unless given, prime so the samples do not
+ * fall into step with periodic work */
+#define SAMPLE_DEFAULT_HZ 997
+
+/* deepest chain of operators recorded, samples of deeper calls keep the
+ * outermost frames */
+#define SAMPLE_MAX_DEPTH 128
+
+/* frames of all samples kept until the run ends, later samples are dropped */
+#define SAMPLE_BUFFER_FRAMES (1 << 21)
+
+/**
+ * @brief Statistics of one entry of the operators array
+ */
+struct oper_profile {
+  uint64_t calls;
+  uint64_t inclusive_ns; /**< time with nested operators, recursion once */
+  uint64_t exclusive_ns; /**< time without nested operators */
+  uint64_t allocs;       /**< nodes allocated outside nested operators */
+  int active;            /**< calls of the operator currently running */
+};
+
+/**
+ * @brief Frame of a sample, an operator call in progress
+ */
+struct sample_frame {
+  int line; /**< source line of the call, 0 if the list was not parsed */
+  int oper; /**< index of the operator in the operators array */
+};
+
+/**
+ * @brief Nonzero while operator calls are profiled, sampled or traced, a mask
+ * of PROFILE_OPERATORS, PROFILE_SAMPLES and PROFILE_TRACE. eval_node only
+ * checks this flag when profiling is off.
+ */
+extern int profiling;
+
+/**
+ * @brief Allocates the statistics of all operators and turns profiling of
+ * operator calls on
+ *
+ * @return err_t
+ */
+err_t profile_start(void);
+
+/**
+ * @brief Starts sampling the chain of running operators on every SIGPROF of
+ * a profiling timer
+ *
+ * @param source path of the profiled file, names the frames
+ * @param hz samples per second of CPU time
+ * @return err_t
+ */
+err_t sampling_start(const char *source, int hz);
+
+/**
+ * @brief Calls the operator at the index of the operators array and records
+ * its call count, time and allocations, makes it a frame of the samples or
+ * traces its begin and end
+ *
+ * @param index of the operator in the operators array
+ * @param list_node List node containing the operator
+ * @param result_node out param of the operator
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t of the operator
+ */
+err_t profile_call(int index, astnode *list_node, astnode **result_node,
+                   env *env);
+
+/**
+ * @brief Prints a table of the called operators sorted by exclusive time
+ *
+ * @param out stream to print to
+ */
+void profile_print(FILE *out);
+
+/**
+ * @brief Writes the statistics of the called operators as a JSON array
+ *
+ * @param path of the file to write
+ * @return err_t
+ */
+err_t profile_write_json(const char *path);
+
+/**
+ * @brief Stops the timer and writes the samples as folded stacks, one line
+ * per distinct chain of operators with its count of samples, like
+ * "file:3 DOTIMES;file:5 SET 42", the input of flamegraph.pl
+ *
+ * @param path of the file to write
+ * @return err_t
+ */
+err_t sampling_write(const char *path);
+
+/**
+ * @brief Frees the statistics and the samples and turns profiling off
+ */
+void profile_stop(void);
+
+/**
+ * @brief Evaluates the argument and returns its result like the argument
+ * itself would. Prints the elapsed wall and CPU time, the count of eval_node
+ * calls and of nodes allocated and freed during the evaluation to stderr.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result of the argument, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t of the argument
+ */
+err_t oper_time(astnode *list_node, astnode **result_node, env *env);
+
+#endif
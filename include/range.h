@@ -0,0 +1,51 @@
+#ifndef RANGE_H
+#define RANGE_H
+
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+
+/**
+ * @brief Returns the i-th element of a RANGE node, no bounds checking
+ *
+ * @param range RANGE type node
+ * @param i index of the element
+ * @return int64_t
+ */
+int64_t range_get(const astnode *range, int i);
+
+/**
+ * @brief Returns the range without its first `skip` elements. A temporary
+ * range is moved in place, otherwise a new temporary range is returned.
+ *
+ * @param range RANGE type node
+ * @param skip count of leading elements to leave out, 0 <= skip < count
+ * @param out_node out param, the resulting TEMPORARY range node
+ * @return err_t
+ */
+err_t get_range_tail(astnode *range, int skip, astnode **out_node);
+
+/**
+ * @brief Converts a RANGE node into a LIST node of NUMBER nodes in place.
+ * The numbers get the origin of the node, so a variable stays a variable.
+ *
+ * @param node RANGE type node
+ * @return err_t
+ */
+err_t materialize_range(astnode *node);
+
+/**
+ * @brief Returns a lazy sequence of the integers from start up to, but not
+ * including, end, (range start end [step]). The step defaults to 1 and may be
+ * negative to count down. Elements are computed on access, so the range takes
+ * constant memory until it is mutated. Like a list it holds at most INT_MAX
+ * elements, longer ranges are a syntax error.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result RANGE node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_range(astnode *list_node, astnode **result_node, env *env);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+
+/* COUNT-BY and SUM-BY start with room for this many distinct keys, or one
+ * per row if there are fewer rows */
+#define GROUP_INITIAL_KEYS 1024
+
+/**
+ * @brief Reduces all elements of a list or vector argument with SUM, PRODUCT,
+ * REDUCE-MIN or REDUCE-MAX in a single native loop and returns a number
+ * node. All elements must be numbers, REDUCE-MIN and REDUCE-MAX need at least
+ * one. Integer sums and products that leave 64 bits continue as a BIGNUM, a
+ * float element or float vector gives a FLOAT.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result number node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_reduce(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Counts the elements of a list or vector equal to the value,
+ * (count-if-eq value sequence), and returns a NUMBER node.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result NUMBER node with TEMPORARY
+ * origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_count_if_eq(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Counts the occurrences of every key of a list, vector or range in a
+ * single pass, (count-by keys). Keys are numbers, symbols and booleans.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result HASH node with TEMPORARY
+ * origin mapping each key to its count, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_count_by(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Sums the values of every key in a single pass, (sum-by keys
+ * values). The values are a list, vector or range of numbers of the same
+ * length as the keys, the value at index i is added to the key at index i.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result HASH node with TEMPORARY
+ * origin mapping each key to its sum, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_sum_by(astnode *list_node, astnode **result_node, env *env);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef SET_H
+#define SET_H
+
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+
+/* up to this many elements, scanning the elements seen so far is cheaper
+ * than building a hash index of them */
+#define SET_PAIRWISE_LIMIT 16
+
+/**
+ * @brief Checks whether any two of the items are equal. Numbers are equal by
+ * value whether integer or float, symbols by name. Small inputs are compared
+ * pairwise, larger ones through a hash index.
+ *
+ * @param items NUMBER, BIGNUM, FLOAT, SYMBOL or BOOLEAN nodes
+ * @param count count of items
+ * @param found out param, 1 if two items are equal, 0 otherwise
+ * @return err_t
+ */
+err_t has_duplicates(astnode *const *items, int count, int *found);
+
+/**
+ * @brief Set operations on lists, vectors or ranges of numbers, symbols and
+ * booleans: (distinct a), (union a b), (intersection a b) and
+ * (set-difference a b). The resulting list holds every element once, in the
+ * order of its first occurrence in a, then b. Numbers are equal by value
+ * whether integer or float. Small inputs are compared pairwise, larger ones
+ * through a hash index, so the operations run in linear time.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result TEMPORARY LIST node,
+ * NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_set_op(astnode *list_node, astnode **result_node, env *env);
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stdint.h>
+
+/**
+ * @brief Element-wise operation for the packed kernels
+ */
+enum simd_op {
+  SIMD_ADD,
+  SIMD_SUB,
+  SIMD_MUL,
+  SIMD_MIN,
+  SIMD_MAX,
+};
+
+/**
+ * @brief Computes dst[i] = a[i] op b[i] for n 32-bit integers.
+ * Uses AVX2 or SSE4.1 when the CPU supports it, scalar code otherwise.
+ * The results wrap around on overflow, dst may alias a or b.
+ *
+ * @param op operation to apply
+ * @param dst output array of n elements
+ * @param a left operands
+ * @param b right operands
+ * @param n count of elements
+ */
+void simd_binop_i32(enum simd_op op, int32_t *dst, const int32_t *a,
+                    const int32_t *b, int n);
+
+/**
+ * @brief Computes dst[i] = a[i] op b[i] for n 64-bit integers.
+ * Uses AVX2 when the CPU supports it, scalar code otherwise.
+ * The results wrap around on overflow, dst may alias a or b.
+ *
+ * @param op operation to apply
+ * @param dst output array of n elements
+ * @param a left operands
+ * @param b right operands
+ * @param n count of elements
+ */
+void simd_binop_i64(enum simd_op op, int64_t *dst, const int64_t *a,
+                    const int64_t *b, int n);
+
+/**
+ * @brief Computes dst[i] = a[i] op b[i] for n doubles.
+ * Uses AVX or SSE2 when the CPU supports it, scalar code otherwise.
+ * dst may alias a or b.
+ *
+ * @param op operation to apply
+ * @param dst output array of n elements
+ * @param a left operands
+ * @param b right operands
+ * @param n count of elements
+ */
+void simd_binop_f64(enum simd_op op, double *dst, const double *a,
+                    const double *b, int n);
+
+/**
+ * @brief Reduces n 32-bit integers with SIMD_ADD, SIMD_MIN or SIMD_MAX.
+ * The sum is accumulated in 64 bits so it does not overflow, minimum and
+ * maximum require n > 0.
+ *
+ * @param op SIMD_ADD, SIMD_MIN or SIMD_MAX
+ * @param a elements to reduce
+ * @param n count of elements
+ * @return int64_t
+ */
+int64_t simd_reduce_i32(enum simd_op op, const int32_t *a, int n);
+
+/**
+ * @brief Reduces n 64-bit integers with SIMD_ADD, SIMD_MIN or SIMD_MAX.
+ * The sum wraps around on overflow, minimum and maximum require n > 0.
+ *
+ * @param op SIMD_ADD, SIMD_MIN or SIMD_MAX
+ * @param a elements to reduce
+ * @param n count of elements
+ * @return int64_t
+ */
+int64_t simd_reduce_i64(enum simd_op op, const int64_t *a, int n);
+
+/**
+ * @brief Reduces n doubles with SIMD_ADD, SIMD_MUL, SIMD_MIN or SIMD_MAX.
+ * The vectorized sum and product add up the lanes separately, so the result
+ * can differ from a sequential loop in the last bits. Minimum and maximum
+ * require n > 0.
+ *
+ * @param op SIMD_ADD, SIMD_MUL, SIMD_MIN or SIMD_MAX
+ * @param a elements to reduce
+ * @param n count of elements
+ * @return double
+ */
+double simd_reduce_f64(enum simd_op op, const double *a, int n);
+
+/**
+ * @brief Counts the 32-bit integers equal to x
+ *
+ * @param a elements to search
+ * @param n count of elements
+ * @param x value to count
+ * @return int
+ */
+int simd_count_eq_i32(const int32_t *a, int n, int32_t x);
+
+/**
+ * @brief Counts the 64-bit integers equal to x
+ *
+ * @param a elements to search
+ * @param n count of elements
+ * @param x value to count
+ * @return int
+ */
+int simd_count_eq_i64(const int64_t *a, int n, int64_t x);
+
+/**
+ * @brief Computes dst[i] += k * b[i] for n 64-bit integers, the inner loop of
+ * the matrix product. Uses AVX2 or SSE4.1 when the CPU supports it, scalar
+ * code otherwise. The results wrap around on overflow.
+ *
+ * @param dst accumulated array of n elements
+ * @param k factor applied to every element of b
+ * @param b right operands, must not overlap dst
+ * @param n count of elements
+ */
+void simd_axpy_i64(int64_t *dst, int64_t k, const int64_t *b, int n);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+
+/**
+ * @brief Total order of nodes used for sorting. Nodes are ordered by type
+ * first (booleans, numbers, symbols, lists, vectors, matrices, heaps, hash
+ * tables), then numbers by value whether integer or float, symbols
+ * alphabetically, lists and vectors element by element, matrices by shape and
+ * then element by element and heaps and hash tables by size. Ranges compare
+ * as lists.
+ *
+ * @param a first node
+ * @param b second node
+ * @return int negative if a < b, 0 if equal, positive if a > b
+ */
+int compare_nodes(const astnode *a, const astnode *b);
+
+/**
+ * @brief Sorts the children of a LIST node or the elements of a VECTOR node
+ * in place. Uses LSD radix sort when all elements are integers and introsort
+ * otherwise. A RANGE node is turned into a list first.
+ *
+ * @param seq LIST, VECTOR or RANGE type node
+ * @param descending sort from the largest if nonzero
+ * @return err_t
+ */
+err_t sort_sequence(astnode *seq, int descending);
+
+/**
+ * @brief Returns a sorted copy of a list or vector, (sort sequence
+ * [descending]). The copy of a list shares the elements of the original.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the sorted TEMPORARY node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_sort(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Sorts a list or vector variable in place and returns the variable,
+ * (sort! variable [descending]).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the sorted variable node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_sort_in_place(astnode *list_node, astnode **result_node, env *env);
+
+#endif
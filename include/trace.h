@@ -0,0 +1,76 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "ast.h"
+#include "err.h"
+#include <stdint.h>
+
+/* deepest operator call traced unless given, the operator of a top-level form
+ * is at depth 1 */
+#define TRACE_DEFAULT_DEPTH 4
+
+/* events kept in the ring, older events are overwritten once it is full */
+#define TRACE_RING_EVENTS (1 << 18)
+
+/**
+ * @brief Begin or end of a traced span
+ */
+struct trace_event {
+  uint64_t ns;      /**< time since trace_start */
+  const char *name; /**< operator symbol, static */
+  int line;         /**< source line, 0 if the list was not parsed */
+  char phase;       /**< 'B' or 'E' */
+  char form;        /**< nonzero for top-level forms, zero for operators */
+};
+
+/**
+ * @brief Allocates the ring of events and turns tracing on
+ *
+ * @param max_depth deepest operator call traced
+ * @return err_t
+ */
+err_t trace_start(int max_depth);
+
+/**
+ * @brief Records the begin of a top-level form, named by its operator
+ *
+ * @param expr the form
+ */
+void trace_form_begin(const astnode *expr);
+
+/**
+ * @brief Records the end of the top-level form begun last
+ */
+void trace_form_end(void);
+
+/**
+ * @brief Enters an operator call, records its begin unless it is deeper than
+ * the traced depth
+ *
+ * @param index of the operator in the operators array
+ * @param list_node List node containing the operator
+ */
+void trace_call_begin(int index, const astnode *list_node);
+
+/**
+ * @brief Leaves the operator call entered last, records its end unless it is
+ * deeper than the traced depth
+ */
+void trace_call_end(void);
+
+/**
+ * @brief Writes the events in the ring as Chrome trace_event JSON, loadable
+ * by Perfetto and chrome://tracing. Ends whose begin was overwritten are
+ * left out.
+ *
+ * @param path of the file to write
+ * @return err_t
+ */
+err_t trace_write(const char *path);
+
+/**
+ * @brief Frees the ring and turns tracing off
+ */
+void trace_stop(void);
+
+#endif
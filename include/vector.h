@@ -0,0 +1,147 @@
+#ifndef VECTOR_H
+#define VECTOR_H
+
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Returns the size of one element of the given vector kind in bytes
+ *
+ * @param kind element type
+ * @return size_t
+ */
+size_t vector_elem_size(enum vector_kind kind);
+
+/**
+ * @brief Returns the i-th element of an integer VECTOR node, no bounds
+ * checking. Elements of a float vector are truncated.
+ *
+ * @param vec VECTOR type node
+ * @param i index of the element
+ * @return int64_t
+ */
+int64_t vector_get(const astnode *vec, int i);
+
+/**
+ * @brief Returns the i-th element of a VECTOR node as a double, no bounds
+ * checking
+ *
+ * @param vec VECTOR type node
+ * @param i index of the element
+ * @return double
+ */
+double vector_get_real(const astnode *vec, int i);
+
+/**
+ * @brief Returns the i-th element of a VECTOR node as a new NUMBER or FLOAT
+ * node, no bounds checking
+ *
+ * @param vec VECTOR type node
+ * @param i index of the element
+ * @return astnode* with UNSET origin or NULL if memory could not be allocated
+ */
+astnode *vector_get_node(const astnode *vec, int i);
+
+/**
+ * @brief Stores the value into the i-th element of a VECTOR node.
+ * A 32-bit vector is widened to 64 bits if the value does not fit, a float
+ * vector stores the value converted to double.
+ *
+ * @param vec VECTOR type node
+ * @param i index of the element, must be in bounds
+ * @param value to store
+ * @return err_t
+ */
+err_t vector_set(astnode *vec, int i, int64_t value);
+
+/**
+ * @brief Stores a NUMBER or FLOAT node into the i-th element of a VECTOR node.
+ * An integer vector is converted to doubles when a FLOAT is stored.
+ *
+ * @param vec VECTOR type node
+ * @param i index of the element, must be in bounds
+ * @param value NUMBER or FLOAT node
+ * @return err_t
+ */
+err_t vector_set_node(astnode *vec, int i, const astnode *value);
+
+/**
+ * @brief Converts a 32-bit vector to 64-bit elements in place
+ *
+ * @param vec VECTOR type node
+ * @return err_t
+ */
+err_t vector_widen(astnode *vec);
+
+/**
+ * @brief Converts an integer vector to double elements in place
+ *
+ * @param vec VECTOR type node
+ * @return err_t
+ */
+err_t vector_to_float(astnode *vec);
+
+/**
+ * @brief Converts a LIST node of NUMBER or FLOAT nodes into a new VECTOR node,
+ * a float vector if any item is a FLOAT.
+ * Fails with syntax error when any item is not a number.
+ *
+ * @param list LIST type node
+ * @param out_node out param, the new vector with UNSET origin
+ * @return err_t
+ */
+err_t list_to_vector(const astnode *list, astnode **out_node);
+
+/**
+ * @brief Creates a new vector. Called either with a count and an optional
+ * initial value (make-vector 10 0), or with a list or range of numbers to
+ * pack (make-vector '(1 2 3)).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result VECTOR node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_make_vector(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Returns the element of a vector at the index as a NUMBER or FLOAT
+ * node, (aref vector index).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result NUMBER or FLOAT node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_aref(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Assigns to a vector element, (set (aref vector index) value).
+ * Called by SET, as vector elements are not nodes that could be replaced.
+ * The vector must be a variable.
+ * @param list_node List node of the SET operator
+ * @param result_node out param pointer to the stored NUMBER or FLOAT node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_set_aref(astnode *list_node, astnode **result_node, env *env);
+
+/**
+ * @brief Element-wise V+, V-, V*, VMIN and VMAX of vectors. The first argument
+ * must be a vector, the others vectors of the same length or NUMBER or FLOAT
+ * nodes applied to every element. Returns a new vector, a float vector if any
+ * operand is a float and an int64 vector if any operand or result does not
+ * fit int32.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result VECTOR node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_vec_arith(astnode *list_node, astnode **result_node, env *env);
+
+#endif
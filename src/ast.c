@@ -1,20 +1,244 @@
 #include "ast.h"
+#include "bignum.h"
 #include "env.h"
 #include "err.h"
+#include "hash.h"
 #include "macros.h"
+#include "memstats.h"
+#include "number.h"
 #include "operators.h"
+#include "profile.h"
+#include "range.h"
+#include "vector.h"
+#include <inttypes.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+uint64_t node_allocs = 0;
+uint64_t node_evals = 0;
+uint64_t node_frees = 0;
+
+/**
+ * @brief Links a node into the list of live nodes when they are tracked. It is
+ * allocated right in front of the node, so copying the whole node over another
+ * leaves it be.
+ */
+struct node_header {
+  struct node_header *prev;
+  struct node_header *next;
+};
+
+static struct node_header live_nodes = {&live_nodes, &live_nodes};
+
+/* nonzero if every node has a header and is linked into live_nodes, fixed
+ * before the first node is allocated */
+static int tracking = 0;
+
+/* count of views alive, while there are any no children array is moved or
+ * reallocated, as one of the views may borrow it */
+static int live_views = 0;
+
+/**
+ * @brief Children array replaced or freed while views were alive, freed once
+ * the last view is gone together with the items it still owns
+ */
+struct retired_array {
+  astnode **base;
+  size_t bytes;
+  astnode **items;
+  int count;
+};
+
+static struct retired_array *retired = NULL;
+static int retired_count = 0;
+static int retired_capacity = 0;
+
+/* bytes of every node without its payload, with the header when tracking */
+static size_t shell_bytes = sizeof(astnode);
+
+/**
+ * @brief Makes every node allocated from now on carry a header linking it
+ * into the live nodes, so next_live_node can walk them. Has to be called
+ * before the first node is allocated.
+ *
+ * @return err_t
+ */
+err_t track_live_nodes(void) {
+  RETURN_ERR_IF(node_allocs, ERR_INTERNAL);
+  tracking = 1;
+  shell_bytes = sizeof(struct node_header) + sizeof(astnode);
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Allocates a zeroed node, linked into the live nodes when they are
+ * tracked
+ *
+ * @return astnode* or NULL if memory could not be allocated
+ */
+static astnode *alloc_node(void) {
+  astnode *node;
+
+  if (tracking) {
+    struct node_header *header = calloc(1, shell_bytes);
+    RETURN_NULL_IF(!header);
+    header->prev = live_nodes.prev;
+    header->next = &live_nodes;
+    live_nodes.prev->next = header;
+    live_nodes.prev = header;
+    node = (astnode *)(header + 1);
+  } else {
+    node = calloc(1, sizeof(astnode));
+    RETURN_NULL_IF(!node);
+  }
+  node_allocs++;
+  mem_charge(MEM_NODES, shell_bytes);
+  return node;
+}
+
+/**
+ * @brief Bytes of the arrays and strings the node holds itself, hash tables
+ * and bignums account for their own memory
+ *
+ * @param node to measure
+ * @return size_t
+ */
+static size_t payload_bytes(const astnode *node) {
+  switch (node->type) {
+  case SYMBOL:
+    return node->as.symbol ? strlen(node->as.symbol) + 1 : 0;
+  case LIST:
+    /* a view owns no children array */
+    return node->as.list.base
+               ? (size_t)node->as.list.capacity * sizeof(astnode *)
+               : 0;
+  case VECTOR:
+    return (size_t)(node->as.vector.count ? node->as.vector.count : 1) *
+           vector_elem_size(node->as.vector.kind);
+  case MATRIX: {
+    size_t count = (size_t)node->as.matrix.rows * node->as.matrix.cols;
+    return (count ? count : 1) * sizeof(int64_t);
+  }
+  case HEAP:
+    return (size_t)node->as.heap.capacity * sizeof(astnode *);
+  default:
+    return 0;
+  }
+}
+
+/**
+ * @brief Frees the node itself but not its content, for nodes whose content
+ * was moved to another node
+ *
+ * @param node to free, may be NULL
+ */
+void free_node_shell(astnode *node) {
+  if (!node)
+    return;
+  if (tracking) {
+    struct node_header *header = (struct node_header *)node - 1;
+    header->prev->next = header->next;
+    header->next->prev = header->prev;
+    free(header);
+  } else {
+    free(node);
+  }
+  node_frees++;
+  mem_discharge(MEM_NODES, shell_bytes);
+}
+
+/**
+ * @brief Keeps a children array replaced or freed while views are alive until
+ * the last of them is gone
+ *
+ * @param base array to retire
+ * @param bytes size of the array
+ * @param items first of the items freed with the array, NULL if it owns none
+ * @param count of the items freed with the array
+ * @return err_t
+ */
+static err_t retire_array(astnode **base, size_t bytes, astnode **items,
+                          int count) {
+  struct retired_array *tmp;
+
+  if (retired_count == retired_capacity) {
+    tmp = realloc(retired, (retired_capacity ? 2 * retired_capacity : 8) *
+                               sizeof(struct retired_array));
+    RETURN_ERR_IF(!tmp, ERR_OUT_OF_MEMORY);
+    retired = tmp;
+    retired_capacity = retired_capacity ? 2 * retired_capacity : 8;
+  }
+  retired[retired_count].base = base;
+  retired[retired_count].bytes = bytes;
+  retired[retired_count].items = items;
+  retired[retired_count].count = count;
+  retired_count++;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Accounts the end of a view and frees the retired children arrays
+ * when it was the last one. Does nothing for lists that are not views.
+ *
+ * @param list LIST type node about to be freed or to get its own array
+ */
+static void end_view(const astnode *list) {
+  if (list->as.list.base || !list->as.list.count)
+    return;
+  if (--live_views)
+    return;
+  for (int i = 0; i < retired_count; i++) {
+    for (int j = 0; j < retired[i].count; j++)
+      free_node(retired[i].items[j]);
+    mem_discharge(MEM_NODES, retired[i].bytes);
+    free(retired[i].base);
+  }
+  free(retired);
+  retired = NULL;
+  retired_count = 0;
+  retired_capacity = 0;
+}
+
+/**
+ * @brief Bytes of the node and everything it holds except its child nodes
+ *
+ * @param node to measure
+ * @return size_t
+ */
+size_t node_bytes(const astnode *node) {
+  size_t bytes = shell_bytes + payload_bytes(node);
+  if (node->type == HASH)
+    bytes += hash_table_bytes(node->as.hash);
+  if (node->type == BIGNUM)
+    bytes += bignum_bytes(node->as.big);
+  return bytes;
+}
+
+/**
+ * @brief Walks all allocated nodes that were not freed yet, in order of
+ * allocation, when they are tracked
+ *
+ * @param node the previous node or NULL for the first one
+ * @return const astnode* the next live node or NULL after the last one, NULL
+ * right away unless track_live_nodes was called
+ */
+const astnode *next_live_node(const astnode *node) {
+  RETURN_NULL_IF(!tracking);
+  const struct node_header *header =
+      node ? ((const struct node_header *)node - 1)->next : live_nodes.next;
+  return header == &live_nodes ? NULL : (const astnode *)(header + 1);
+}
+
 /**
  * @brief Allocates and returns empty list node,
  *
  * @return astnode* or NULL if memory could not be allocated
  */
 astnode *get_list_node() {
-  astnode *nptr = calloc(1, sizeof(astnode));
+  astnode *nptr = alloc_node();
   RETURN_NULL_IF(!nptr);
   nptr->origin = UNSET;
   nptr->type = LIST;
@@ -30,16 +254,17 @@ astnode *get_list_node() {
 astnode *get_symbol_node(const char *symbol) {
   size_t len = strlen(symbol);
 
-  astnode *nptr = calloc(1, sizeof(astnode));
+  astnode *nptr = alloc_node();
   RETURN_NULL_IF(!nptr);
   nptr->origin = UNSET;
   nptr->type = SYMBOL;
   nptr->as.symbol = malloc(len + 1);
   if (!nptr->as.symbol) {
-    free(nptr);
+    free_node_shell(nptr);
     return NULL;
   }
   memcpy(nptr->as.symbol, symbol, len + 1);
+  mem_charge(MEM_NODES, len + 1);
 
   return nptr;
 }
@@ -51,7 +276,7 @@ astnode *get_symbol_node(const char *symbol) {
  * @return astnode* or NULL if could not allocate memory
  */
 astnode *get_bool_node(int truthy) {
-  astnode *nptr = calloc(1, sizeof(astnode));
+  astnode *nptr = alloc_node();
   RETURN_NULL_IF(!nptr);
   nptr->origin = UNSET;
   nptr->type = BOOLEAN;
@@ -65,8 +290,8 @@ astnode *get_bool_node(int truthy) {
  * @param value integer value for the node
  * @return astnode* or NULL if memory could not be allocated
  */
-astnode *get_number_node(int value) {
-  astnode *nptr = malloc(sizeof(astnode));
+astnode *get_number_node(int64_t value) {
+  astnode *nptr = alloc_node();
   RETURN_NULL_IF(!nptr);
   nptr->origin = UNSET;
   nptr->type = NUMBER;
@@ -74,6 +299,145 @@ astnode *get_number_node(int value) {
   return nptr;
 }
 
+/**
+ * @brief Allocates and returns a float node representing the value
+ *
+ * @param real floating point value for the node
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_float_node(double real) {
+  astnode *nptr = alloc_node();
+  RETURN_NULL_IF(!nptr);
+  nptr->origin = UNSET;
+  nptr->type = FLOAT;
+  nptr->as.real = real;
+  return nptr;
+}
+
+/**
+ * @brief Allocates and returns a vector node with count zeroed elements
+ *
+ * @param kind element type of the vector
+ * @param count number of elements
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_vector_node(enum vector_kind kind, int count) {
+  astnode *nptr = alloc_node();
+  RETURN_NULL_IF(!nptr);
+  nptr->origin = UNSET;
+  nptr->type = VECTOR;
+  nptr->as.vector.kind = kind;
+  nptr->as.vector.count = count;
+  nptr->as.vector.data = calloc(count ? count : 1, vector_elem_size(kind));
+  if (!nptr->as.vector.data) {
+    free_node_shell(nptr);
+    return NULL;
+  }
+  mem_charge(MEM_NODES, payload_bytes(nptr));
+  return nptr;
+}
+
+/**
+ * @brief Allocates and returns an empty hash table node
+ *
+ * @param expected count of entries to make room for
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_hash_node(int expected) {
+  astnode *nptr = alloc_node();
+  RETURN_NULL_IF(!nptr);
+  nptr->origin = UNSET;
+  nptr->type = HASH;
+  nptr->as.hash = hash_table_new(expected);
+  if (!nptr->as.hash) {
+    free_node_shell(nptr);
+    return NULL;
+  }
+  return nptr;
+}
+
+/**
+ * @brief Allocates and returns a range node of count integers
+ *
+ * @param start first element
+ * @param step difference of consecutive elements
+ * @param count number of elements
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_range_node(int64_t start, int64_t step, int count) {
+  astnode *nptr = alloc_node();
+  RETURN_NULL_IF(!nptr);
+  nptr->origin = UNSET;
+  nptr->type = RANGE;
+  nptr->as.range.start = start;
+  nptr->as.range.step = step;
+  nptr->as.range.count = count;
+  return nptr;
+}
+
+/**
+ * @brief Allocates and returns a bignum node, the node takes over the number
+ *
+ * @param big value for the node
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_bignum_node(struct Bignum *big) {
+  astnode *nptr = alloc_node();
+  RETURN_NULL_IF(!nptr);
+  nptr->origin = UNSET;
+  nptr->type = BIGNUM;
+  nptr->as.big = big;
+  return nptr;
+}
+
+/**
+ * @brief Allocates and returns a matrix node with rows * cols zeroed elements
+ *
+ * @param rows number of rows
+ * @param cols number of columns
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_matrix_node(int rows, int cols) {
+  size_t count = (size_t)rows * (size_t)cols;
+  astnode *nptr = alloc_node();
+  RETURN_NULL_IF(!nptr);
+  nptr->origin = UNSET;
+  nptr->type = MATRIX;
+  nptr->as.matrix.rows = rows;
+  nptr->as.matrix.cols = cols;
+  nptr->as.matrix.data = calloc(count ? count : 1, sizeof(int64_t));
+  if (!nptr->as.matrix.data) {
+    free_node_shell(nptr);
+    return NULL;
+  }
+  mem_charge(MEM_NODES, payload_bytes(nptr));
+  return nptr;
+}
+
+/**
+ * @brief Allocates and returns an empty heap node
+ *
+ * @param descending keep the largest item on top if nonzero
+ * @param expected count of items to make room for
+ * @return astnode* or NULL if memory could not be allocated
+ */
+astnode *get_heap_node(int descending, int expected) {
+  int capacity = expected > 8 ? expected : 8;
+  astnode *nptr = alloc_node();
+  RETURN_NULL_IF(!nptr);
+  nptr->origin = UNSET;
+  nptr->type = HEAP;
+  nptr->as.heap.descending = descending;
+  nptr->as.heap.capacity = capacity;
+  nptr->as.heap.items = malloc(capacity * sizeof(astnode *));
+  if (!nptr->as.heap.items) {
+    free_node_shell(nptr);
+    return NULL;
+  }
+  mem_charge(MEM_NODES, payload_bytes(nptr));
+  return nptr;
+}
+
 /**
  * @brief appends given node to parents children array
  *
@@ -85,16 +449,159 @@ err_t add_child_node(astnode *parent, astnode *child) {
   /* sanity check */
   RETURN_ERR_IF(!parent || !child || parent->type != LIST, ERR_INTERNAL);
 
-  astnode **tmp = realloc(parent->as.list.children,
-                          (parent->as.list.count + 1) * sizeof(astnode *));
-  RETURN_ERR_IF(!tmp, ERR_OUT_OF_MEMORY);
+  err_t err;
+  int count = parent->as.list.count;
 
-  parent->as.list.children = tmp;
-  parent->as.list.children[parent->as.list.count] = child;
+  if (!parent->as.list.base ||
+      parent->as.list.children + count ==
+          parent->as.list.base + parent->as.list.capacity) {
+    err = reserve_children(parent, count ? 2 * count : 4);
+    RETURN_ERR_IF(err, err);
+  }
+
+  parent->as.list.children[count] = child;
   parent->as.list.count++;
   return ERR_NO_ERROR;
 }
 
+/**
+ * @brief Makes sure the list owns a children array with room for at least
+ * `needed` items, so that appending up to that count does not reallocate.
+ * A view gets its own copy of the array, leading free slots left by dropped
+ * items are reused before the array grows. While any view is alive the items
+ * move to a new array instead, the old one is freed after the last view.
+ *
+ * @param list LIST type node
+ * @param needed count of items the list should hold without reallocation
+ * @return err_t
+ */
+err_t reserve_children(astnode *list, int needed) {
+  /* sanity check */
+  RETURN_ERR_IF(!list || list->type != LIST || needed < 0, ERR_INTERNAL);
+
+  astnode **tmp;
+  int count = list->as.list.count, offset;
+
+  if (needed < count)
+    needed = count;
+  RETURN_VAL_IF(!needed, ERR_NO_ERROR);
+
+  if (!list->as.list.base) {
+    /* a view does not own its children array, give it its own copy */
+    tmp = malloc(needed * sizeof(astnode *));
+    RETURN_ERR_IF(!tmp, ERR_OUT_OF_MEMORY);
+    if (count)
+      memcpy(tmp, list->as.list.children, count * sizeof(astnode *));
+    end_view(list);
+    list->as.list.base = tmp;
+    list->as.list.children = tmp;
+    list->as.list.capacity = needed;
+    mem_charge(MEM_NODES, needed * sizeof(astnode *));
+    return ERR_NO_ERROR;
+  }
+
+  offset = list->as.list.children - list->as.list.base;
+  RETURN_VAL_IF(offset + needed <= list->as.list.capacity, ERR_NO_ERROR);
+
+  if (live_views) {
+    /* a view may borrow the array, so it stays where it is until the views
+     * are gone and the items move to a new one */
+    if (needed < list->as.list.capacity)
+      needed = list->as.list.capacity;
+    tmp = malloc(needed * sizeof(astnode *));
+    RETURN_ERR_IF(!tmp, ERR_OUT_OF_MEMORY);
+    if (retire_array(list->as.list.base,
+                     list->as.list.capacity * sizeof(astnode *), NULL, 0)) {
+      free(tmp);
+      return ERR_OUT_OF_MEMORY;
+    }
+    memcpy(tmp, list->as.list.children, count * sizeof(astnode *));
+    mem_charge(MEM_NODES, needed * sizeof(astnode *));
+    list->as.list.base = tmp;
+    list->as.list.children = tmp;
+    list->as.list.capacity = needed;
+    return ERR_NO_ERROR;
+  }
+
+  /* move the items to the front, the dropped ones left free slots there */
+  if (offset) {
+    memmove(list->as.list.base, list->as.list.children,
+            count * sizeof(astnode *));
+    list->as.list.children = list->as.list.base;
+  }
+  RETURN_VAL_IF(needed <= list->as.list.capacity, ERR_NO_ERROR);
+
+  tmp = realloc(list->as.list.base, needed * sizeof(astnode *));
+  RETURN_ERR_IF(!tmp, ERR_OUT_OF_MEMORY);
+  mem_charge(MEM_NODES, (needed - list->as.list.capacity) * sizeof(astnode *));
+  list->as.list.base = tmp;
+  list->as.list.children = tmp;
+  list->as.list.capacity = needed;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Makes a view of the list node without the first `skip` items, no
+ * children are copied. A temporary list is reused in place, dropping (and
+ * freeing) the skipped items, otherwise a new temporary node borrowing the
+ * children of the original list is returned.
+ *
+ * @param list LIST type node
+ * @param skip count of leading items to leave out, 0 <= skip < count
+ * @param out_node out param, the resulting TEMPORARY list node
+ * @return err_t
+ */
+err_t get_list_view(astnode *list, int skip, astnode **out_node) {
+  /* sanity check */
+  RETURN_ERR_IF(!list || !out_node || list->type != LIST, ERR_INTERNAL);
+  RETURN_ERR_IF(skip < 0 || skip >= list->as.list.count, ERR_INTERNAL);
+
+  astnode *view;
+
+  if (list->origin == TEMPORARY) {
+    /* nobody else refers to a temporary list, just move its window */
+    for (int i = 0; i < skip; i++) {
+      free_temp_node_parts(list->as.list.children[i]);
+      list->as.list.children[i] = NULL;
+    }
+    list->as.list.children += skip;
+    list->as.list.count -= skip;
+    *out_node = list;
+    return ERR_NO_ERROR;
+  }
+
+  view = get_list_node();
+  RETURN_ERR_IF(!view, ERR_OUT_OF_MEMORY);
+  view->origin = TEMPORARY;
+  view->as.list.children = list->as.list.children + skip;
+  view->as.list.count = list->as.list.count - skip;
+  live_views++;
+  *out_node = view;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Checks whether the view node borrows a part of the list node children
+ *
+ * @param view possible view node
+ * @param list LIST type node
+ * @return int 1 if view is a view into the list, 0 otherwise
+ */
+int is_view_of(const astnode *view, const astnode *list) {
+  RETURN_VAL_IF(!view || !list, 0);
+  RETURN_VAL_IF(view->type != LIST || list->type != LIST, 0);
+  RETURN_VAL_IF(view->as.list.base || !view->as.list.count, 0);
+
+  /* compare addresses as integers, the arrays may be unrelated */
+  uintptr_t start = (uintptr_t)list->as.list.children,
+            end = (uintptr_t)(list->as.list.children + list->as.list.count),
+            view_start = (uintptr_t)view->as.list.children,
+            view_end =
+                (uintptr_t)(view->as.list.children + view->as.list.count);
+
+  return view_start >= start && view_end <= end;
+}
+
 /**
  * @brief Base function for node evaluation
  * puts the result node into out_node argument
@@ -110,9 +617,17 @@ err_t eval_node(astnode *node, astnode **out_node, env *env) {
 
   int i, err;
 
+  node_evals++;
   switch (node->type) {
   case BOOLEAN:
   case NUMBER:
+  case VECTOR:
+  case HASH:
+  case RANGE:
+  case BIGNUM:
+  case FLOAT:
+  case MATRIX:
+  case HEAP:
     *out_node = node;
     break;
   case SYMBOL:
@@ -133,17 +648,13 @@ err_t eval_node(astnode *node, astnode **out_node, env *env) {
     RETURN_ERR_IF(node->as.list.children[0]->type != SYMBOL, ERR_SYNTAX_ERROR);
 
     /* if known function operator, execute it */
-    err_t (*func)(astnode *node, astnode **out_node, struct Env *env) = NULL;
-    // printf("%s\n", node->as.list.children[0]->as.symbol);
-    for (i = 0; i < oper_count; i++) {
-      if (!strcmp(operators[i].symbol, node->as.list.children[0]->as.symbol)) {
-        func = operators[i].func;
-        break;
-      }
-    }
-    RETURN_ERR_IF(!func, ERR_UNKNOWN_OPERATOR);
+    i = find_operator(node->as.list.children[0]);
+    RETURN_ERR_IF(i < 0, ERR_UNKNOWN_OPERATOR);
 
-    err = func(node, out_node, env);
+    if (profiling)
+      err = profile_call(i, node, out_node, env);
+    else
+      err = operators[i].func(node, out_node, env);
     RETURN_ERR_IF(err, err);
 
     break;
@@ -169,15 +680,68 @@ err_t make_deep_copy(astnode *original_node, astnode **new_node,
   case NUMBER:
     copy = get_number_node(original_node->as.value);
     break;
+  case FLOAT:
+    copy = get_float_node(original_node->as.real);
+    break;
   case BOOLEAN:
     copy = get_bool_node(original_node->as.value);
     break;
   case SYMBOL:
     copy = get_symbol_node(original_node->as.symbol);
     break;
+  case VECTOR:
+    copy = get_vector_node(original_node->as.vector.kind,
+                           original_node->as.vector.count);
+    CLEANUP_WITH_ERR_IF(!copy, fail_cleanup, ERR_OUT_OF_MEMORY);
+    memcpy(copy->as.vector.data, original_node->as.vector.data,
+           original_node->as.vector.count *
+               vector_elem_size(original_node->as.vector.kind));
+    break;
+  case MATRIX:
+    copy = get_matrix_node(original_node->as.matrix.rows,
+                           original_node->as.matrix.cols);
+    CLEANUP_WITH_ERR_IF(!copy, fail_cleanup, ERR_OUT_OF_MEMORY);
+    memcpy(copy->as.matrix.data, original_node->as.matrix.data,
+           (size_t)original_node->as.matrix.rows *
+               original_node->as.matrix.cols * sizeof(int64_t));
+    break;
+  case HEAP:
+    copy = get_heap_node(original_node->as.heap.descending,
+                         original_node->as.heap.count);
+    CLEANUP_WITH_ERR_IF(!copy, fail_cleanup, ERR_OUT_OF_MEMORY);
+    /* the items are owned by the heap whatever the origin of the copy */
+    for (int i = 0; i < original_node->as.heap.count; ++i) {
+      retval = make_deep_copy(original_node->as.heap.items[i],
+                              &copy->as.heap.items[i], VARIABLE);
+      CLEANUP_WITH_ERR_IF(retval, fail_cleanup, retval);
+      copy->as.heap.count++;
+    }
+    break;
+  case RANGE:
+    copy = get_range_node(original_node->as.range.start,
+                          original_node->as.range.step,
+                          original_node->as.range.count);
+    break;
+  case BIGNUM: {
+    bignum *big = bignum_copy(original_node->as.big);
+    CLEANUP_WITH_ERR_IF(!big, fail_cleanup, ERR_OUT_OF_MEMORY);
+    copy = get_bignum_node(big);
+    if (!copy)
+      bignum_free(big);
+    break;
+  }
+  case HASH:
+    copy = alloc_node();
+    CLEANUP_WITH_ERR_IF(!copy, fail_cleanup, ERR_OUT_OF_MEMORY);
+    copy->type = HASH;
+    retval = hash_table_copy(original_node->as.hash, &copy->as.hash, origin);
+    CLEANUP_WITH_ERR_IF(retval, fail_cleanup, retval);
+    break;
   case LIST: {
     copy = get_list_node();
     CLEANUP_WITH_ERR_IF(!copy, fail_cleanup, ERR_OUT_OF_MEMORY);
+    retval = reserve_children(copy, original_node->as.list.count);
+    CLEANUP_WITH_ERR_IF(retval, fail_cleanup, retval);
     /* recursively make copy and add all childen to resulting node */
     for (int i = 0; i < original_node->as.list.count; ++i) {
       retval = make_deep_copy(original_node->as.list.children[i], &child_clone,
@@ -213,14 +777,36 @@ fail_cleanup:
 void free_node_content(astnode *node) {
   if (!node)
     return;
+  mem_discharge(MEM_NODES, payload_bytes(node));
   if (node->type == SYMBOL) {
     free(node->as.symbol);
   }
-  if (node->type == LIST && node->as.list.children) {
+  if (node->type == VECTOR) {
+    free(node->as.vector.data);
+  }
+  if (node->type == MATRIX) {
+    free(node->as.matrix.data);
+  }
+  if (node->type == HEAP) {
+    for (int i = 0; i < node->as.heap.count; i++) {
+      free_node(node->as.heap.items[i]);
+    }
+    free(node->as.heap.items);
+  }
+  if (node->type == HASH) {
+    hash_table_free(node->as.hash);
+  }
+  if (node->type == BIGNUM) {
+    bignum_free(node->as.big);
+  }
+  /* views own neither the children array nor the children */
+  if (node->type == LIST)
+    end_view(node);
+  if (node->type == LIST && node->as.list.base) {
     for (int i = 0; i < node->as.list.count; i++) {
       free_node(node->as.list.children[i]);
     }
-    free(node->as.list.children);
+    free(node->as.list.base);
   }
 }
 
@@ -230,8 +816,29 @@ void free_node_content(astnode *node) {
  * @param node to free
  */
 void free_node(astnode *node) {
+  if (!node)
+    return;
   free_node_content(node);
-  free(node);
+  free_node_shell(node);
+}
+
+/**
+ * @brief Frees the content of a variable about to be reassigned like
+ * free_node_content, but while views are alive a list keeps its children
+ * array and items until the last view is gone, as one may borrow them.
+ *
+ * @param node to free
+ * @return err_t
+ */
+err_t free_var_content(astnode *node) {
+  RETURN_ERR_IF(!node, ERR_INTERNAL);
+  if (!live_views || node->type != LIST || !node->as.list.base) {
+    free_node_content(node);
+    return ERR_NO_ERROR;
+  }
+  return retire_array(node->as.list.base,
+                      node->as.list.capacity * sizeof(astnode *),
+                      node->as.list.children, node->as.list.count);
 }
 
 /**
@@ -250,20 +857,53 @@ void free_temp_node_parts(astnode *node) {
   switch (node->type) {
   case BOOLEAN:
   case NUMBER:
-    free(node);
+  case FLOAT:
+    free_node_shell(node);
     return;
   case SYMBOL:
+    mem_discharge(MEM_NODES, payload_bytes(node));
     free(node->as.symbol);
-    free(node);
+    free_node_shell(node);
+    return;
+  case VECTOR:
+    mem_discharge(MEM_NODES, payload_bytes(node));
+    free(node->as.vector.data);
+    free_node_shell(node);
+    return;
+  case MATRIX:
+    mem_discharge(MEM_NODES, payload_bytes(node));
+    free(node->as.matrix.data);
+    free_node_shell(node);
+    return;
+  case HEAP:
+    free_node(node);
+    return;
+  case HASH:
+    hash_table_free(node->as.hash);
+    free_node_shell(node);
+    return;
+  case RANGE:
+    free_node_shell(node);
+    return;
+  case BIGNUM:
+    bignum_free(node->as.big);
+    free_node_shell(node);
     return;
   case LIST:
-    for (int i = 0; i < node->as.list.count; i++) {
-      free_temp_node_parts(node->as.list.children[i]);
-      node->as.list.children[i] = NULL;
+    /* children borrowed by a view are never temporary */
+    if (node->as.list.base) {
+      for (int i = 0; i < node->as.list.count; i++) {
+        free_temp_node_parts(node->as.list.children[i]);
+        node->as.list.children[i] = NULL;
+      }
+      mem_discharge(MEM_NODES, payload_bytes(node));
+      free(node->as.list.base);
+    } else {
+      end_view(node);
     }
-    free(node->as.list.children);
+    node->as.list.base = NULL;
     node->as.list.children = NULL;
-    free(node);
+    free_node_shell(node);
     return;
   }
 };
@@ -272,10 +912,19 @@ void free_temp_node_parts(astnode *node) {
  * @brief Prints the AST node to standard output in Lisp-like format.
  *
  * The output format is:
- * - Numbers are printed as integers (e.g., 42).
+ * - Numbers and bignums are printed as integers (e.g., 42).
+ * - Floats are printed with a decimal point or exponent (e.g., 1.5, 1e+100).
  * - Symbols are printed as their string names (e.g., add).
  * - Lists are printed as parentheses containing space-separated child nodes
  * (e.g., (add 1 2)).
+ * - Vectors are printed as their elements prefixed with hash (e.g., #(1 2)).
+ * - Hash tables are printed as key value pairs in no particular order
+ *   (e.g., #H((A 1) (B 2))).
+ * - Ranges are printed as the list of their elements.
+ * - Matrices are printed as the list of their rows prefixed with #2A
+ *   (e.g., #2A((1 2) (3 4))).
+ * - Heaps are printed as their items prefixed with #HEAP, the top first and
+ *   the rest in heap order (e.g., #HEAP(1 3 2)).
  * - NULL nodes are printed as NIL.
  */
 void print_node(astnode *node) {
@@ -285,7 +934,16 @@ void print_node(astnode *node) {
 
   switch (node->type) {
   case NUMBER:
-    printf("%d", node->as.value);
+    printf("%" PRId64, node->as.value);
+    break;
+  case BIGNUM: {
+    char *digits = bignum_to_string(node->as.big);
+    fputs(digits ? digits : "??", stdout);
+    free(digits);
+    break;
+  }
+  case FLOAT:
+    print_float(node->as.real);
     break;
   case BOOLEAN:
     fputs(node->as.value ? "T" : "NIL", stdout);
@@ -306,5 +964,73 @@ void print_node(astnode *node) {
     }
     fputc(')', stdout);
     break;
+  case VECTOR:
+    fputs("#(", stdout);
+    for (int i = 0; i < node->as.vector.count; ++i) {
+      if (i)
+        fputc(' ', stdout);
+      if (node->as.vector.kind == VEC_F64)
+        print_float(vector_get_real(node, i));
+      else
+        printf("%" PRId64, vector_get(node, i));
+    }
+    fputc(')', stdout);
+    break;
+  case RANGE:
+    fputc('(', stdout);
+    for (int i = 0; i < node->as.range.count; ++i) {
+      if (i)
+        fputc(' ', stdout);
+      printf("%" PRId64, range_get(node, i));
+    }
+    fputc(')', stdout);
+    break;
+  case MATRIX:
+    fputs("#2A(", stdout);
+    for (int i = 0; i < node->as.matrix.rows; ++i) {
+      if (i)
+        fputc(' ', stdout);
+      fputc('(', stdout);
+      for (int j = 0; j < node->as.matrix.cols; ++j) {
+        if (j)
+          fputc(' ', stdout);
+        printf("%" PRId64,
+               node->as.matrix.data[(size_t)i * node->as.matrix.cols + j]);
+      }
+      fputc(')', stdout);
+    }
+    fputc(')', stdout);
+    break;
+  case HEAP:
+    fputs("#HEAP(", stdout);
+    for (int i = 0; i < node->as.heap.count; ++i) {
+      if (i)
+        fputc(' ', stdout);
+      print_node(node->as.heap.items[i]);
+    }
+    fputc(')', stdout);
+    break;
+  case HASH: {
+    struct hash_slot *slot;
+    int pos = 0, first = 1;
+    fputs("#H(", stdout);
+    while ((slot = hash_table_next(node->as.hash, &pos))) {
+      if (!first)
+        fputc(' ', stdout);
+      first = 0;
+      fputc('(', stdout);
+      if (slot->key_type == SYMBOL)
+        fputs(slot->key.symbol, stdout);
+      else if (slot->key_type == BOOLEAN)
+        fputs(slot->key.value ? "T" : "NIL", stdout);
+      else
+        printf("%" PRId64, slot->key.value);
+      fputc(' ', stdout);
+      print_node(slot->value);
+      fputc(')', stdout);
+    }
+    fputc(')', stdout);
+    break;
+  }
   }
 }
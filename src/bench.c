@@ -0,0 +1,88 @@
+#define _XOPEN_SOURCE 600
+#include "bench.h"
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include "macros.h"
+#include "main.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief Reads the monotonic clock
+ *
+ * @return uint64_t nanoseconds
+ */
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Orders latencies ascending
+ *
+ * @param a pointer to a uint64_t
+ * @param b pointer to a uint64_t
+ * @return int
+ */
+static int by_latency(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * @brief Evaluates a parsed program the given count of times, every time in
+ * a fresh environment, and prints the min, median and p99 latency of the
+ * evaluations with their node evaluations and allocations to stderr
+ *
+ * Creating and freeing the environment is not timed.
+ *
+ * @param root list of the outer expressions from parse_source
+ * @param source_code the source the spans of the expressions point to
+ * @param iterations count of evaluations
+ * @param verbose print every expression and its result in every iteration
+ * @return err_t of the first failed evaluation
+ */
+err_t bench_program(astnode *root, const char *source_code, long iterations,
+                    int verbose) {
+  /* sanity check */
+  RETURN_ERR_IF(!root || !source_code || iterations < 1, ERR_INTERNAL);
+
+  err_t retval = ERR_NO_ERROR;
+  uint64_t *latencies = NULL, start, evals, allocs;
+  env *env = NULL;
+  long done;
+
+  latencies = malloc(iterations * sizeof(uint64_t));
+  RETURN_ERR_IF(!latencies, ERR_OUT_OF_MEMORY);
+
+  evals = node_evals;
+  allocs = node_allocs;
+  for (done = 0; done < iterations; done++) {
+    env = create_env();
+    CLEANUP_WITH_ERR_IF(!env, cleanup, ERR_OUT_OF_MEMORY);
+    start = now_ns();
+    retval = eval_program(root, source_code, verbose, env);
+    latencies[done] = now_ns() - start;
+    free_env(env);
+    env = NULL;
+    CLEANUP_WITH_ERR_IF(retval, cleanup, retval);
+  }
+  evals = node_evals - evals;
+  allocs = node_allocs - allocs;
+
+  qsort(latencies, iterations, sizeof(uint64_t), by_latency);
+  fprintf(stderr, "bench: %ld iterations\n", iterations);
+  fprintf(stderr, "  latency ms   min %.3f   median %.3f   p99 %.3f\n",
+          latencies[0] / 1e6, latencies[(iterations - 1) / 2] / 1e6,
+          latencies[(iterations * 99 + 99) / 100 - 1] / 1e6);
+  fprintf(stderr, "  per iteration   %.0f evaluations   %.0f allocations\n",
+          (double)evals / iterations, (double)allocs / iterations);
+
+cleanup:
+  free(latencies);
+  return retval;
+}
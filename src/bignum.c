@@ -0,0 +1,668 @@
+#include "bignum.h"
+#include "ast.h"
+#include "err.h"
+#include "macros.h"
+#include "memstats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* largest power of ten that fits a limb, used for decimal conversion */
+#define DECIMAL_BASE 1000000000u
+#define DECIMAL_DIGITS 9
+
+/**
+ * @brief Allocates a zeroed bignum with room for count limbs
+ *
+ * @param count limbs to allocate
+ * @return bignum* or NULL if memory could not be allocated
+ */
+static bignum *bignum_alloc(int count) {
+  bignum *big = malloc(sizeof(bignum));
+  RETURN_NULL_IF(!big);
+  big->sign = 1;
+  big->count = count;
+  big->capacity = count ? count : 1;
+  big->limbs = calloc(big->capacity, sizeof(uint32_t));
+  if (!big->limbs) {
+    free(big);
+    return NULL;
+  }
+  mem_charge(MEM_NODES, bignum_bytes(big));
+  return big;
+}
+
+/**
+ * @brief Drops leading zero limbs, zero gets a positive sign
+ *
+ * @param big number to normalize
+ */
+static void bignum_trim(bignum *big) {
+  while (big->count && !big->limbs[big->count - 1])
+    big->count--;
+  if (!big->count)
+    big->sign = 1;
+}
+
+/**
+ * @brief Allocates a bignum holding the value
+ *
+ * @param value to convert
+ * @return bignum* or NULL if memory could not be allocated
+ */
+bignum *bignum_from_int(int64_t value) {
+  uint64_t mag = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+  bignum *big = bignum_alloc(2);
+  RETURN_NULL_IF(!big);
+
+  big->sign = value < 0 ? -1 : 1;
+  big->limbs[0] = (uint32_t)mag;
+  big->limbs[1] = (uint32_t)(mag >> 32);
+  bignum_trim(big);
+  return big;
+}
+
+/**
+ * @brief Computes big = big * mul + add in place, the limbs must have room for
+ * one more limb
+ *
+ * @param big number to update
+ * @param mul multiplier
+ * @param add addend
+ */
+static void bignum_mul_add_small(bignum *big, uint32_t mul, uint32_t add) {
+  uint64_t carry = add;
+  for (int i = 0; i < big->count; i++) {
+    carry += (uint64_t)big->limbs[i] * mul;
+    big->limbs[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  if (carry)
+    big->limbs[big->count++] = (uint32_t)carry;
+}
+
+/**
+ * @brief Parses a decimal integer literal with an optional sign
+ *
+ * @param s digits to parse, must be a valid number
+ * @return bignum* or NULL if memory could not be allocated
+ */
+bignum *bignum_parse(const char *s) {
+  int sign = 1, len, chunk;
+  uint32_t value, scale;
+
+  if (*s == '-' || *s == '+')
+    sign = *s++ == '-' ? -1 : 1;
+  len = strlen(s);
+
+  /* every 9 digits need less than one 32-bit limb */
+  bignum *big = bignum_alloc(len / DECIMAL_DIGITS + 1);
+  RETURN_NULL_IF(!big);
+  big->count = 0;
+
+  /* the first chunk takes the digits that do not make a full chunk */
+  chunk = len % DECIMAL_DIGITS ? len % DECIMAL_DIGITS : DECIMAL_DIGITS;
+  while (*s) {
+    value = 0;
+    scale = 1;
+    for (int i = 0; i < chunk; i++) {
+      value = value * 10 + (uint32_t)(*s++ - '0');
+      scale *= 10;
+    }
+    bignum_mul_add_small(big, scale, value);
+    chunk = DECIMAL_DIGITS;
+  }
+
+  big->sign = sign;
+  bignum_trim(big);
+  return big;
+}
+
+/**
+ * @brief Formats the bignum as a decimal string
+ *
+ * @param big number to format
+ * @return char* to be freed by the caller or NULL if memory could not be
+ * allocated
+ */
+char *bignum_to_string(const bignum *big) {
+  int n = big->count, chunks = 0;
+  uint32_t *mag = malloc(sizeof(uint32_t) * (n ? n : 1));
+  /* a limb holds less than 10 decimal digits, so 10/9 chunks per limb */
+  uint32_t *digits = malloc(sizeof(uint32_t) * (n * 10 / 9 + 2));
+  char *str = malloc((size_t)(n * 10 / 9 + 2) * DECIMAL_DIGITS + 2), *pos;
+
+  if (!mag || !digits || !str) {
+    free(mag);
+    free(digits);
+    free(str);
+    return NULL;
+  }
+
+  /* peel off base 10^9 digits by repeated short division */
+  memcpy(mag, big->limbs, sizeof(uint32_t) * n);
+  do {
+    uint64_t rem = 0;
+    for (int i = n - 1; i >= 0; i--) {
+      rem = (rem << 32) | mag[i];
+      mag[i] = (uint32_t)(rem / DECIMAL_BASE);
+      rem %= DECIMAL_BASE;
+    }
+    while (n && !mag[n - 1])
+      n--;
+    digits[chunks++] = (uint32_t)rem;
+  } while (n);
+
+  pos = str;
+  if (big->sign < 0)
+    *pos++ = '-';
+  pos += sprintf(pos, "%u", digits[--chunks]);
+  while (chunks)
+    pos += sprintf(pos, "%09u", digits[--chunks]);
+
+  free(mag);
+  free(digits);
+  return str;
+}
+
+/**
+ * @brief Makes a copy of the bignum
+ *
+ * @param big number to copy
+ * @return bignum* or NULL if memory could not be allocated
+ */
+bignum *bignum_copy(const bignum *big) {
+  bignum *copy = bignum_alloc(big->count);
+  RETURN_NULL_IF(!copy);
+  copy->sign = big->sign;
+  memcpy(copy->limbs, big->limbs, sizeof(uint32_t) * big->count);
+  return copy;
+}
+
+/**
+ * @brief Frees the bignum
+ *
+ * @param big number to free, may be NULL
+ */
+void bignum_free(bignum *big) {
+  if (!big)
+    return;
+  mem_discharge(MEM_NODES, bignum_bytes(big));
+  free(big->limbs);
+  free(big);
+}
+
+/**
+ * @brief Bytes allocated for the bignum
+ *
+ * @param big number to measure
+ * @return size_t
+ */
+size_t bignum_bytes(const bignum *big) {
+  return sizeof(bignum) + (size_t)big->capacity * sizeof(uint32_t);
+}
+
+/**
+ * @brief Converts the bignum to a 64-bit integer if it fits
+ *
+ * @param big number to convert
+ * @param value out param, the converted value
+ * @return int 1 if the number fits, 0 otherwise
+ */
+int bignum_to_int(const bignum *big, int64_t *value) {
+  uint64_t mag = 0;
+
+  RETURN_VAL_IF(big->count > 2, 0);
+  if (big->count > 0)
+    mag = big->limbs[0];
+  if (big->count > 1)
+    mag |= (uint64_t)big->limbs[1] << 32;
+
+  if (big->sign > 0) {
+    RETURN_VAL_IF(mag > (uint64_t)INT64_MAX, 0);
+    *value = (int64_t)mag;
+  } else {
+    RETURN_VAL_IF(mag > (uint64_t)INT64_MAX + 1, 0);
+    *value = mag == (uint64_t)INT64_MAX + 1 ? INT64_MIN : -(int64_t)mag;
+  }
+  return 1;
+}
+
+/**
+ * @brief Converts the bignum to the nearest double, infinity if it is too
+ * large
+ *
+ * @param big number to convert
+ * @return double
+ */
+double bignum_to_double(const bignum *big) {
+  double real = 0;
+  for (int i = big->count - 1; i >= 0; i--)
+    real = real * 4294967296.0 + big->limbs[i];
+  return big->sign < 0 ? -real : real;
+}
+
+/**
+ * @brief Compares the magnitudes of two limb arrays without leading zeros
+ *
+ * @return int negative, 0 or positive like memcmp
+ */
+static int mag_cmp(const uint32_t *a, int an, const uint32_t *b, int bn) {
+  RETURN_VAL_IF(an != bn, an < bn ? -1 : 1);
+  for (int i = an - 1; i >= 0; i--)
+    RETURN_VAL_IF(a[i] != b[i], a[i] < b[i] ? -1 : 1);
+  return 0;
+}
+
+/**
+ * @brief Compares two bignums
+ *
+ * @param a first number
+ * @param b second number
+ * @return int negative if a < b, 0 if equal, positive if a > b
+ */
+int bignum_cmp(const bignum *a, const bignum *b) {
+  RETURN_VAL_IF(a->sign != b->sign, a->sign);
+  return a->sign * mag_cmp(a->limbs, a->count, b->limbs, b->count);
+}
+
+/**
+ * @brief Adds a to r in place, an <= rn
+ *
+ * @return uint32_t carry out of the top limb of r
+ */
+static uint32_t mag_add_to(uint32_t *r, int rn, const uint32_t *a, int an) {
+  uint64_t carry = 0;
+  int i;
+  for (i = 0; i < an; i++) {
+    carry += (uint64_t)r[i] + a[i];
+    r[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  for (; carry && i < rn; i++) {
+    carry += r[i];
+    r[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  return (uint32_t)carry;
+}
+
+/**
+ * @brief Subtracts a from r in place, r must not be smaller than a
+ */
+static void mag_sub_from(uint32_t *r, int rn, const uint32_t *a, int an) {
+  int64_t borrow = 0;
+  int i;
+  for (i = 0; i < an; i++) {
+    borrow += (int64_t)r[i] - a[i];
+    r[i] = (uint32_t)borrow;
+    borrow = borrow < 0 ? -1 : 0;
+  }
+  for (; borrow && i < rn; i++) {
+    borrow += r[i];
+    r[i] = (uint32_t)borrow;
+    borrow = borrow < 0 ? -1 : 0;
+  }
+}
+
+/**
+ * @brief Schoolbook multiplication, r[0..n+m) = a[0..n) * b[0..m)
+ */
+static void mag_mul_basecase(uint32_t *r, const uint32_t *a, int n,
+                             const uint32_t *b, int m) {
+  memset(r, 0, sizeof(uint32_t) * (n + m));
+  for (int i = 0; i < n; i++) {
+    uint64_t carry = 0;
+    if (!a[i])
+      continue;
+    for (int j = 0; j < m; j++) {
+      carry += (uint64_t)a[i] * b[j] + r[i + j];
+      r[i + j] = (uint32_t)carry;
+      carry >>= 32;
+    }
+    r[i + m] = (uint32_t)carry;
+  }
+}
+
+/**
+ * @brief Multiplies magnitudes, r[0..n+m) = a[0..n) * b[0..m). Operands of at
+ * least KARATSUBA_THRESHOLD limbs are split in halves, which needs three half
+ * size products instead of four. r must not alias a or b.
+ *
+ * @return int 1 on success, 0 if memory could not be allocated
+ */
+static int mag_mul(uint32_t *r, const uint32_t *a, int n, const uint32_t *b,
+                   int m) {
+  if (n < m) {
+    const uint32_t *swap = a;
+    int swap_n = n;
+    a = b, n = m, b = swap, m = swap_n;
+  }
+  if (m < KARATSUBA_THRESHOLD) {
+    mag_mul_basecase(r, a, n, b, m);
+    return 1;
+  }
+
+  int h = n / 2, an = n - h, bn = m - h, sn = an + 1, tn;
+  uint32_t *buf;
+
+  if (m <= h) {
+    /* b is short, r = a0 * b + (a1 * b << h) */
+    buf = malloc(sizeof(uint32_t) * (an + m));
+    RETURN_VAL_IF(!buf, 0);
+    if (!mag_mul(r, a, h, b, m) || !mag_mul(buf, a + h, an, b, m)) {
+      free(buf);
+      return 0;
+    }
+    memset(r + h + m, 0, sizeof(uint32_t) * an);
+    mag_add_to(r + h, an + m, buf, an + m);
+    free(buf);
+    return 1;
+  }
+
+  /* a = a1 B^h + a0, b = b1 B^h + b0, the middle term is
+   * (a0 + a1)(b0 + b1) - a0 b0 - a1 b1 */
+  tn = (bn > h ? bn : h) + 1;
+  buf = calloc(2 * (sn + tn), sizeof(uint32_t));
+  RETURN_VAL_IF(!buf, 0);
+  uint32_t *sa = buf, *sb = buf + sn, *mid = buf + sn + tn;
+
+  memcpy(sa, a, sizeof(uint32_t) * h);
+  mag_add_to(sa, sn, a + h, an);
+  memcpy(sb, b, sizeof(uint32_t) * h);
+  mag_add_to(sb, tn, b + h, bn);
+
+  if (!mag_mul(r, a, h, b, h) || !mag_mul(r + 2 * h, a + h, an, b + h, bn) ||
+      !mag_mul(mid, sa, sn, sb, tn)) {
+    free(buf);
+    return 0;
+  }
+  mag_sub_from(mid, sn + tn, r, 2 * h);
+  mag_sub_from(mid, sn + tn, r + 2 * h, an + bn);
+
+  int mn = sn + tn;
+  while (mn && !mid[mn - 1])
+    mn--;
+  mag_add_to(r + h, n + m - h, mid, mn);
+  free(buf);
+  return 1;
+}
+
+/**
+ * @brief Divides magnitudes, q[0..n-m] = u[0..n) / v[0..m), Knuth's algorithm
+ * D. Requires n >= m >= 2 and a nonzero top limb of v.
+ *
+ * @return int 1 on success, 0 if memory could not be allocated
+ */
+static int mag_div(uint32_t *q, const uint32_t *u, int n, const uint32_t *v,
+                   int m) {
+  uint32_t *vn = malloc(sizeof(uint32_t) * m);
+  uint32_t *un = malloc(sizeof(uint32_t) * (n + 1));
+  int s = __builtin_clz(v[m - 1]);
+
+  if (!vn || !un) {
+    free(vn);
+    free(un);
+    return 0;
+  }
+
+  /* shift so the top limb of the divisor has its high bit set */
+  for (int i = m - 1; i > 0; i--)
+    vn[i] = (uint32_t)(((uint64_t)v[i] << s) | ((uint64_t)v[i - 1] >> (32 - s)));
+  vn[0] = v[0] << s;
+  un[n] = (uint32_t)((uint64_t)u[n - 1] >> (32 - s));
+  for (int i = n - 1; i > 0; i--)
+    un[i] = (uint32_t)(((uint64_t)u[i] << s) | ((uint64_t)u[i - 1] >> (32 - s)));
+  un[0] = u[0] << s;
+
+  for (int j = n - m; j >= 0; j--) {
+    /* estimate the quotient limb from the top two limbs, off by at most 2 */
+    uint64_t num = ((uint64_t)un[j + m] << 32) | un[j + m - 1];
+    uint64_t qhat = num / vn[m - 1], rhat = num % vn[m - 1];
+    while (qhat >> 32 ||
+           qhat * vn[m - 2] > ((rhat << 32) | un[j + m - 2])) {
+      qhat--;
+      rhat += vn[m - 1];
+      if (rhat >> 32)
+        break;
+    }
+
+    /* multiply and subtract */
+    int64_t borrow = 0, t;
+    for (int i = 0; i < m; i++) {
+      uint64_t p = qhat * vn[i];
+      t = (int64_t)un[i + j] - borrow - (int64_t)(p & 0xffffffffu);
+      un[i + j] = (uint32_t)t;
+      borrow = (int64_t)(p >> 32) - (t >> 32);
+    }
+    t = (int64_t)un[j + m] - borrow;
+    un[j + m] = (uint32_t)t;
+
+    q[j] = (uint32_t)qhat;
+    if (t < 0) {
+      /* the estimate was one too large, add the divisor back */
+      q[j]--;
+      un[j + m] += mag_add_to(un + j, m, vn, m);
+    }
+  }
+
+  free(vn);
+  free(un);
+  return 1;
+}
+
+/**
+ * @brief Adds two signed magnitudes, the sign of b is given separately so the
+ * same code subtracts
+ *
+ * @return bignum* or NULL if memory could not be allocated
+ */
+static bignum *bignum_add_signed(const bignum *a, const bignum *b,
+                                 int b_sign) {
+  const bignum *big = a, *small = b;
+  int sign = a->sign;
+  bignum *r;
+
+  if (a->sign == b_sign) {
+    if (a->count < b->count)
+      big = b, small = a;
+    r = bignum_alloc(big->count + 1);
+    RETURN_NULL_IF(!r);
+    memcpy(r->limbs, big->limbs, sizeof(uint32_t) * big->count);
+    mag_add_to(r->limbs, r->count, small->limbs, small->count);
+  } else {
+    if (mag_cmp(a->limbs, a->count, b->limbs, b->count) < 0) {
+      big = b, small = a;
+      sign = b_sign;
+    }
+    r = bignum_alloc(big->count);
+    RETURN_NULL_IF(!r);
+    memcpy(r->limbs, big->limbs, sizeof(uint32_t) * big->count);
+    mag_sub_from(r->limbs, r->count, small->limbs, small->count);
+  }
+
+  r->sign = sign;
+  bignum_trim(r);
+  return r;
+}
+
+/**
+ * @brief Computes a op b, division truncates toward zero like C does
+ *
+ * @param op operation to apply
+ * @param a left operand
+ * @param b right operand, nonzero for INT_DIV
+ * @return bignum* or NULL if memory could not be allocated
+ */
+bignum *bignum_arith(enum int_op op, const bignum *a, const bignum *b) {
+  bignum *r;
+
+  switch (op) {
+  case INT_ADD:
+    return bignum_add_signed(a, b, b->sign);
+  case INT_SUB:
+    return bignum_add_signed(a, b, -b->sign);
+  case INT_MUL:
+    r = bignum_alloc(a->count + b->count);
+    RETURN_NULL_IF(!r);
+    if (a->count && b->count &&
+        !mag_mul(r->limbs, a->limbs, a->count, b->limbs, b->count)) {
+      bignum_free(r);
+      return NULL;
+    }
+    break;
+  default:
+    if (mag_cmp(a->limbs, a->count, b->limbs, b->count) < 0)
+      return bignum_alloc(0);
+    r = bignum_alloc(a->count - b->count + 1);
+    RETURN_NULL_IF(!r);
+    if (b->count == 1) {
+      uint64_t rem = 0;
+      for (int i = a->count - 1; i >= 0; i--) {
+        rem = (rem << 32) | a->limbs[i];
+        r->limbs[i] = (uint32_t)(rem / b->limbs[0]);
+        rem %= b->limbs[0];
+      }
+    } else if (!mag_div(r->limbs, a->limbs, a->count, b->limbs, b->count)) {
+      bignum_free(r);
+      return NULL;
+    }
+    break;
+  }
+
+  r->sign = a->sign * b->sign;
+  bignum_trim(r);
+  return r;
+}
+
+/**
+ * @brief Checks whether the node is an integer, a NUMBER or BIGNUM node
+ *
+ * @param node to check
+ * @return int 1 if it is, 0 otherwise
+ */
+int is_integer(const astnode *node) {
+  return node->type == NUMBER || node->type == BIGNUM;
+}
+
+/**
+ * @brief Compares two integer nodes without allocating
+ *
+ * @param a NUMBER or BIGNUM node
+ * @param b NUMBER or BIGNUM node
+ * @return int negative if a < b, 0 if equal, positive if a > b
+ */
+int compare_integers(const astnode *a, const astnode *b) {
+  if (a->type == NUMBER && b->type == NUMBER)
+    return (a->as.value > b->as.value) - (a->as.value < b->as.value);
+  /* BIGNUM nodes never fit 64 bits, so they are beyond any NUMBER */
+  if (a->type == NUMBER)
+    return -b->as.big->sign;
+  if (b->type == NUMBER)
+    return a->as.big->sign;
+  return bignum_cmp(a->as.big, b->as.big);
+}
+
+/**
+ * @brief Applies op to two fixnums unless the result overflows
+ *
+ * @param op operation to apply
+ * @param acc in/out param, left operand and result
+ * @param value right operand, nonzero for INT_DIV
+ * @return int 1 on success, 0 on overflow with acc unchanged
+ */
+static int fixnum_apply(enum int_op op, int64_t *acc, int64_t value) {
+  int64_t result;
+
+  switch (op) {
+  case INT_ADD:
+    RETURN_VAL_IF(__builtin_add_overflow(*acc, value, &result), 0);
+    break;
+  case INT_SUB:
+    RETURN_VAL_IF(__builtin_sub_overflow(*acc, value, &result), 0);
+    break;
+  case INT_MUL:
+    RETURN_VAL_IF(__builtin_mul_overflow(*acc, value, &result), 0);
+    break;
+  default:
+    RETURN_VAL_IF(*acc == INT64_MIN && value == -1, 0);
+    result = *acc / value;
+    break;
+  }
+  *acc = result;
+  return 1;
+}
+
+/**
+ * @brief Applies op to an integer accumulator, which is the fixnum `*fix`
+ * while `*big` is NULL and the bignum `*big` otherwise. The fixnum path uses
+ * overflow checked machine arithmetic and does not allocate, results that do
+ * not fit 64 bits move the accumulator to a bignum and back once they fit.
+ *
+ * @param op operation to apply
+ * @param fix in/out param, fixnum accumulator
+ * @param big in/out param, bignum accumulator or NULL, on failure it is kept
+ * @param arg NUMBER or BIGNUM right operand
+ * @return err_t
+ */
+err_t integer_apply(enum int_op op, int64_t *fix, bignum **big,
+                    const astnode *arg) {
+  RETURN_ERR_IF(!is_integer(arg), ERR_SYNTAX_ERROR);
+  RETURN_ERR_IF(op == INT_DIV && arg->type == NUMBER && !arg->as.value,
+                ERR_ZERO_DIVISON);
+
+  if (!*big && arg->type == NUMBER && fixnum_apply(op, fix, arg->as.value))
+    return ERR_NO_ERROR;
+
+  err_t retval = ERR_NO_ERROR;
+  bignum *a = *big, *b = NULL, *result;
+
+  if (!a) {
+    a = bignum_from_int(*fix);
+    RETURN_ERR_IF(!a, ERR_OUT_OF_MEMORY);
+  }
+  if (arg->type == NUMBER) {
+    b = bignum_from_int(arg->as.value);
+    CLEANUP_WITH_ERR_IF(!b, fail_cleanup, ERR_OUT_OF_MEMORY);
+  }
+
+  result = bignum_arith(op, a, b ? b : arg->as.big);
+  CLEANUP_WITH_ERR_IF(!result, fail_cleanup, ERR_OUT_OF_MEMORY);
+  bignum_free(a);
+  bignum_free(b);
+
+  if (bignum_to_int(result, fix)) {
+    bignum_free(result);
+    result = NULL;
+  }
+  *big = result;
+  return ERR_NO_ERROR;
+
+fail_cleanup:
+  bignum_free(b);
+  if (a != *big)
+    bignum_free(a);
+  return retval;
+}
+
+/**
+ * @brief Makes a TEMPORARY node for an integer accumulator, a BIGNUM node
+ * taking over `big` if it is not NULL and a NUMBER node otherwise
+ *
+ * @param fix fixnum accumulator
+ * @param big bignum accumulator or NULL, freed on failure
+ * @param out_node out param, the new node
+ * @return err_t
+ */
+err_t get_integer_node(int64_t fix, bignum *big, astnode **out_node) {
+  if (big) {
+    *out_node = get_bignum_node(big);
+    if (!*out_node)
+      bignum_free(big);
+  } else {
+    *out_node = get_number_node(fix);
+  }
+  RETURN_ERR_IF(!*out_node, ERR_OUT_OF_MEMORY);
+  (*out_node)->origin = TEMPORARY;
+  return ERR_NO_ERROR;
+}
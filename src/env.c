@@ -2,6 +2,7 @@
 #include "ast.h"
 #include "err.h"
 #include "macros.h"
+#include "memstats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -57,6 +58,9 @@ err_t add_empty_var(const char *var_name, env *env) {
   env->vars[env->var_count].symbol = sym;
   env->vars[env->var_count].node = dummy_node;
   env->var_count++;
+  /* the first record was allocated with the environment */
+  mem_charge(MEM_ENV, len + 1 +
+                          (env->var_count > 1 ? sizeof(struct var_record) : 0));
 
   return ERR_NO_ERROR;
 fail_cleanup:
@@ -94,6 +98,7 @@ env *create_env() {
     free(e);
     return NULL;
   };
+  mem_charge(MEM_ENV, sizeof(struct Env) + sizeof(struct var_record));
   return e;
 }
 
@@ -107,8 +112,12 @@ void free_env(env *env) {
     return;
   for (int i = 0; i < env->var_count; i++) {
     free_node(env->vars[i].node);
+    mem_discharge(MEM_ENV, strlen(env->vars[i].symbol) + 1);
     free(env->vars[i].symbol);
   }
+  mem_discharge(MEM_ENV, sizeof(struct Env) +
+                             (env->var_count > 1 ? env->var_count : 1) *
+                                 sizeof(struct var_record));
   free(env->vars);
   free(env);
 }
@@ -0,0 +1,759 @@
+#include "hash.h"
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include "macros.h"
+#include "memstats.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* control bytes, full slots hold the low 7 bits of the hash instead */
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xfe
+
+/* the table grows once it is 7/8 full, counting deleted slots */
+#define MAX_LOAD_NUM 7
+#define MAX_LOAD_DEN 8
+
+/* largest capacity, doubling it would overflow an int */
+#define MAX_CAPACITY (1 << 30)
+/* most entries a table of MAX_CAPACITY holds below the maximal load */
+#define MAX_ENTRIES ((size_t)MAX_CAPACITY * MAX_LOAD_NUM / MAX_LOAD_DEN - 1)
+
+/**
+ * @brief Finalizer of MurmurHash3, spreads the bits of the input over the
+ * whole word
+ *
+ * @param x value to mix
+ * @return uint64_t
+ */
+static uint64_t mix64(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+/**
+ * @brief Hashes a key given by its type and value
+ *
+ * @param type NUMBER, SYMBOL or BOOLEAN
+ * @param value of a number or boolean key
+ * @param symbol of a symbol key
+ * @return uint64_t
+ */
+static uint64_t hash_key(enum node_type type, int64_t value,
+                         const char *symbol) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  if (type != SYMBOL)
+    return mix64(((uint64_t)type << 56) ^ (uint64_t)value);
+  /* FNV-1a */
+  for (const unsigned char *c = (const unsigned char *)symbol; *c; c++) {
+    h ^= *c;
+    h *= 0x100000001b3ULL;
+  }
+  return mix64(h);
+}
+
+/**
+ * @brief Hashes a key node
+ *
+ * @param key a valid key node
+ * @return uint64_t
+ */
+uint64_t hash_node(const astnode *key) {
+  return key->type == SYMBOL ? hash_key(SYMBOL, 0, key->as.symbol)
+                             : hash_key(key->type, key->as.value, NULL);
+}
+
+/**
+ * @brief Hashes the key of a full slot
+ *
+ * @param slot table entry
+ * @return uint64_t
+ */
+static uint64_t hash_slot_key(const struct hash_slot *slot) {
+  return slot->key_type == SYMBOL
+             ? hash_key(SYMBOL, 0, slot->key.symbol)
+             : hash_key(slot->key_type, slot->key.value, NULL);
+}
+
+/**
+ * @brief Compares the key of a full slot with a key node
+ *
+ * @param slot table entry
+ * @param key a valid key node
+ * @return int 1 if equal, 0 otherwise
+ */
+static int slot_has_key(const struct hash_slot *slot, const astnode *key) {
+  RETURN_VAL_IF(slot->key_type != key->type, 0);
+  if (key->type == SYMBOL)
+    return !strcmp(slot->key.symbol, key->as.symbol);
+  return slot->key.value == key->as.value;
+}
+
+/**
+ * @brief Returns a bit mask of the slots in the group whose control byte
+ * equals the given byte, bit i stands for slot i of the group
+ *
+ * @param group first control byte of the group
+ * @param byte to look for
+ * @return unsigned
+ */
+static unsigned group_match(const uint8_t *group, uint8_t byte) {
+#if defined(__SSE2__)
+  __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+  return (unsigned)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)byte)));
+#else
+  unsigned mask = 0;
+  for (int i = 0; i < HASH_GROUP_WIDTH; i++)
+    mask |= (unsigned)(group[i] == byte) << i;
+  return mask;
+#endif
+}
+
+/**
+ * @brief Returns a bit mask of the EMPTY or DELETED slots in the group, these
+ * are the only control bytes with the high bit set
+ *
+ * @param group first control byte of the group
+ * @return unsigned
+ */
+static unsigned group_match_free(const uint8_t *group) {
+#if defined(__SSE2__)
+  return (unsigned)_mm_movemask_epi8(
+      _mm_loadu_si128((const __m128i *)group));
+#else
+  unsigned mask = 0;
+  for (int i = 0; i < HASH_GROUP_WIDTH; i++)
+    mask |= (unsigned)(group[i] >> 7) << i;
+  return mask;
+#endif
+}
+
+/**
+ * @brief Index of the lowest set bit of a nonzero mask
+ *
+ * @param mask nonzero bit mask
+ * @return int
+ */
+static int lowest_bit(unsigned mask) { return __builtin_ctz(mask); }
+
+/**
+ * @brief Finds the slot index of the key
+ *
+ * @param table to search
+ * @param key a valid key node
+ * @param hash of the key
+ * @return int index of the slot or -1 if the key is missing
+ */
+static int find_slot(const hashtable *table, const astnode *key,
+                     uint64_t hash) {
+  int group_mask = table->capacity / HASH_GROUP_WIDTH - 1;
+  int group = (int)(hash >> 7) & group_mask;
+  uint8_t h2 = hash & 0x7f;
+  unsigned match;
+
+  /* triangular probing over groups visits all of them */
+  for (int step = 1;; step++) {
+    const uint8_t *ctrl = table->ctrl + group * HASH_GROUP_WIDTH;
+    for (match = group_match(ctrl, h2); match; match &= match - 1) {
+      int i = group * HASH_GROUP_WIDTH + lowest_bit(match);
+      if (slot_has_key(&table->slots[i], key))
+        return i;
+    }
+    /* an empty slot ends every probe sequence that passes it */
+    if (group_match(ctrl, CTRL_EMPTY))
+      return -1;
+    RETURN_VAL_IF(step > group_mask, -1);
+    group = (group + step) & group_mask;
+  }
+}
+
+/**
+ * @brief Finds the first free slot on the probe sequence of the hash
+ *
+ * @param table to search, has at least one free slot
+ * @param hash of the key
+ * @return int index of the slot
+ */
+static int find_free_slot(const hashtable *table, uint64_t hash) {
+  int group_mask = table->capacity / HASH_GROUP_WIDTH - 1;
+  int group = (int)(hash >> 7) & group_mask;
+  unsigned match;
+
+  for (int step = 1;; step++) {
+    match = group_match_free(table->ctrl + group * HASH_GROUP_WIDTH);
+    if (match)
+      return group * HASH_GROUP_WIDTH + lowest_bit(match);
+    group = (group + step) & group_mask;
+  }
+}
+
+/**
+ * @brief Bytes of the control bytes and slots of the given capacity
+ *
+ * @param capacity of the table
+ * @return size_t
+ */
+static size_t slots_bytes(int capacity) {
+  return (size_t)capacity * (1 + sizeof(struct hash_slot));
+}
+
+/**
+ * @brief Allocates the arrays of a table with the given capacity, all slots
+ * are empty
+ *
+ * @param table to initialize
+ * @param capacity power of two multiple of HASH_GROUP_WIDTH
+ * @return err_t
+ */
+static err_t alloc_slots(hashtable *table, int capacity) {
+  err_t retval = ERR_NO_ERROR;
+
+  table->ctrl = malloc(capacity);
+  table->slots = malloc(capacity * sizeof(struct hash_slot));
+  CLEANUP_WITH_ERR_IF(!table->ctrl || !table->slots, fail_cleanup,
+                      ERR_OUT_OF_MEMORY);
+  memset(table->ctrl, CTRL_EMPTY, capacity);
+  mem_charge(MEM_NODES, slots_bytes(capacity));
+  table->capacity = capacity;
+  table->count = 0;
+  table->deleted = 0;
+  return retval;
+fail_cleanup:
+  free(table->ctrl);
+  free(table->slots);
+  return retval;
+}
+
+/**
+ * @brief Returns the smallest capacity that holds the count of entries below
+ * the maximal load, at most MAX_CAPACITY
+ *
+ * @param count of entries
+ * @return int
+ */
+static int capacity_for(int count) {
+  size_t capacity = HASH_GROUP_WIDTH;
+  while (capacity < MAX_CAPACITY &&
+         capacity * MAX_LOAD_NUM / MAX_LOAD_DEN < (size_t)count + 1)
+    capacity *= 2;
+  return (int)capacity;
+}
+
+/**
+ * @brief Moves all entries into new arrays of the given capacity, dropping
+ * the deleted slots
+ *
+ * @param table to rehash
+ * @param capacity power of two multiple of HASH_GROUP_WIDTH
+ * @return err_t
+ */
+static err_t rehash(hashtable *table, int capacity) {
+  hashtable old = *table;
+  err_t err = alloc_slots(table, capacity);
+  if (err) {
+    *table = old;
+    return err;
+  }
+
+  for (int i = 0; i < old.capacity; i++) {
+    if (old.ctrl[i] & 0x80)
+      continue;
+    uint64_t hash = hash_slot_key(&old.slots[i]);
+    int slot = find_free_slot(table, hash);
+    table->ctrl[slot] = hash & 0x7f;
+    table->slots[slot] = old.slots[i];
+  }
+  table->count = old.count;
+
+  mem_discharge(MEM_NODES, slots_bytes(old.capacity));
+  free(old.ctrl);
+  free(old.slots);
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Checks whether the node can be used as a hash table key, keys are
+ * numbers, symbols and booleans
+ *
+ * @param key node to check
+ * @return int 1 if the node is a valid key, 0 otherwise
+ */
+int is_hash_key(const astnode *key) {
+  RETURN_VAL_IF(!key, 0);
+  return key->type == NUMBER || key->type == SYMBOL || key->type == BOOLEAN;
+}
+
+/**
+ * @brief Allocates an empty hash table
+ *
+ * @param expected count of entries to make room for
+ * @return hashtable* or NULL if memory could not be allocated
+ */
+hashtable *hash_table_new(int expected) {
+  hashtable *table = calloc(1, sizeof(hashtable));
+  RETURN_NULL_IF(!table);
+  if (alloc_slots(table, capacity_for(expected < 0 ? 0 : expected))) {
+    free(table);
+    return NULL;
+  }
+  mem_charge(MEM_NODES, sizeof(hashtable));
+  return table;
+}
+
+/**
+ * @brief Frees the hash table with all its keys and values
+ *
+ * @param table to free, may be NULL
+ */
+void hash_table_free(hashtable *table) {
+  if (!table)
+    return;
+  for (int i = 0; i < table->capacity; i++) {
+    if (table->ctrl[i] & 0x80)
+      continue;
+    if (table->slots[i].key_type == SYMBOL) {
+      mem_discharge(MEM_NODES, strlen(table->slots[i].key.symbol) + 1);
+      free(table->slots[i].key.symbol);
+    }
+    free_node(table->slots[i].value);
+  }
+  mem_discharge(MEM_NODES, sizeof(hashtable) + slots_bytes(table->capacity));
+  free(table->ctrl);
+  free(table->slots);
+  free(table);
+}
+
+/**
+ * @brief Bytes allocated for the table, its slots and symbol keys, not the
+ * values
+ *
+ * @param table to measure
+ * @return size_t
+ */
+size_t hash_table_bytes(const hashtable *table) {
+  size_t bytes = sizeof(hashtable) + slots_bytes(table->capacity);
+  for (int i = 0; i < table->capacity; i++) {
+    if (!(table->ctrl[i] & 0x80) && table->slots[i].key_type == SYMBOL)
+      bytes += strlen(table->slots[i].key.symbol) + 1;
+  }
+  return bytes;
+}
+
+/**
+ * @brief Makes a deep copy of the hash table, values are copied with the
+ * given origin
+ *
+ * @param table to copy
+ * @param out_table out param, the new table
+ * @param origin of the copied values
+ * @return err_t
+ */
+err_t hash_table_copy(const hashtable *table, hashtable **out_table,
+                      enum node_origin origin) {
+  /* sanity check */
+  RETURN_ERR_IF(!table || !out_table, ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  hashtable *copy = calloc(1, sizeof(hashtable));
+  RETURN_ERR_IF(!copy, ERR_OUT_OF_MEMORY);
+  err = alloc_slots(copy, table->capacity);
+  if (err) {
+    free(copy);
+    return err;
+  }
+  mem_charge(MEM_NODES, sizeof(hashtable));
+
+  /* the same capacity keeps every entry in its slot */
+  for (int i = 0; i < table->capacity; i++) {
+    if (table->ctrl[i] & 0x80)
+      continue;
+    struct hash_slot *slot = &copy->slots[i];
+    slot->key_type = table->slots[i].key_type;
+    slot->key = table->slots[i].key;
+    if (slot->key_type == SYMBOL) {
+      slot->key.symbol = malloc(strlen(table->slots[i].key.symbol) + 1);
+      CLEANUP_WITH_ERR_IF(!slot->key.symbol, fail_cleanup, ERR_OUT_OF_MEMORY);
+      strcpy(slot->key.symbol, table->slots[i].key.symbol);
+      mem_charge(MEM_NODES, strlen(slot->key.symbol) + 1);
+    }
+    /* the slot is full from now on, so the table frees its key on failure */
+    slot->value = NULL;
+    copy->ctrl[i] = table->ctrl[i];
+    copy->count++;
+    err = make_deep_copy(table->slots[i].value, &slot->value, origin);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+  }
+  /* deleted slots keep the probe sequences passing them intact */
+  for (int i = 0; i < table->capacity; i++) {
+    if (table->ctrl[i] == CTRL_DELETED)
+      copy->ctrl[i] = CTRL_DELETED;
+  }
+  copy->deleted = table->deleted;
+  *out_table = copy;
+  return retval;
+fail_cleanup:
+  hash_table_free(copy);
+  return retval;
+}
+
+/**
+ * @brief Looks up the value stored under the key
+ *
+ * @param table to search
+ * @param key a valid key node
+ * @return astnode* the stored value or NULL if the key is missing
+ */
+astnode *hash_table_get(const hashtable *table, const astnode *key) {
+  RETURN_NULL_IF(!table || !is_hash_key(key));
+  int i = find_slot(table, key, hash_node(key));
+  return i < 0 ? NULL : table->slots[i].value;
+}
+
+/**
+ * @brief Stores the value under the key, replacing and freeing the previous
+ * value. The table takes ownership of the value node.
+ *
+ * @param table to insert into
+ * @param key a valid key node, it is copied
+ * @param value node to store
+ * @return err_t
+ */
+err_t hash_table_put(hashtable *table, const astnode *key, astnode *value) {
+  /* sanity check */
+  RETURN_ERR_IF(!table || !is_hash_key(key) || !value, ERR_INTERNAL);
+
+  err_t err;
+  uint64_t hash = hash_node(key);
+  int i = find_slot(table, key, hash);
+
+  if (i >= 0) {
+    free_node(table->slots[i].value);
+    table->slots[i].value = value;
+    return ERR_NO_ERROR;
+  }
+
+  if ((long)(table->count + table->deleted + 1) * MAX_LOAD_DEN >
+      (long)table->capacity * MAX_LOAD_NUM) {
+    RETURN_ERR_IF((size_t)table->count >= MAX_ENTRIES, ERR_OUT_OF_MEMORY);
+    /* plenty of deleted slots are reclaimed without growing */
+    err = rehash(table, capacity_for(table->count + 1) > table->capacity / 2 &&
+                                table->capacity < MAX_CAPACITY
+                            ? table->capacity * 2
+                            : table->capacity);
+    RETURN_ERR_IF(err, err);
+  }
+
+  i = find_free_slot(table, hash);
+  struct hash_slot *slot = &table->slots[i];
+  slot->key_type = key->type;
+  if (key->type == SYMBOL) {
+    slot->key.symbol = malloc(strlen(key->as.symbol) + 1);
+    RETURN_ERR_IF(!slot->key.symbol, ERR_OUT_OF_MEMORY);
+    strcpy(slot->key.symbol, key->as.symbol);
+    mem_charge(MEM_NODES, strlen(slot->key.symbol) + 1);
+  } else {
+    slot->key.value = key->as.value;
+  }
+  slot->value = value;
+
+  if (table->ctrl[i] == CTRL_DELETED)
+    table->deleted--;
+  table->ctrl[i] = hash & 0x7f;
+  table->count++;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Removes the key and frees its value
+ *
+ * @param table to remove from
+ * @param key a valid key node
+ * @return int 1 if the key was present, 0 otherwise
+ */
+int hash_table_remove(hashtable *table, const astnode *key) {
+  RETURN_VAL_IF(!table || !is_hash_key(key), 0);
+  int i = find_slot(table, key, hash_node(key));
+  RETURN_VAL_IF(i < 0, 0);
+
+  if (table->slots[i].key_type == SYMBOL) {
+    mem_discharge(MEM_NODES, strlen(table->slots[i].key.symbol) + 1);
+    free(table->slots[i].key.symbol);
+  }
+  free_node(table->slots[i].value);
+  table->slots[i].value = NULL;
+
+  /* a group that still has an empty slot never made a probe continue past
+   * it, so the slot can become empty again instead of a tombstone */
+  if (group_match(table->ctrl + i / HASH_GROUP_WIDTH * HASH_GROUP_WIDTH,
+                  CTRL_EMPTY)) {
+    table->ctrl[i] = CTRL_EMPTY;
+  } else {
+    table->ctrl[i] = CTRL_DELETED;
+    table->deleted++;
+  }
+  table->count--;
+  return 1;
+}
+
+/**
+ * @brief Iterates over the entries of the table. Start with *pos = 0.
+ *
+ * @param table to iterate
+ * @param pos iteration state, index of the next slot
+ * @return struct hash_slot* the next entry or NULL at the end
+ */
+struct hash_slot *hash_table_next(const hashtable *table, int *pos) {
+  RETURN_NULL_IF(!table || !pos);
+  while (*pos < table->capacity) {
+    int i = (*pos)++;
+    if (!(table->ctrl[i] & 0x80))
+      return &table->slots[i];
+  }
+  return NULL;
+}
+
+/**
+ * @brief Creates a new hash table, (make-hash [expected-count]). Counts more
+ * than a table of 2^30 slots holds are out of memory.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result HASH node with TEMPORARY
+ * origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_make_hash(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count > 2, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int expected = 0;
+  astnode *temp = NULL;
+
+  if (list_node->as.list.count == 2) {
+    err = eval_node(list_node->as.list.children[1], &temp, env);
+    RETURN_ERR_IF(err, err);
+    CLEANUP_WITH_ERR_IF(temp->type != NUMBER || temp->as.value < 0,
+                        cleanup, ERR_SYNTAX_ERROR);
+    /* larger tables would overflow the int capacity */
+    CLEANUP_WITH_ERR_IF((uint64_t)temp->as.value > MAX_ENTRIES, cleanup,
+                        ERR_OUT_OF_MEMORY);
+    expected = (int)temp->as.value;
+  }
+
+  *result_node = get_hash_node(expected);
+  CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
+  (*result_node)->origin = TEMPORARY;
+
+cleanup:
+  free_temp_node_parts(temp);
+  return retval;
+}
+
+/**
+ * @brief Evaluates a key argument
+ *
+ * @param node to evaluate
+ * @param key out param, the key node
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t eval_key(astnode *node, astnode **key, env *env) {
+  err_t err, retval = ERR_NO_ERROR;
+
+  err = eval_node(node, key, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(!is_hash_key(*key), fail_cleanup, ERR_SYNTAX_ERROR);
+  return retval;
+fail_cleanup:
+  free_temp_node_parts(*key);
+  *key = NULL;
+  return retval;
+}
+
+/**
+ * @brief Returns the value stored under the key, (gethash key table
+ * [default]). Returns the default or NIL when the key is missing.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the stored node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_gethash(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 3 || list_node->as.list.count > 4,
+                ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *key = NULL, *table = NULL, *value;
+
+  err = eval_key(list_node->as.list.children[1], &key, env);
+  RETURN_ERR_IF(err, err);
+  err = eval_node(list_node->as.list.children[2], &table, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  CLEANUP_WITH_ERR_IF(table->type != HASH, cleanup, ERR_SYNTAX_ERROR);
+
+  value = hash_table_get(table->as.hash, key);
+  if (!value) {
+    if (list_node->as.list.count == 4) {
+      err = eval_node(list_node->as.list.children[3], result_node, env);
+      CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    } else {
+      *result_node = get_bool_node(0);
+      CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
+      (*result_node)->origin = TEMPORARY;
+    }
+  } else if (table->origin == TEMPORARY) {
+    /* the value goes away with the table */
+    err = make_deep_copy(value, result_node, TEMPORARY);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  } else {
+    *result_node = value;
+  }
+
+cleanup:
+  free_temp_node_parts(key);
+  free_temp_node_parts(table);
+  return retval;
+}
+
+/**
+ * @brief Evaluates the key, value and table arguments and stores a copy of
+ * the value in the table
+ *
+ * @param key_node key argument
+ * @param value_node value argument
+ * @param table_node table argument, has to evaluate to a variable
+ * @param result_node out param pointer to the stored node
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t store_entry(astnode *key_node, astnode *value_node,
+                         astnode *table_node, astnode **result_node,
+                         env *env) {
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *key = NULL, *value = NULL, *table = NULL, *copy = NULL;
+
+  err = eval_key(key_node, &key, env);
+  RETURN_ERR_IF(err, err);
+  err = eval_node(value_node, &value, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  CLEANUP_WITH_ERR_IF(value->type == SYMBOL, cleanup, ERR_SYNTAX_ERROR);
+  err = eval_node(table_node, &table, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  CLEANUP_WITH_ERR_IF(table->type != HASH, cleanup, ERR_SYNTAX_ERROR);
+  CLEANUP_WITH_ERR_IF(table->origin != VARIABLE, cleanup, ERR_NOT_A_VARIABLE);
+
+  /* make node copy with VARIABLE origin */
+  err = make_deep_copy(value, &copy, VARIABLE);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  err = hash_table_put(table->as.hash, key, copy);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  *result_node = copy;
+  copy = NULL;
+
+cleanup:
+  free_node(copy);
+  free_temp_node_parts(key);
+  free_temp_node_parts(value);
+  free_temp_node_parts(table);
+  return retval;
+}
+
+/**
+ * @brief Stores a value under the key, (puthash key value table).
+ * The table must be a variable.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the stored node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_puthash(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 4, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  return store_entry(list_node->as.list.children[1],
+                     list_node->as.list.children[2],
+                     list_node->as.list.children[3], result_node, env);
+}
+
+/**
+ * @brief Assigns to a hash table entry, (set (gethash key table) value).
+ * Called by SET, as missing keys have no node that could be replaced.
+ * @param list_node List node of the SET operator
+ * @param result_node out param pointer to the stored node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_set_gethash(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 3, ERR_SYNTAX_ERROR);
+
+  astnode *place = list_node->as.list.children[1];
+  RETURN_ERR_IF(place->type != LIST || place->as.list.count != 3,
+                ERR_SYNTAX_ERROR);
+
+  return store_entry(place->as.list.children[1], list_node->as.list.children[2],
+                     place->as.list.children[2], result_node, env);
+}
+
+/**
+ * @brief Removes the key from a hash table variable, (remhash key table).
+ * Returns T if the key was present, NIL otherwise.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result BOOLEAN node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_remhash(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *key = NULL, *table = NULL;
+
+  err = eval_key(list_node->as.list.children[1], &key, env);
+  RETURN_ERR_IF(err, err);
+  err = eval_node(list_node->as.list.children[2], &table, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  CLEANUP_WITH_ERR_IF(table->type != HASH, cleanup, ERR_SYNTAX_ERROR);
+  CLEANUP_WITH_ERR_IF(table->origin != VARIABLE, cleanup, ERR_NOT_A_VARIABLE);
+
+  *result_node = get_bool_node(hash_table_remove(table->as.hash, key));
+  CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
+  (*result_node)->origin = TEMPORARY;
+
+cleanup:
+  free_temp_node_parts(key);
+  free_temp_node_parts(table);
+  return retval;
+}
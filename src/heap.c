@@ -0,0 +1,652 @@
+#include "heap.h"
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include "macros.h"
+#include "memstats.h"
+#include "range.h"
+#include "sort.h"
+#include "vector.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Checks whether a belongs above b in the heap
+ *
+ * @param a first node
+ * @param b second node
+ * @param descending the largest item is on top if nonzero
+ * @return int 1 if a goes first, 0 otherwise
+ */
+static int precedes(const astnode *a, const astnode *b, int descending) {
+  int cmp = compare_nodes(a, b);
+  return descending ? cmp > 0 : cmp < 0;
+}
+
+/**
+ * @brief Moves the item at i up until its parent precedes it
+ *
+ * @param items heap array
+ * @param i index of the item
+ * @param descending order of the heap
+ */
+static void sift_up(astnode **items, int i, int descending) {
+  astnode *item = items[i];
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (!precedes(item, items[parent], descending))
+      break;
+    items[i] = items[parent];
+    i = parent;
+  }
+  items[i] = item;
+}
+
+/**
+ * @brief Moves the item at i down until it precedes both its children
+ *
+ * @param items heap array
+ * @param count count of items in the heap
+ * @param i index of the item
+ * @param descending order of the heap
+ */
+static void sift_down(astnode **items, int count, int i, int descending) {
+  astnode *item = items[i];
+  for (;;) {
+    int child = 2 * i + 1;
+    if (child >= count)
+      break;
+    if (child + 1 < count &&
+        precedes(items[child + 1], items[child], descending))
+      child++;
+    if (!precedes(items[child], item, descending))
+      break;
+    items[i] = items[child];
+    i = child;
+  }
+  items[i] = item;
+}
+
+/**
+ * @brief Makes sure the heap has room for `needed` items, growing the array
+ * geometrically
+ *
+ * @param heap HEAP type node
+ * @param needed count of items the heap should hold
+ * @return err_t
+ */
+static err_t heap_reserve(astnode *heap, int needed) {
+  RETURN_VAL_IF(needed <= heap->as.heap.capacity, ERR_NO_ERROR);
+
+  int capacity = heap->as.heap.capacity;
+  while (capacity < needed)
+    capacity = capacity > INT_MAX / 2 ? needed : capacity * 2;
+  astnode **items = realloc(heap->as.heap.items, capacity * sizeof(astnode *));
+  RETURN_ERR_IF(!items, ERR_OUT_OF_MEMORY);
+  mem_charge(MEM_NODES,
+             (capacity - heap->as.heap.capacity) * sizeof(astnode *));
+  heap->as.heap.items = items;
+  heap->as.heap.capacity = capacity;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Adds an item to a HEAP node, O(log n). The heap takes over the item,
+ * which must have VARIABLE origin.
+ *
+ * @param heap HEAP type node
+ * @param item node to add
+ * @return err_t
+ */
+err_t heap_push(astnode *heap, astnode *item) {
+  /* sanity check */
+  RETURN_ERR_IF(!heap || heap->type != HEAP || !item, ERR_INTERNAL);
+
+  err_t err = heap_reserve(heap, heap->as.heap.count + 1);
+  RETURN_ERR_IF(err, err);
+  heap->as.heap.items[heap->as.heap.count] = item;
+  sift_up(heap->as.heap.items, heap->as.heap.count++,
+          heap->as.heap.descending);
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Removes the top item of a nonempty HEAP node, O(log n). The caller
+ * takes over the returned VARIABLE node.
+ *
+ * @param heap HEAP type node
+ * @return astnode* the former top item
+ */
+astnode *heap_pop(astnode *heap) {
+  astnode **items = heap->as.heap.items;
+  astnode *top = items[0];
+
+  items[0] = items[--heap->as.heap.count];
+  if (heap->as.heap.count)
+    sift_down(items, heap->as.heap.count, 0, heap->as.heap.descending);
+  return top;
+}
+
+/**
+ * @brief Returns the i-th item of a LIST, VECTOR or RANGE node, elements of
+ * vectors and ranges are built in the scratch node
+ *
+ * @param seq LIST, VECTOR or RANGE type node
+ * @param i index of the item
+ * @param scratch node to hold a number
+ * @return const astnode*
+ */
+static const astnode *seq_item(const astnode *seq, int i, astnode *scratch) {
+  switch (seq->type) {
+  case VECTOR:
+    if (seq->as.vector.kind == VEC_F64) {
+      scratch->type = FLOAT;
+      scratch->as.real = vector_get_real(seq, i);
+    } else {
+      scratch->type = NUMBER;
+      scratch->as.value = vector_get(seq, i);
+    }
+    return scratch;
+  case RANGE:
+    scratch->type = NUMBER;
+    scratch->as.value = range_get(seq, i);
+    return scratch;
+  default:
+    return seq->as.list.children[i];
+  }
+}
+
+/**
+ * @brief Returns the count of items of a LIST, VECTOR or RANGE node
+ *
+ * @param seq LIST, VECTOR or RANGE type node
+ * @return int
+ */
+static int seq_count(const astnode *seq) {
+  switch (seq->type) {
+  case VECTOR:
+    return seq->as.vector.count;
+  case RANGE:
+    return seq->as.range.count;
+  default:
+    return seq->as.list.count;
+  }
+}
+
+/**
+ * @brief Makes a VARIABLE copy of the i-th item of a sequence
+ *
+ * @param seq LIST, VECTOR or RANGE type node
+ * @param i index of the item
+ * @param out_node out param, the copy
+ * @return err_t
+ */
+static err_t copy_item(const astnode *seq, int i, astnode **out_node) {
+  astnode scratch = {0};
+  const astnode *item = seq_item(seq, i, &scratch);
+
+  RETURN_ERR_IF(item->type == SYMBOL, ERR_SYNTAX_ERROR);
+  return make_deep_copy((astnode *)item, out_node, VARIABLE);
+}
+
+/**
+ * @brief Creates a new heap, (make-heap [descending [sequence]]). The
+ * smallest item is on top unless descending is T. Items of the list, vector
+ * or range are added in linear time.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result HEAP node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_make_heap(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count > 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int descending = 0, count = 0;
+  astnode *temp = NULL, *seq = NULL, *heap = NULL;
+
+  if (list_node->as.list.count >= 2) {
+    err = eval_node(list_node->as.list.children[1], &temp, env);
+    RETURN_ERR_IF(err, err);
+    CLEANUP_WITH_ERR_IF(temp->type != BOOLEAN, cleanup, ERR_SYNTAX_ERROR);
+    descending = temp->as.value;
+  }
+  if (list_node->as.list.count == 3) {
+    err = eval_node(list_node->as.list.children[2], &seq, env);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    CLEANUP_WITH_ERR_IF(seq->type != LIST && seq->type != VECTOR &&
+                            seq->type != RANGE,
+                        cleanup, ERR_SYNTAX_ERROR);
+    count = seq_count(seq);
+  }
+
+  heap = get_heap_node(descending, count);
+  CLEANUP_WITH_ERR_IF(!heap, cleanup, ERR_OUT_OF_MEMORY);
+  heap->origin = TEMPORARY;
+
+  /* copy the items in any order, then heapify bottom up in O(n) */
+  for (int i = 0; i < count; i++) {
+    err = copy_item(seq, i, &heap->as.heap.items[i]);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    heap->as.heap.count++;
+  }
+  for (int i = count / 2 - 1; i >= 0; i--)
+    sift_down(heap->as.heap.items, count, i, descending);
+
+  *result_node = heap;
+  heap = NULL;
+
+cleanup:
+  free_temp_node_parts(heap);
+  free_temp_node_parts(temp);
+  free_temp_node_parts(seq);
+  return retval;
+}
+
+/**
+ * @brief Evaluates the heap argument of an operator
+ *
+ * @param node to evaluate
+ * @param heap out param, the HEAP node
+ * @param variable the heap must be a variable if nonzero
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t eval_heap(astnode *node, astnode **heap, int variable,
+                       env *env) {
+  err_t err, retval = ERR_NO_ERROR;
+
+  err = eval_node(node, heap, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF((*heap)->type != HEAP, fail_cleanup, ERR_SYNTAX_ERROR);
+  CLEANUP_WITH_ERR_IF(variable && (*heap)->origin != VARIABLE, fail_cleanup,
+                      ERR_NOT_A_VARIABLE);
+  return retval;
+fail_cleanup:
+  free_temp_node_parts(*heap);
+  *heap = NULL;
+  return retval;
+}
+
+/**
+ * @brief Adds the evaluated arguments to a heap held by a variable,
+ * (heap-push heap item...). Returns the variable.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the variable HEAP node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_heap_push(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *heap = NULL, *value_node = NULL, *value_node_copy = NULL;
+
+  err = eval_heap(list_node->as.list.children[1], &heap, 1, env);
+  RETURN_ERR_IF(err, err);
+
+  for (int i = 2; i < list_node->as.list.count; i++) {
+    err = eval_node(list_node->as.list.children[i], &value_node, env);
+    RETURN_ERR_IF(err, err);
+    CLEANUP_WITH_ERR_IF(value_node->type == SYMBOL, cleanup, ERR_SYNTAX_ERROR);
+
+    /* make node copy with VARIABLE origin */
+    err = make_deep_copy(value_node, &value_node_copy, VARIABLE);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    err = heap_push(heap, value_node_copy);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    value_node_copy = NULL;
+
+    free_temp_node_parts(value_node);
+    value_node = NULL;
+  }
+  *result_node = heap;
+
+cleanup:
+  free_node(value_node_copy);
+  free_temp_node_parts(value_node);
+  return retval;
+}
+
+/**
+ * @brief Removes and returns the top item of a heap, (heap-pop heap).
+ * Returns NIL when the heap is empty.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the removed TEMPORARY node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_heap_pop(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 2, ERR_SYNTAX_ERROR);
+  RETURN_ERR_IF(!list_node->as.list.children[1], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *heap = NULL, *top;
+
+  err = eval_heap(list_node->as.list.children[1], &heap, 0, env);
+  RETURN_ERR_IF(err, err);
+
+  if (!heap->as.heap.count) {
+    *result_node = get_bool_node(0);
+    CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
+    (*result_node)->origin = TEMPORARY;
+    goto cleanup;
+  }
+
+  /* atoms are handed over as they are, the children of a list have to be
+   * temporary too for the caller to free them */
+  top = heap_pop(heap);
+  if (top->type != LIST) {
+    top->origin = TEMPORARY;
+    *result_node = top;
+  } else {
+    err = make_deep_copy(top, result_node, TEMPORARY);
+    free_node(top);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  }
+
+cleanup:
+  free_temp_node_parts(heap);
+  return retval;
+}
+
+/**
+ * @brief Returns the top item of a heap without removing it, (heap-peek
+ * heap). Returns NIL when the heap is empty.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the top node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_heap_peek(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 2, ERR_SYNTAX_ERROR);
+  RETURN_ERR_IF(!list_node->as.list.children[1], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *heap = NULL;
+
+  err = eval_heap(list_node->as.list.children[1], &heap, 0, env);
+  RETURN_ERR_IF(err, err);
+
+  if (!heap->as.heap.count) {
+    *result_node = get_bool_node(0);
+    CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
+    (*result_node)->origin = TEMPORARY;
+  } else if (heap->origin == TEMPORARY) {
+    /* the item goes away with the heap */
+    err = make_deep_copy(heap->as.heap.items[0], result_node, TEMPORARY);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  } else {
+    *result_node = heap->as.heap.items[0];
+  }
+
+cleanup:
+  free_temp_node_parts(heap);
+  return retval;
+}
+
+/**
+ * @brief Returns the count of items in a heap, (heap-size heap).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result NUMBER node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_heap_size(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 2, ERR_SYNTAX_ERROR);
+  RETURN_ERR_IF(!list_node->as.list.children[1], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *heap = NULL;
+
+  err = eval_heap(list_node->as.list.children[1], &heap, 0, env);
+  RETURN_ERR_IF(err, err);
+
+  *result_node = get_number_node(heap->as.heap.count);
+  CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
+  (*result_node)->origin = TEMPORARY;
+
+cleanup:
+  free_temp_node_parts(heap);
+  return retval;
+}
+
+/**
+ * @brief Moves the index at i down a min-heap of sequence indexes, ordered
+ * by the items they point to
+ *
+ * @param best heap array of indexes
+ * @param count count of indexes in the heap
+ * @param i position to sift down
+ * @param seq LIST, VECTOR or RANGE node the indexes point into
+ */
+static void sift_down_index(int *best, int count, int i, const astnode *seq) {
+  astnode scratch_a = {0}, scratch_b = {0};
+  int index = best[i];
+  for (;;) {
+    int child = 2 * i + 1;
+    if (child >= count)
+      break;
+    if (child + 1 < count &&
+        compare_nodes(seq_item(seq, best[child + 1], &scratch_a),
+                      seq_item(seq, best[child], &scratch_b)) < 0)
+      child++;
+    if (compare_nodes(seq_item(seq, best[child], &scratch_a),
+                      seq_item(seq, index, &scratch_b)) >= 0)
+      break;
+    best[i] = best[child];
+    i = child;
+  }
+  best[i] = index;
+}
+
+/**
+ * @brief Finds the indexes of the k largest items of a sequence, from the
+ * largest down. A min-heap of the k largest items so far is kept, its top is
+ * the item to beat.
+ *
+ * @param seq LIST or VECTOR type node
+ * @param k count of items to select, at most the count of the sequence
+ * @param best out param, array of k indexes
+ */
+static void select_top_k(const astnode *seq, int k, int *best) {
+  astnode scratch_a = {0}, scratch_b = {0};
+  int n = seq_count(seq);
+
+  for (int i = 0; i < k; i++)
+    best[i] = i;
+  for (int i = k / 2 - 1; i >= 0; i--)
+    sift_down_index(best, k, i, seq);
+  for (int i = k; k && i < n; i++) {
+    if (compare_nodes(seq_item(seq, i, &scratch_a),
+                      seq_item(seq, best[0], &scratch_b)) > 0) {
+      best[0] = i;
+      sift_down_index(best, k, 0, seq);
+    }
+  }
+
+  /* heap sort in place, moving the smallest to the back leaves the indexes
+   * from the largest item down */
+  for (int count = k; count > 1; count--) {
+    int index = best[0];
+    best[0] = best[count - 1];
+    best[count - 1] = index;
+    sift_down_index(best, count - 1, 0, seq);
+  }
+}
+
+/**
+ * @brief Moves the value at i down a min-heap of values, their indexes move
+ * along
+ *
+ * @param values heap array of values
+ * @param best indexes of the values
+ * @param count count of values in the heap
+ * @param i position to sift down
+ */
+static void sift_down_value(int64_t *values, int *best, int count, int i) {
+  int64_t value = values[i];
+  int index = best[i];
+  for (;;) {
+    int child = 2 * i + 1;
+    if (child >= count)
+      break;
+    if (child + 1 < count && values[child + 1] < values[child])
+      child++;
+    if (values[child] >= value)
+      break;
+    values[i] = values[child];
+    best[i] = best[child];
+    i = child;
+  }
+  values[i] = value;
+  best[i] = index;
+}
+
+/**
+ * @brief select_top_k for integer vectors, the heap holds the values
+ * themselves so most elements are rejected by a single comparison
+ *
+ * @param vec VECTOR type node of integers
+ * @param k count of items to select, at most the count of the vector
+ * @param best out param, array of k indexes
+ * @return err_t
+ */
+static err_t select_top_k_integer(const astnode *vec, int k, int *best) {
+  int n = vec->as.vector.count;
+  int64_t *values = malloc((k ? k : 1) * sizeof(int64_t));
+  RETURN_ERR_IF(!values, ERR_OUT_OF_MEMORY);
+
+  for (int i = 0; i < k; i++) {
+    values[i] = vector_get(vec, i);
+    best[i] = i;
+  }
+  for (int i = k / 2 - 1; i >= 0; i--)
+    sift_down_value(values, best, k, i);
+  for (int i = k; k && i < n; i++) {
+    int64_t value = vector_get(vec, i);
+    if (value > values[0]) {
+      values[0] = value;
+      best[0] = i;
+      sift_down_value(values, best, k, 0);
+    }
+  }
+
+  for (int count = k; count > 1; count--) {
+    int64_t value = values[0];
+    int index = best[0];
+    values[0] = values[count - 1];
+    best[0] = best[count - 1];
+    values[count - 1] = value;
+    best[count - 1] = index;
+    sift_down_value(values, best, count - 1, 0);
+  }
+  free(values);
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Returns the k largest items of a list, vector or range from the
+ * largest down, (top-k k sequence). Only a heap of the k best items seen so
+ * far is kept, so it runs in O(n log k). The list shares the items of a list
+ * argument.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result TEMPORARY LIST node,
+ * NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_top_k(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int k, n, *best = NULL;
+  astnode *temp = NULL, *seq = NULL, *result = NULL, *item;
+
+  err = eval_node(list_node->as.list.children[1], &temp, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(temp->type != NUMBER || temp->as.value < 0, cleanup,
+                      ERR_SYNTAX_ERROR);
+  err = eval_node(list_node->as.list.children[2], &seq, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  CLEANUP_WITH_ERR_IF(seq->type != LIST && seq->type != VECTOR &&
+                          seq->type != RANGE,
+                      cleanup, ERR_SYNTAX_ERROR);
+  n = seq_count(seq);
+  k = temp->as.value < n ? (int)temp->as.value : n;
+
+  best = malloc((k ? k : 1) * sizeof(int));
+  CLEANUP_WITH_ERR_IF(!best, cleanup, ERR_OUT_OF_MEMORY);
+  result = get_list_node();
+  CLEANUP_WITH_ERR_IF(!result, cleanup, ERR_OUT_OF_MEMORY);
+  result->origin = TEMPORARY;
+  err = reserve_children(result, k);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+  if (seq->type == RANGE) {
+    /* ranges are monotonic, the largest items are at one end */
+    for (int i = 0; i < k; i++)
+      best[i] = seq->as.range.step > 0 ? n - 1 - i : i;
+  } else if (seq->type == VECTOR && seq->as.vector.kind != VEC_F64) {
+    err = select_top_k_integer(seq, k, best);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  } else {
+    select_top_k(seq, k, best);
+  }
+
+  for (int i = 0; i < k; i++) {
+    int index = best[i];
+    if (seq->type == LIST) {
+      item = seq->as.list.children[index];
+      /* take the item over from a temporary list */
+      if (seq->origin == TEMPORARY && seq->as.list.base)
+        seq->as.list.children[index] = NULL;
+    } else {
+      item = seq->type == VECTOR ? vector_get_node(seq, index)
+                                 : get_number_node(range_get(seq, index));
+      CLEANUP_WITH_ERR_IF(!item, cleanup, ERR_OUT_OF_MEMORY);
+      item->origin = TEMPORARY;
+    }
+    result->as.list.children[i] = item;
+    result->as.list.count++;
+  }
+
+  *result_node = result;
+  result = NULL;
+
+cleanup:
+  free(best);
+  free_temp_node_parts(result);
+  free_temp_node_parts(temp);
+  free_temp_node_parts(seq);
+  return retval;
+}
@@ -1,6 +1,7 @@
 #include "lexer.h"
 #include "err.h"
 #include "macros.h"
+#include "memstats.h"
 #include "preproc.h"
 #include <ctype.h>
 #include <stdlib.h>
@@ -32,43 +33,86 @@ err_t add_token(char ***tokens, int *token_count, int token_len,
   return ERR_NO_ERROR;
 }
 
+/**
+ * @brief Sets the fields of a span
+ *
+ * @param span to set
+ * @param offset of the first byte
+ * @param length in bytes
+ * @param line of the first byte
+ */
+static void set_span(struct source_span *span, int offset, int length,
+                     int line) {
+  span->offset = offset;
+  span->length = length;
+  span->line = line;
+}
+
+/**
+ * @brief Bytes of the tokens, the token array and the span array
+ *
+ * @param tokens NULL-terminated array of the tokens
+ * @param token_count count of the tokens
+ * @return size_t
+ */
+static size_t tokens_bytes(char **tokens, int token_count) {
+  size_t bytes = (token_count + 1) * sizeof(char *) +
+                 (token_count ? token_count : 1) * sizeof(struct source_span);
+  for (int i = 0; i < token_count; i++)
+    bytes += strlen(tokens[i]) + 1;
+  return bytes;
+}
+
 /**
  * @brief Tokenize Lisp-like source code into strings.
  *
- * Splits on spaces (' ') and tabs and treats each of the characters `'`, `(`,
- * `)` as standalone one-character tokens. The input is not modified.
+ * Splits on spaces (' '), tabs and line feeds and treats each of the
+ * characters `'`, `(`, `)` as standalone one-character tokens. The input is
+ * not modified.
  *
  * On success, allocates a NULL-terminated array of N heap-allocated,
- * NULL-terminated token strings and stores it in *tokens.
+ * NULL-terminated token strings and stores it in *tokens, and an array of the
+ * N token spans in *spans.
  *
- * Its caller responsibility to free each token and the token array on success
+ * Its caller responsibility to free the tokens and spans on success with
+ * free_tokens
  *
  * @param source_code NUL-terminated input string.
  * @param tokens out param; must point to a char** initialized to NULL.
+ * @param spans out param; where every token is in the source.
  * @return number of tokens on success; negative err_t on failure.
  */
-int tokenize(const char *source_code, char ***tokens) {
+int tokenize(const char *source_code, char ***tokens,
+             struct source_span **spans) {
   int source_length, i, retval = ERR_NO_ERROR, token_count = 0, curr_len = 0,
-                        token_found = 0, err;
+                        token_found = 0, err, line = 1;
   char c, **tmp;
+  struct source_span *fitted;
 
   /* sanity check */
-  RETURN_ERR_IF(!source_code || !tokens || *tokens, -ERR_INTERNAL);
+  RETURN_ERR_IF(!source_code || !tokens || *tokens || !spans, -ERR_INTERNAL);
 
   source_length = strlen(source_code);
+  /* there are never more tokens than characters */
+  *spans = malloc((source_length + 1) * sizeof(struct source_span));
+  RETURN_ERR_IF(!*spans, -ERR_OUT_OF_MEMORY);
+
   for (i = 0; i < source_length; i++) {
     c = source_code[i];
 
     /* skip spacces, add previous tokens */
-    if (isblank(c)) {
+    if (isblank(c) || c == '\n') {
       if (token_found) {
         err = add_token(tokens, &token_count, curr_len,
                         source_code + i - curr_len);
         CLEANUP_WITH_ERR_IF(err, fail_cleanup, -err);
+        set_span(&(*spans)[token_count - 1], i - curr_len, curr_len, line);
 
         curr_len = 0;
         token_found = 0;
       }
+      if (c == '\n')
+        line++;
       continue;
     }
 
@@ -78,6 +122,7 @@ int tokenize(const char *source_code, char ***tokens) {
         err = add_token(tokens, &token_count, curr_len,
                         source_code + i - curr_len);
         CLEANUP_WITH_ERR_IF(err, fail_cleanup, -err);
+        set_span(&(*spans)[token_count - 1], i - curr_len, curr_len, line);
 
         token_found = 0;
         curr_len = 0;
@@ -85,6 +130,7 @@ int tokenize(const char *source_code, char ***tokens) {
 
       err = add_token(tokens, &token_count, 1, source_code + i - curr_len);
       CLEANUP_WITH_ERR_IF(err, fail_cleanup, -err);
+      set_span(&(*spans)[token_count - 1], i, 1, line);
       continue;
     }
 
@@ -100,6 +146,8 @@ int tokenize(const char *source_code, char ***tokens) {
     err = add_token(tokens, &token_count, curr_len,
                     source_code + source_length - curr_len);
     CLEANUP_WITH_ERR_IF(err, fail_cleanup, -err);
+    set_span(&(*spans)[token_count - 1], source_length - curr_len, curr_len,
+             line);
   }
 
   /* NULL-terminate the token_array */
@@ -108,6 +156,13 @@ int tokenize(const char *source_code, char ***tokens) {
   *tokens = tmp;
   (*tokens)[token_count] = NULL;
 
+  /* the spans were allocated for one token per character */
+  fitted = realloc(*spans, (token_count ? token_count : 1) *
+                               sizeof(struct source_span));
+  if (fitted)
+    *spans = fitted;
+  mem_charge(MEM_LEXER, tokens_bytes(*tokens, token_count));
+
   return token_count;
 
 fail_cleanup: /* free already allocated tokens on failure */
@@ -116,65 +171,24 @@ fail_cleanup: /* free already allocated tokens on failure */
   }
   free(*tokens);
   *tokens = NULL;
+  free(*spans);
+  *spans = NULL;
   return retval;
 };
 
 /**
- * @brief Split preprocessed source into top-level Lisp expressions.
+ * @brief Frees the tokens and spans returned by tokenize
  *
- * @param source_code NUL-terminated preprocessed input string.
- * @param tokens out param; receives NULL-terminated array of expressions.
- * @return number of expressions on success; negative err_t on failure.
+ * @param tokens NULL-terminated array of the tokens, may be NULL
+ * @param spans array of the spans
+ * @param token_count count of the tokens
  */
-int extr_expr(const char *source_code, char ***tokens) {
-  /* sanity check */
-  RETURN_ERR_IF(!source_code || !tokens, -ERR_INTERNAL);
-
-  err_t err, retval = ERR_NO_ERROR;
-  int braces = 0, i = 0, len = strlen(source_code), curr_len = 0, token_count = 0;
-  char c;
-
-  for (i = 0; (c = source_code[i]); i++) {
-    switch (c) {
-    case '(':
-      curr_len++;
-      braces++;
-      break;
-    case ')':
-      curr_len++;
-      braces--;
-      break;
-    case ' ':
-      if (!braces && curr_len) {
-        err = add_token(tokens, &token_count, curr_len,
-                        source_code + i - curr_len);
-        CLEANUP_WITH_ERR_IF(err, fail_cleanup, -err);
-        curr_len = 0;
-      }
-      if (braces) {
-        curr_len++;
-      }
-      break;
-    default:
-      curr_len++;
-      break;
-    }
-  }
-
-  /* add trailing token if any */
-  if (curr_len) {
-    err =
-        add_token(tokens, &token_count, curr_len, source_code + len - curr_len);
-    CLEANUP_WITH_ERR_IF(err, fail_cleanup, -err);
-  }
-
-  return token_count;
-
-fail_cleanup:
-  for (i = 0; i < token_count; i++) {
-    free((*tokens)[i]);
-  }
-  free(*tokens);
-  *tokens = NULL;
-  return retval;
-}
\ No newline at end of file
+void free_tokens(char **tokens, struct source_span *spans, int token_count) {
+  if (!tokens)
+    return;
+  mem_discharge(MEM_LEXER, tokens_bytes(tokens, token_count));
+  for (int i = 0; i < token_count; i++)
+    free(tokens[i]);
+  free(tokens);
+  free(spans);
+}
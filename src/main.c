@@ -1,16 +1,23 @@
+#define _POSIX_C_SOURCE 199309L
 #include "main.h"
 #include "ast.h"
+#include "bench.h"
 #include "env.h"
 #include "err.h"
 #include "lexer.h"
 #include "macros.h"
+#include "memstats.h"
 #include "parser.h"
 #include "preproc.h"
+#include "profile.h"
 #include "repl.h"
+#include "trace.h"
+#include <limits.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 /**
  * @brief Entry point of the program - a simple interpret of Lisp language
@@ -25,47 +32,144 @@ int main(int argc, char **argv) {
   // return run(argc, argv);
 }
 
+/**
+ * @brief Options of a run of the interpreter
+ */
+struct run_options {
+  const char *file;         /**< source to interpret, NULL for the REPL */
+  int verbose;              /**< -v, 2 for -vv */
+  int profile;              /**< -p */
+  const char *profile_path; /**< --profile-out out.json */
+  const char *sample_path;  /**< -s out.folded */
+  int sample_hz;            /**< -F hz */
+  long bench_iterations;    /**< --bench N, 0 if not benchmarking */
+  int mem_stats;            /**< --mem-stats */
+  const char *trace_path;   /**< --trace out.json */
+  long trace_depth;         /**< --trace-depth N */
+};
+
+/**
+ * @brief Parses a count argument of an option
+ *
+ * @param text argument of the option
+ * @param min smallest count accepted
+ * @param value out param, the number
+ * @return err_t ERR_INVALID_ARGS unless the whole text is a number of at
+ * least min
+ */
+static err_t parse_count(const char *text, long min, long *value) {
+  char *end;
+  *value = strtol(text, &end, 10);
+  RETURN_VAL_IF(!*text || *end || *value < min, ERR_INVALID_ARGS);
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Parses the arguments, the file and the options may come in any
+ * order
+ *
+ * @param argc count of elements in the argv array
+ * @param argv array of argument values
+ * @param opts out param, the options
+ * @return err_t ERR_INVALID_ARGS on an unknown or incomplete option
+ */
+static err_t parse_options(int argc, char **argv, struct run_options *opts) {
+  long value;
+
+  memset(opts, 0, sizeof(*opts));
+  opts->sample_hz = SAMPLE_DEFAULT_HZ;
+  opts->trace_depth = TRACE_DEFAULT_DEPTH;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    int has_value = i + 1 < argc;
+
+    if (arg[0] != '-') {
+      RETURN_VAL_IF(opts->file, ERR_INVALID_ARGS);
+      opts->file = arg;
+    } else if (!strcmp("-v", arg)) {
+      opts->verbose = 1;
+    } else if (!strcmp("-vv", arg)) {
+      opts->verbose = 2;
+    } else if (!strcmp("-p", arg)) {
+      opts->profile = 1;
+    } else if (!strcmp("--profile-out", arg) && has_value) {
+      opts->profile = 1;
+      opts->profile_path = argv[++i];
+    } else if (!strcmp("-s", arg) && has_value) {
+      opts->sample_path = argv[++i];
+    } else if (!strcmp("-F", arg) && has_value) {
+      RETURN_VAL_IF(parse_count(argv[++i], 1, &value) || value > 1000000,
+                    ERR_INVALID_ARGS);
+      opts->sample_hz = (int)value;
+    } else if (!strcmp("--bench", arg) && has_value) {
+      RETURN_VAL_IF(parse_count(argv[++i], 1, &opts->bench_iterations),
+                    ERR_INVALID_ARGS);
+    } else if (!strcmp("--mem-stats", arg)) {
+      opts->mem_stats = 1;
+    } else if (!strcmp("--trace", arg) && has_value) {
+      opts->trace_path = argv[++i];
+    } else if (!strcmp("--trace-depth", arg) && has_value) {
+      /* depth 0 traces the top-level forms only */
+      RETURN_VAL_IF(parse_count(argv[++i], 0, &opts->trace_depth) ||
+                        opts->trace_depth > INT_MAX,
+                    ERR_INVALID_ARGS);
+    } else {
+      return ERR_INVALID_ARGS;
+    }
+  }
+
+  /* the REPL takes no other options */
+  RETURN_VAL_IF(!opts->file && argc > 1 + opts->mem_stats, ERR_INVALID_ARGS);
+  return ERR_NO_ERROR;
+}
+
 /**
  * @brief Handles arguments and either beigns the interpret loop or evaluates
  * given Lisp source code and exits
  *
- * The arguments are hardcoded, because so far if there are 2 or 3 args, they
- * can only have one meaning
+ * The options may come before or after the file: -v or -vv, -p, or
+ * --profile-out with the path of a JSON file for the profile, -s with the path
+ * of the folded stacks of the samples, -F with the rate of sampling, --bench
+ * with a count of evaluations of the parsed file, --trace with the path of a
+ * Chrome trace of the top-level forms and operator calls up to --trace-depth
+ * and --mem-stats, which also works for the interpret loop
  *
  * @param argc count of elements in the argv array
  * @param argv array of argument values
  * @return exit status defined in err.h
  */
 err_t run(int argc, char **argv) {
-
-  // ran with no args, enter interpret loop
-  if (argc == 1)
-    return repl();
-
-  int retval, verbose = 0;
+  struct run_options opts;
+  int retval;
   size_t bytes_read, file_size;
   long temp;
   FILE *fptr = NULL;
   char *source_code = NULL;
+  astnode *root = NULL;
   env *env = NULL;
 
-  // expect no more than two arguments
-  if (argc > 3) {
+  if (parse_options(argc, argv, &opts)) {
     print_help(argv[0]);
     return ERR_INVALID_ARGS;
   }
 
-  // with 2 args, the second should be '-v' flag
-  if (argc == 3) {
-    if (strcmp("-v", argv[2]) != 0) {
-      print_help(argv[0]);
-      return ERR_INVALID_ARGS;
-    }
-    verbose = 1;
+  // the breakdown of the live nodes costs a header on every node
+  if (opts.mem_stats) {
+    retval = track_live_nodes();
+    RETURN_ERR_IF(retval, retval);
+  }
+
+  // ran without a file, enter interpret loop
+  if (!opts.file) {
+    retval = repl();
+    if (opts.mem_stats)
+      mem_report(stderr);
+    return retval;
   }
 
   // open and read file input into source_code
-  fptr = fopen(argv[1], "r");
+  fptr = fopen(opts.file, "r");
   RETURN_ERR_IF(!fptr, ERR_INVALID_INPUT_FILE);
 
   temp = fseek(fptr, 0, SEEK_END);
@@ -85,13 +189,63 @@ err_t run(int argc, char **argv) {
 
   source_code[file_size] = '\0';
 
-  env = create_env();
-  RETURN_ERR_IF(!env, ERR_OUT_OF_MEMORY);
+  if (!opts.bench_iterations) {
+    env = create_env();
+    CLEANUP_WITH_ERR_IF(!env, cleanup, ERR_OUT_OF_MEMORY);
+  }
 
-  retval = process_code_block(source_code, verbose, env);
+  if (opts.profile) {
+    retval = profile_start();
+    CLEANUP_WITH_ERR_IF(retval, cleanup, retval);
+  }
+  if (opts.sample_path) {
+    retval = sampling_start(opts.file, opts.sample_hz);
+    CLEANUP_WITH_ERR_IF(retval, cleanup, retval);
+  }
+  if (opts.trace_path) {
+    retval = trace_start((int)opts.trace_depth);
+    CLEANUP_WITH_ERR_IF(retval, cleanup, retval);
+  }
+
+  if (opts.bench_iterations) {
+    // the program is parsed once and evaluated in a fresh env every time
+    retval = parse_source(source_code, &root);
+    if (!retval)
+      retval = bench_program(root, source_code, opts.bench_iterations,
+                             opts.verbose);
+  } else {
+    retval = process_code_block(source_code, opts.verbose, env);
+  }
+
+  if (opts.sample_path) {
+    temp = sampling_write(opts.sample_path);
+    if (!retval)
+      retval = (int)temp;
+  }
+
+  if (opts.trace_path) {
+    temp = trace_write(opts.trace_path);
+    if (!retval)
+      retval = (int)temp;
+  }
+
+  // the profile of a failed run still shows where the time went
+  if (opts.profile && opts.profile_path) {
+    temp = profile_write_json(opts.profile_path);
+    if (!retval)
+      retval = (int)temp;
+  } else if (opts.profile) {
+    profile_print(stderr);
+  }
 
 cleanup:
+  trace_stop();
+  profile_stop();
+  free_node(root);
   free_env(env);
+  // the program is freed, so the nodes still live were leaked
+  if (opts.mem_stats)
+    mem_report(stderr);
   free(source_code);
   if (fptr)
     fclose(fptr);
@@ -99,69 +253,171 @@ cleanup:
 }
 
 /**
- * @brief Tokenizes, parses the source code and evaluates all outer expressions
- * and prints their result
+ * @brief Prints the part of the source code a node was read from, line feeds
+ * of multi-line expressions as spaces
  *
- * @param source_code to interpret
- * @return int
+ * @param out stream to print to
+ * @param source_code the preprocessed source code
+ * @param span of the node
  */
-err_t process_code_block(char *source_code, int verbose, env *env) {
+static void print_span(FILE *out, const char *source_code,
+                       const struct source_span *span) {
+  const char *c = source_code + span->offset;
+  for (; c < source_code + span->offset + span->length; c++)
+    fputc(*c == '\n' ? ' ' : *c, out);
+}
+
+/**
+ * @brief Preprocesses, tokenizes and parses the source code. Only the tokens
+ * are upper cased, so the spans of the nodes point to the source as written.
+ *
+ * @param source_code to parse, comments are blanked in place
+ * @param root out param, list of the outer expressions, NULL on failure
+ * @return err_t
+ */
+err_t parse_source(char *source_code, astnode **root) {
   /* sanity check */
-  RETURN_ERR_IF(!source_code || !env, ERR_INTERNAL);
+  RETURN_ERR_IF(!source_code || !root, ERR_INTERNAL);
 
-  char **tokens = NULL, **expr_arr = NULL;
-  int token_count = 0, i, expr_count = 0;
+  char **tokens = NULL;
+  struct source_span *spans = NULL;
+  int token_count = 0, i, curr_tok = 0;
   err_t err, retval = ERR_NO_ERROR;
 
-  
+  *root = NULL;
   err = preprocess(source_code);
   RETURN_ERR_IF(err, err);
 
-  expr_count = extr_expr(source_code, &expr_arr);
-  RETURN_ERR_IF(expr_count < 0, -expr_count);
-
-  to_upper_str(source_code);
-  
-
-  token_count = tokenize(source_code, &tokens);
+  token_count = tokenize(source_code, &tokens, &spans);
   CLEANUP_WITH_ERR_IF(token_count < 0, cleanup, -token_count);
+  for (i = 0; i < token_count; i++)
+    to_upper_str(tokens[i]);
 
-  int curr_tok = 0;
-  astnode *root = NULL, *result_node = NULL;
-  err = parse_list(&root, (const char **)tokens, &curr_tok);
+  err = parse_list(root, (const char **)tokens, spans, &curr_tok);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
   CLEANUP_WITH_ERR_IF(curr_tok != token_count, cleanup, ERR_SYNTAX_ERROR);
-  RETURN_VAL_IF(err, err);
 
-  CLEANUP_WITH_ERR_IF(expr_count != root->as.list.count, cleanup, ERR_INTERNAL);
-  for (i = 0; i < root->as.list.count; i++) {
-    err = eval_node(root->as.list.children[i], &result_node, env);
+cleanup:
+  free_tokens(tokens, spans, token_count);
+  if (retval) {
+    free_node(*root);
+    *root = NULL;
+  }
+  return retval;
+}
+
+/**
+ * @brief Reads the monotonic clock
+ *
+ * @return uint64_t nanoseconds
+ */
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Evaluates the outer expressions of a parsed program in order and
+ * prints their results in verbose mode
+ *
+ * At verbose level 2 every result is followed by the elapsed microseconds of
+ * the evaluation, the count of eval_node calls and the bytes the expression
+ * left allocated once its temporary result is freed, and the program by a
+ * line with their totals.
+ *
+ * @param root list of the outer expressions from parse_source
+ * @param source_code the source the spans of the expressions point to
+ * @param verbose 1 to print every expression and its result, 2 to add their
+ * cost
+ * @param env environment for evaluation
+ * @return err_t of the first failed expression
+ */
+err_t eval_program(astnode *root, const char *source_code, int verbose,
+                   env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!root || root->type != LIST || !source_code || !env,
+                ERR_INTERNAL);
+
+  astnode *result_node = NULL, *expr;
+  uint64_t start = 0, elapsed = 0, evals = 0, total_ns = 0, total_evals = 0;
+  int64_t bytes = 0, total_bytes = 0;
+  err_t err;
+
+  for (int i = 0; i < root->as.list.count; i++) {
+    expr = root->as.list.children[i];
+    if (verbose > 1) {
+      bytes = mem_total.current;
+      evals = node_evals;
+      start = now_ns();
+    }
+    if (profiling & PROFILE_TRACE)
+      trace_form_begin(expr);
+    err = eval_node(expr, &result_node, env);
+    if (profiling & PROFILE_TRACE)
+      trace_form_end();
+    if (verbose > 1) {
+      elapsed = now_ns() - start;
+      evals = node_evals - evals;
+    }
     if (err == CONTROL_BREAK)
       err = ERR_SYNTAX_ERROR;
 
-    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    if (err && err != CONTROL_QUIT && DBG_VERBOSE) {
+      fprintf(stderr, " ==> line %d: ", expr->span.line);
+      print_span(stderr, source_code, &expr->span);
+      fprintf(stderr, "\n");
+    }
+    RETURN_ERR_IF(err, err);
     if (verbose) {
-      printf("[%d]> %s\r\n", i + 1, expr_arr[i]);
+      printf("[%d]> ", i + 1);
+      print_span(stdout, source_code, &expr->span);
+      printf("\r\n");
       print_node(result_node);
       printf("\r\n");
     }
     free_temp_node_parts(result_node);
     result_node = NULL;
-  }
 
-cleanup:
-  for (i = 0; i < token_count; i++) {
-    // printf("freeing token %d: %s\n", i, tokens[i]);
-    free(tokens[i]);
-  }
-  free(tokens);
-  for (i = 0; i < expr_count; i++) {
-    // printf("freeing expr[%d]: %s\n", i, expr_arr[i]);
-    free(expr_arr[i]);
+    if (verbose > 1) {
+      bytes = mem_total.current - bytes;
+      printf("    %.1f us, %llu evaluations, %+lld bytes\r\n", elapsed / 1e3,
+             (unsigned long long)evals, (long long)bytes);
+      total_ns += elapsed;
+      total_evals += evals;
+      total_bytes += bytes;
+    }
   }
-  free(expr_arr);
-  free_node(root);
+  if (verbose > 1)
+    printf("total: %d expressions, %.1f us, %llu evaluations, %+lld "
+           "bytes\r\n",
+           root->as.list.count, total_ns / 1e3,
+           (unsigned long long)total_evals, (long long)total_bytes);
+  return ERR_NO_ERROR;
+}
 
-  return retval;
+/**
+ * @brief Tokenizes, parses the source code and evaluates all outer expressions
+ * and prints their result
+ *
+ * The verbose output and error messages print the expressions from the source
+ * code through the spans of the nodes, so only the tokens are upper cased.
+ *
+ * @param source_code to interpret
+ * @return int
+ */
+err_t process_code_block(char *source_code, int verbose, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!source_code || !env, ERR_INTERNAL);
+
+  astnode *root = NULL;
+  err_t err;
+
+  err = parse_source(source_code, &root);
+  RETURN_ERR_IF(err, err);
+  err = eval_program(root, source_code, verbose, env);
+  free_node(root);
+  return err;
 };
 
 /**
@@ -188,7 +444,35 @@ err_t agregate_exit_status(err_t exit_status) {
  * @param progname Name of the executable (argv[0])
  */
 void print_help(const char *progname) {
-  fprintf(stderr, "Usage: %s [file] [-v]\n", progname);
+  fprintf(stderr,
+          "Usage: %s [file] [-v|-vv] [-p] [--profile-out out.json]\n"
+          "       [-s out.folded [-F hz]] [--bench N] [--mem-stats]\n"
+          "       [--trace out.json [--trace-depth N]]\n",
+          progname);
   fprintf(stderr, "  file   Lisp source file to interpret\n");
   fprintf(stderr, "  -v     (optional) print results of all expressions\n");
+  fprintf(stderr, "  -vv    (optional) also print the microseconds, "
+                  "evaluations and net\n         allocated bytes of every "
+                  "expression and their totals\n");
+  fprintf(stderr, "  -p     (optional) print time, calls and allocations of "
+                  "every operator\n");
+  fprintf(stderr, "  --profile-out (optional) write the profile of -p to "
+                  "out.json instead\n");
+  fprintf(stderr, "  -s     (optional) sample the running operators and write "
+                  "their source\n         lines as folded stacks for "
+                  "flamegraph.pl\n");
+  fprintf(stderr, "  -F     (optional) samples per second of CPU time, %d by "
+                  "default\n", SAMPLE_DEFAULT_HZ);
+  fprintf(stderr, "  --bench (optional) parse the file once, evaluate it N "
+                  "times in a fresh\n         environment and print the "
+                  "latency, evaluations and allocations,\n         N is at "
+                  "least 1\n");
+  fprintf(stderr, "  --trace (optional) write the top-level forms and "
+                  "operator calls as a Chrome\n         trace for Perfetto or "
+                  "chrome://tracing\n");
+  fprintf(stderr, "  --trace-depth (optional) deepest operator call traced, "
+                  "%d by default,\n         0 traces the top-level forms "
+                  "only\n", TRACE_DEFAULT_DEPTH);
+  fprintf(stderr, "  --mem-stats (optional) print the peak and leaked memory "
+                  "by node type\n         and origin at exit\n");
 }
\ No newline at end of file
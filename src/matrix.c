@@ -0,0 +1,463 @@
+#include "matrix.h"
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include "macros.h"
+#include "simd.h"
+#include "vector.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Returns a pointer to the element in row i and column j of a MATRIX
+ * node, no bounds checking
+ *
+ * @param mat MATRIX type node
+ * @param i row index
+ * @param j column index
+ * @return int64_t*
+ */
+int64_t *matrix_at(const astnode *mat, int i, int j) {
+  return mat->as.matrix.data + (size_t)i * mat->as.matrix.cols + j;
+}
+
+/**
+ * @brief Checks that a matrix of the shape can be indexed with an int
+ *
+ * @param rows number of rows
+ * @param cols number of columns
+ * @return int 1 if the shape is valid, 0 otherwise
+ */
+static int is_valid_shape(int64_t rows, int64_t cols) {
+  return rows >= 0 && cols >= 0 && rows <= INT_MAX && cols <= INT_MAX &&
+         (!cols || rows <= INT_MAX / cols);
+}
+
+/**
+ * @brief Evaluates an index argument and checks it is a NUMBER in [0, bound)
+ *
+ * @param expr expression of the index
+ * @param bound count of valid indexes
+ * @param index out param, the index
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t eval_index(astnode *expr, int bound, int *index, env *env) {
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *temp = NULL;
+
+  err = eval_node(expr, &temp, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(temp->type != NUMBER, cleanup, ERR_SYNTAX_ERROR);
+  CLEANUP_WITH_ERR_IF(temp->as.value < 0 || temp->as.value >= bound, cleanup,
+                      ERR_SYNTAX_ERROR);
+  *index = (int)temp->as.value;
+cleanup:
+  free_temp_node_parts(temp);
+  return retval;
+}
+
+/**
+ * @brief Converts a LIST node of rows, LIST nodes of NUMBER nodes of the same
+ * length, into a new MATRIX node.
+ * Fails with syntax error when the rows are ragged or an item is not a number.
+ *
+ * @param list LIST type node
+ * @param out_node out param, the new matrix with UNSET origin
+ * @return err_t
+ */
+err_t list_to_matrix(const astnode *list, astnode **out_node) {
+  /* sanity check */
+  RETURN_ERR_IF(!list || list->type != LIST || !out_node, ERR_INTERNAL);
+
+  int rows = list->as.list.count, cols = 0;
+  astnode *row, *mat;
+
+  for (int i = 0; i < rows; i++) {
+    row = list->as.list.children[i];
+    RETURN_ERR_IF(row->type != LIST, ERR_SYNTAX_ERROR);
+    if (!i)
+      cols = row->as.list.count;
+    RETURN_ERR_IF(row->as.list.count != cols, ERR_SYNTAX_ERROR);
+    for (int j = 0; j < cols; j++)
+      RETURN_ERR_IF(row->as.list.children[j]->type != NUMBER,
+                    ERR_SYNTAX_ERROR);
+  }
+  RETURN_ERR_IF(!is_valid_shape(rows, cols), ERR_SYNTAX_ERROR);
+
+  mat = get_matrix_node(rows, cols);
+  RETURN_ERR_IF(!mat, ERR_OUT_OF_MEMORY);
+  for (int i = 0; i < rows; i++) {
+    row = list->as.list.children[i];
+    for (int j = 0; j < cols; j++)
+      *matrix_at(mat, i, j) = row->as.list.children[j]->as.value;
+  }
+
+  *out_node = mat;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Creates a new matrix. Called either with the rows and columns and
+ * an optional initial value or integer vector of rows * cols elements in row
+ * major order (make-matrix 2 3 0), or with a list of rows to pack
+ * (make-matrix '((1 2) (3 4))).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result MATRIX node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_make_matrix(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 2 || list_node->as.list.count > 4,
+                ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int64_t rows, count;
+  astnode *temp = NULL, *mat = NULL;
+
+  err = eval_node(list_node->as.list.children[1], &temp, env);
+  RETURN_ERR_IF(err, err);
+
+  /* pack a list of rows */
+  if (temp->type == LIST) {
+    CLEANUP_WITH_ERR_IF(list_node->as.list.count != 2, cleanup,
+                        ERR_SYNTAX_ERROR);
+    err = list_to_matrix(temp, &mat);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    goto done;
+  }
+
+  CLEANUP_WITH_ERR_IF(list_node->as.list.count < 3 || temp->type != NUMBER,
+                      cleanup, ERR_SYNTAX_ERROR);
+  rows = temp->as.value;
+  free_temp_node_parts(temp);
+  temp = NULL;
+
+  err = eval_node(list_node->as.list.children[2], &temp, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(temp->type != NUMBER ||
+                          !is_valid_shape(rows, temp->as.value),
+                      cleanup, ERR_SYNTAX_ERROR);
+  mat = get_matrix_node((int)rows, (int)temp->as.value);
+  CLEANUP_WITH_ERR_IF(!mat, cleanup, ERR_OUT_OF_MEMORY);
+  count = rows * temp->as.value;
+  free_temp_node_parts(temp);
+  temp = NULL;
+
+  if (list_node->as.list.count == 4) {
+    err = eval_node(list_node->as.list.children[3], &temp, env);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    if (temp->type == NUMBER) {
+      for (int64_t k = 0; temp->as.value && k < count; k++)
+        mat->as.matrix.data[k] = temp->as.value;
+    } else {
+      /* reshape the elements of an integer vector */
+      CLEANUP_WITH_ERR_IF(temp->type != VECTOR ||
+                              temp->as.vector.kind == VEC_F64 ||
+                              temp->as.vector.count != count,
+                          fail_cleanup, ERR_SYNTAX_ERROR);
+      for (int k = 0; k < count; k++)
+        mat->as.matrix.data[k] = vector_get(temp, k);
+    }
+  }
+
+done:
+  mat->origin = TEMPORARY;
+  *result_node = mat;
+cleanup:
+  free_temp_node_parts(temp);
+  return retval;
+fail_cleanup:
+  free_node(mat);
+  free_temp_node_parts(temp);
+  return retval;
+}
+
+/**
+ * @brief Returns the element of a matrix in the row and column as a NUMBER
+ * node, (mref matrix row column).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result NUMBER node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_mref(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 4, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  int row, col;
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *mat = NULL;
+
+  err = eval_node(list_node->as.list.children[1], &mat, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(mat->type != MATRIX, cleanup, ERR_SYNTAX_ERROR);
+
+  err = eval_index(list_node->as.list.children[2], mat->as.matrix.rows, &row,
+                   env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  err = eval_index(list_node->as.list.children[3], mat->as.matrix.cols, &col,
+                   env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+  *result_node = get_number_node(*matrix_at(mat, row, col));
+  CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
+  (*result_node)->origin = TEMPORARY;
+
+cleanup:
+  free_temp_node_parts(mat);
+  return retval;
+}
+
+/**
+ * @brief Assigns to a matrix element, (set (mref matrix row column) value).
+ * Called by SET, as matrix elements are not nodes that could be replaced.
+ * The matrix must be a variable.
+ * @param list_node List node of the SET operator
+ * @param result_node out param pointer to the stored NUMBER node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_set_mref(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 3, ERR_SYNTAX_ERROR);
+
+  astnode *place = list_node->as.list.children[1];
+  RETURN_ERR_IF(place->type != LIST || place->as.list.count != 4,
+                ERR_SYNTAX_ERROR);
+
+  int row, col;
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *mat = NULL, *temp = NULL;
+
+  err = eval_node(place->as.list.children[1], &mat, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(mat->type != MATRIX, cleanup, ERR_SYNTAX_ERROR);
+  CLEANUP_WITH_ERR_IF(mat->origin != VARIABLE, cleanup, ERR_NOT_A_VARIABLE);
+
+  err = eval_index(place->as.list.children[2], mat->as.matrix.rows, &row, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  err = eval_index(place->as.list.children[3], mat->as.matrix.cols, &col, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+  err = eval_node(list_node->as.list.children[2], &temp, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  CLEANUP_WITH_ERR_IF(temp->type != NUMBER, cleanup, ERR_SYNTAX_ERROR);
+  *matrix_at(mat, row, col) = temp->as.value;
+
+  *result_node = get_number_node(temp->as.value);
+  CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
+  (*result_node)->origin = TEMPORARY;
+
+cleanup:
+  free_temp_node_parts(mat);
+  free_temp_node_parts(temp);
+  return retval;
+}
+
+/**
+ * @brief Evaluates the single argument of a matrix operator
+ *
+ * @param list_node List node containing the operator
+ * @param mat out param, the MATRIX node
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t eval_matrix_arg(astnode *list_node, astnode **mat, env *env) {
+  err_t err, retval = ERR_NO_ERROR;
+
+  RETURN_ERR_IF(list_node->as.list.count != 2, ERR_SYNTAX_ERROR);
+  RETURN_ERR_IF(!list_node->as.list.children[1], ERR_INTERNAL);
+
+  err = eval_node(list_node->as.list.children[1], mat, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF((*mat)->type != MATRIX, fail_cleanup, ERR_SYNTAX_ERROR);
+  return ERR_NO_ERROR;
+fail_cleanup:
+  free_temp_node_parts(*mat);
+  *mat = NULL;
+  return retval;
+}
+
+/**
+ * @brief Matrix product, (matmul a b). The columns of a must match the rows
+ * of b. The product is computed in cache sized tiles with a packed inner
+ * kernel and wraps around on overflow like the vector arithmetic.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result MATRIX node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_matmul(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int n, m, inner;
+  astnode *a = NULL, *b = NULL, *prod = NULL;
+
+  err = eval_node(list_node->as.list.children[1], &a, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(a->type != MATRIX, cleanup, ERR_SYNTAX_ERROR);
+  err = eval_node(list_node->as.list.children[2], &b, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  CLEANUP_WITH_ERR_IF(b->type != MATRIX, cleanup, ERR_SYNTAX_ERROR);
+  CLEANUP_WITH_ERR_IF(a->as.matrix.cols != b->as.matrix.rows, cleanup,
+                      ERR_SYNTAX_ERROR);
+
+  n = a->as.matrix.rows;
+  m = b->as.matrix.cols;
+  inner = a->as.matrix.cols;
+  CLEANUP_WITH_ERR_IF(!is_valid_shape(n, m), cleanup, ERR_SYNTAX_ERROR);
+  prod = get_matrix_node(n, m);
+  CLEANUP_WITH_ERR_IF(!prod, cleanup, ERR_OUT_OF_MEMORY);
+
+  /* i-k-j order, every element of a scales a row of b into a row of the
+   * product, so all accesses are sequential. The tile of b is reused by all
+   * rows of a before moving on. */
+  for (int kk = 0; kk < inner; kk += MATMUL_BLOCK_K) {
+    int k_end = kk + MATMUL_BLOCK_K < inner ? kk + MATMUL_BLOCK_K : inner;
+    for (int jj = 0; jj < m; jj += MATMUL_BLOCK_J) {
+      int width = jj + MATMUL_BLOCK_J < m ? MATMUL_BLOCK_J : m - jj;
+      for (int i = 0; i < n; i++) {
+        int64_t *dst = matrix_at(prod, i, jj);
+        for (int k = kk; k < k_end; k++) {
+          int64_t factor = *matrix_at(a, i, k);
+          if (factor)
+            simd_axpy_i64(dst, factor, matrix_at(b, k, jj), width);
+        }
+      }
+    }
+  }
+
+  prod->origin = TEMPORARY;
+  *result_node = prod;
+cleanup:
+  free_temp_node_parts(a);
+  free_temp_node_parts(b);
+  return retval;
+}
+
+/**
+ * @brief Returns the transposed copy of a matrix, (transpose matrix).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result MATRIX node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_transpose(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int rows, cols;
+  astnode *mat = NULL, *trans = NULL;
+
+  err = eval_matrix_arg(list_node, &mat, env);
+  RETURN_ERR_IF(err, err);
+  rows = mat->as.matrix.rows;
+  cols = mat->as.matrix.cols;
+  trans = get_matrix_node(cols, rows);
+  CLEANUP_WITH_ERR_IF(!trans, cleanup, ERR_OUT_OF_MEMORY);
+
+  /* copy square tiles, so neither the reads nor the strided writes leave
+   * the cache before the tile is done */
+  for (int ii = 0; ii < rows; ii += TRANSPOSE_BLOCK) {
+    int i_end = ii + TRANSPOSE_BLOCK < rows ? ii + TRANSPOSE_BLOCK : rows;
+    for (int jj = 0; jj < cols; jj += TRANSPOSE_BLOCK) {
+      int j_end = jj + TRANSPOSE_BLOCK < cols ? jj + TRANSPOSE_BLOCK : cols;
+      for (int i = ii; i < i_end; i++)
+        for (int j = jj; j < j_end; j++)
+          *matrix_at(trans, j, i) = *matrix_at(mat, i, j);
+    }
+  }
+
+  trans->origin = TEMPORARY;
+  *result_node = trans;
+cleanup:
+  free_temp_node_parts(mat);
+  return retval;
+}
+
+/**
+ * @brief Reduces every row or every column of a matrix into a vector,
+ * ROW-SUM, ROW-MIN, ROW-MAX, COL-SUM, COL-MIN and COL-MAX. Sums wrap around
+ * on overflow, minimum and maximum need a nonempty row or column.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result VECTOR node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_matrix_reduce(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+
+  const char *symbol = list_node->as.list.children[0]->as.symbol;
+  int by_row = !strncmp(symbol, "ROW-", 4);
+  enum simd_op op;
+  if (!strcmp(symbol + 4, "SUM"))
+    op = SIMD_ADD;
+  else if (!strcmp(symbol + 4, "MIN"))
+    op = SIMD_MIN;
+  else if (!strcmp(symbol + 4, "MAX"))
+    op = SIMD_MAX;
+  else
+    return ERR_INTERNAL;
+
+  err_t err, retval = ERR_NO_ERROR;
+  int rows, cols;
+  int64_t *out;
+  astnode *mat = NULL, *vec = NULL;
+
+  err = eval_matrix_arg(list_node, &mat, env);
+  RETURN_ERR_IF(err, err);
+  rows = mat->as.matrix.rows;
+  cols = mat->as.matrix.cols;
+  CLEANUP_WITH_ERR_IF(op != SIMD_ADD && !(by_row ? cols : rows), cleanup,
+                      ERR_SYNTAX_ERROR);
+
+  vec = get_vector_node(VEC_INT64, by_row ? rows : cols);
+  CLEANUP_WITH_ERR_IF(!vec, cleanup, ERR_OUT_OF_MEMORY);
+  out = vec->as.vector.data;
+
+  if (by_row) {
+    for (int i = 0; i < rows; i++)
+      out[i] = simd_reduce_i64(op, matrix_at(mat, i, 0), cols);
+  } else if (rows) {
+    /* combine whole rows element-wise instead of walking the columns */
+    memcpy(out, matrix_at(mat, 0, 0), cols * sizeof(int64_t));
+    for (int i = 1; i < rows; i++)
+      simd_binop_i64(op, out, out, matrix_at(mat, i, 0), cols);
+  }
+
+  vec->origin = TEMPORARY;
+  *result_node = vec;
+cleanup:
+  free_temp_node_parts(mat);
+  return retval;
+}
@@ -0,0 +1,133 @@
+#include "memstats.h"
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include "macros.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NODE_TYPES (HEAP + 1)
+#define NODE_ORIGINS (TEMPORARY + 1)
+
+struct mem_usage mem_usage[MEM_OWNERS];
+struct mem_usage mem_total;
+
+static const char *owner_names[MEM_OWNERS] = {"nodes", "env", "lexer"};
+
+static const char *type_names[NODE_TYPES] = {
+    "BOOLEAN", "NUMBER", "SYMBOL", "LIST",  "VECTOR", "HASH",
+    "RANGE",   "BIGNUM", "FLOAT",  "MATRIX", "HEAP",
+};
+
+static const char *origin_names[NODE_ORIGINS] = {"UNSET", "AST", "VARIABLE",
+                                                 "TEMPORARY"};
+
+/**
+ * @brief Accounts bytes allocated by the owner
+ *
+ * @param owner of the memory
+ * @param bytes allocated
+ */
+void mem_charge(enum mem_owner owner, size_t bytes) {
+  struct mem_usage *usage = &mem_usage[owner];
+  usage->current += (int64_t)bytes;
+  if (usage->current > usage->peak)
+    usage->peak = usage->current;
+  mem_total.current += (int64_t)bytes;
+  if (mem_total.current > mem_total.peak)
+    mem_total.peak = mem_total.current;
+}
+
+/**
+ * @brief Accounts bytes freed by the owner
+ *
+ * @param owner of the memory
+ * @param bytes freed
+ */
+void mem_discharge(enum mem_owner owner, size_t bytes) {
+  mem_usage[owner].current -= (int64_t)bytes;
+  mem_total.current -= (int64_t)bytes;
+}
+
+/**
+ * @brief Prints the current and peak bytes of every owner and the live nodes
+ * with their bytes by type and origin
+ *
+ * The live nodes are counted by walking all of them, so their bytes are
+ * exact. Bignums in the middle of an arithmetic operation are held by no node
+ * and only show in the bytes of the owner. Unless the nodes are tracked, see
+ * track_live_nodes, only their count is printed.
+ *
+ * @param out stream to print to
+ * @return err_t
+ */
+err_t mem_report(FILE *out) {
+  /* sanity check */
+  RETURN_ERR_IF(!out, ERR_INTERNAL);
+
+  uint64_t nodes[NODE_TYPES][NODE_ORIGINS], bytes[NODE_TYPES][NODE_ORIGINS];
+  uint64_t node_total = 0, byte_total = 0;
+  const astnode *node;
+
+  memset(nodes, 0, sizeof(nodes));
+  memset(bytes, 0, sizeof(bytes));
+  for (node = next_live_node(NULL); node; node = next_live_node(node)) {
+    nodes[node->type][node->origin]++;
+    bytes[node->type][node->origin] += node_bytes(node);
+  }
+
+  fprintf(out, "memory: %lld bytes, peak %lld bytes\n",
+          (long long)mem_total.current, (long long)mem_total.peak);
+  for (int i = 0; i < MEM_OWNERS; i++)
+    fprintf(out, "  %-8s %14lld bytes, peak %14lld bytes\n", owner_names[i],
+            (long long)mem_usage[i].current, (long long)mem_usage[i].peak);
+
+  if (!next_live_node(NULL) && node_allocs != node_frees) {
+    fprintf(out, "live nodes: %llu, run with --mem-stats to list them\n",
+            (unsigned long long)(node_allocs - node_frees));
+    return ERR_NO_ERROR;
+  }
+  fprintf(out, "live nodes:\n  %-8s %-10s %12s %14s\n", "type", "origin",
+          "nodes", "bytes");
+  for (int type = 0; type < NODE_TYPES; type++) {
+    for (int origin = 0; origin < NODE_ORIGINS; origin++) {
+      if (!nodes[type][origin])
+        continue;
+      fprintf(out, "  %-8s %-10s %12llu %14llu\n", type_names[type],
+              origin_names[origin], (unsigned long long)nodes[type][origin],
+              (unsigned long long)bytes[type][origin]);
+      node_total += nodes[type][origin];
+      byte_total += bytes[type][origin];
+    }
+  }
+  fprintf(out, "  %-19s %12llu %14llu\n", "total",
+          (unsigned long long)node_total, (unsigned long long)byte_total);
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Prints the memory report of mem_report to stderr, (room). Returns
+ * the count of bytes currently held. The live nodes are listed by type and
+ * origin only when the program runs with --mem-stats.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result number node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_room(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 1, ERR_SYNTAX_ERROR);
+
+  err_t err = mem_report(stderr);
+  RETURN_ERR_IF(err, err);
+
+  *result_node = get_number_node(mem_total.current);
+  RETURN_ERR_IF(!*result_node, ERR_OUT_OF_MEMORY);
+  (*result_node)->origin = TEMPORARY;
+  return ERR_NO_ERROR;
+}
@@ -0,0 +1,173 @@
+#include "number.h"
+#include "ast.h"
+#include "bignum.h"
+#include "err.h"
+#include "macros.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Checks whether the node is a number, a NUMBER, BIGNUM or FLOAT node
+ *
+ * @param node to check
+ * @return int 1 if it is, 0 otherwise
+ */
+int is_numeric(const astnode *node) {
+  return node->type == NUMBER || node->type == BIGNUM || node->type == FLOAT;
+}
+
+/**
+ * @brief Converts a NUMBER, BIGNUM or FLOAT node to a double
+ *
+ * @param node to convert
+ * @return double
+ */
+double to_real(const astnode *node) {
+  switch (node->type) {
+  case FLOAT:
+    return node->as.real;
+  case BIGNUM:
+    return bignum_to_double(node->as.big);
+  default:
+    return (double)node->as.value;
+  }
+}
+
+/**
+ * @brief Compares an integer node with a double that is not NaN. Converting a
+ * fixnum to double could round, so the double is split into its integral and
+ * fractional parts instead.
+ *
+ * @param integer NUMBER or BIGNUM node
+ * @param real value to compare with
+ * @return int negative if integer < real, 0 if equal, positive otherwise
+ */
+static int compare_integer_real(const astnode *integer, double real) {
+  int64_t whole;
+  double frac, big;
+
+  if (integer->type == BIGNUM) {
+    /* beyond 2^63, doubles are integers and the rounding is monotonic */
+    big = bignum_to_double(integer->as.big);
+    return (big > real) - (big < real);
+  }
+
+  RETURN_VAL_IF(real >= 9223372036854775808.0, -1);
+  RETURN_VAL_IF(real < -9223372036854775808.0, 1);
+  whole = (int64_t)real;
+  RETURN_VAL_IF(integer->as.value != whole, integer->as.value < whole ? -1 : 1);
+  frac = real - (double)whole;
+  return (frac < 0) - (frac > 0);
+}
+
+/**
+ * @brief Compares two numeric nodes by value, integers and floats exactly.
+ * NaN is ordered after every other number and equal to itself, so sorting
+ * stays a total order.
+ *
+ * @param a NUMBER, BIGNUM or FLOAT node
+ * @param b NUMBER, BIGNUM or FLOAT node
+ * @return int negative if a < b, 0 if equal, positive if a > b
+ */
+int compare_numbers(const astnode *a, const astnode *b) {
+  if (a->type != FLOAT && b->type != FLOAT)
+    return compare_integers(a, b);
+
+  if (a->type == FLOAT && isnan(a->as.real))
+    return !(b->type == FLOAT && isnan(b->as.real));
+  if (b->type == FLOAT && isnan(b->as.real))
+    return -1;
+
+  if (a->type != FLOAT)
+    return compare_integer_real(a, b->as.real);
+  if (b->type != FLOAT)
+    return -compare_integer_real(b, a->as.real);
+  return (a->as.real > b->as.real) - (a->as.real < b->as.real);
+}
+
+/**
+ * @brief Applies op to the accumulator. Integers use integer_apply, once
+ * either side is a FLOAT the accumulator is converted and the operation is
+ * done in double precision, INT_DIV then being a true division.
+ *
+ * @param op operation to apply
+ * @param acc in/out param, the accumulator
+ * @param arg NUMBER, BIGNUM or FLOAT right operand
+ * @return err_t
+ */
+err_t number_apply(enum int_op op, num_acc *acc, const astnode *arg) {
+  RETURN_ERR_IF(!is_numeric(arg), ERR_SYNTAX_ERROR);
+
+  if (!acc->is_float && arg->type != FLOAT)
+    return integer_apply(op, &acc->fix, &acc->big, arg);
+
+  double value = to_real(arg);
+  RETURN_ERR_IF(op == INT_DIV && value == 0, ERR_ZERO_DIVISON);
+
+  if (!acc->is_float) {
+    acc->real = acc->big ? bignum_to_double(acc->big) : (double)acc->fix;
+    bignum_free(acc->big);
+    acc->big = NULL;
+    acc->is_float = 1;
+  }
+
+  switch (op) {
+  case INT_ADD:
+    acc->real += value;
+    break;
+  case INT_SUB:
+    acc->real -= value;
+    break;
+  case INT_MUL:
+    acc->real *= value;
+    break;
+  default:
+    acc->real /= value;
+    break;
+  }
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Makes a TEMPORARY node for the accumulator, a FLOAT node if it holds
+ * a double and an integer node otherwise. The accumulator bignum is taken
+ * over by the node or freed.
+ *
+ * @param acc the accumulator
+ * @param out_node out param, the new node
+ * @return err_t
+ */
+err_t get_acc_node(num_acc *acc, astnode **out_node) {
+  bignum *big = acc->big;
+
+  acc->big = NULL;
+  if (!acc->is_float)
+    return get_integer_node(acc->fix, big, out_node);
+
+  *out_node = get_float_node(acc->real);
+  RETURN_ERR_IF(!*out_node, ERR_OUT_OF_MEMORY);
+  (*out_node)->origin = TEMPORARY;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Prints a double with the fewest digits that read back to the same
+ * value, always with a decimal point or exponent so it reads back as a FLOAT
+ *
+ * @param real value to print
+ */
+void print_float(double real) {
+  char buf[32];
+
+  for (int digits = 15; digits <= 17; digits++) {
+    snprintf(buf, sizeof(buf), "%.*g", digits, real);
+    if (strtod(buf, NULL) == real)
+      break;
+  }
+  fputs(buf, stdout);
+  if (isfinite(real) && !strpbrk(buf, ".e"))
+    fputs(".0", stdout);
+}
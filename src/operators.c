@@ -1,17 +1,33 @@
 #include "operators.h"
 #include "ast.h"
+#include "bignum.h"
 #include "env.h"
 #include "err.h"
+#include "hash.h"
+#include "heap.h"
 #include "macros.h"
+#include "matrix.h"
+#include "memstats.h"
+#include "number.h"
+#include "pipeline.h"
+#include "profile.h"
+#include "range.h"
+#include "reduce.h"
+#include "set.h"
+#include "sort.h"
+#include "vector.h"
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 /**
- * @brief Evaluates and sums the arguments and returns a new NUMBER node.
- * All arguments must evaluate to NUMBER nodes or a syntax error is returned.
+ * @brief Evaluates and sums the arguments and returns a new number node, a
+ * FLOAT if any argument is a float, otherwise a BIGNUM if the sum does not
+ * fit 64 bits and a NUMBER if it does. All arguments must evaluate to NUMBER,
+ * BIGNUM or FLOAT nodes or a syntax error is returned.
  * @param list_node List node containing the operator and arguments
- * @param result_node out param pointer to the result NUMBER node with TEMPORARY
+ * @param result_node out param pointer to the result node with TEMPORARY
  * origin, NULL on failure
  * @param env The environment for variable lookup and evaluation
  * @return err_t
@@ -23,36 +39,35 @@ err_t oper_add(astnode *list_node, astnode **result_node, env *env) {
   RETURN_ERR_IF(list_node->as.list.count < 3, ERR_SYNTAX_ERROR);
 
   err_t err, retval = ERR_NO_ERROR;
-  int i, sum = 0;
+  int i;
+  num_acc acc = {0};
 
   astnode *temp_node = NULL;
   for (i = 1; i < list_node->as.list.count; i++) {
     RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
 
     err = eval_node(list_node->as.list.children[i], &temp_node, env);
-    RETURN_ERR_IF(err, err);
-    CLEANUP_WITH_ERR_IF(temp_node->type != NUMBER, fail_cleanup,
-                        ERR_SYNTAX_ERROR);
-    sum += temp_node->as.value;
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    err = number_apply(INT_ADD, &acc, temp_node);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
     free_temp_node_parts(temp_node);
+    temp_node = NULL;
   }
 
-  *result_node = get_number_node(sum);
-  RETURN_ERR_IF(!*result_node, ERR_OUT_OF_MEMORY);
-  (*result_node)->origin = TEMPORARY;
-
-  return ERR_NO_ERROR;
+  return get_acc_node(&acc, result_node);
 fail_cleanup:
+  bignum_free(acc.big);
   free_temp_node_parts(temp_node);
   return retval;
 }
 
 /**
  * @brief Evaluates and subtracts all other arguments after the first one and
- * returns a new NUMBER node. All arguments must evaluate to NUMBER nodes or a
- * syntax error is returned.
+ * returns a new number node, promoted to a BIGNUM on overflow and to a FLOAT
+ * once a float argument is met. All arguments must evaluate to NUMBER, BIGNUM
+ * or FLOAT nodes or a syntax error is returned.
  * @param list_node List node containing the operator
- * @param result_node out param pointer to the result NUMBER node with TEMPORARY
+ * @param result_node out param pointer to the result node with TEMPORARY
  * origin, NULL on failure
  * @param env The environment for variable lookup and evaluation
  * @return err_t
@@ -64,36 +79,35 @@ err_t oper_sub(astnode *list_node, astnode **result_node, env *env) {
   RETURN_ERR_IF(list_node->as.list.count < 3, ERR_SYNTAX_ERROR);
 
   err_t err, retval = ERR_NO_ERROR;
-  int i, sum = 0;
+  int i;
+  num_acc acc = {0};
 
   astnode *temp_node = NULL;
   for (i = 1; i < list_node->as.list.count; i++) {
     RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
 
     err = eval_node(list_node->as.list.children[i], &temp_node, env);
-    RETURN_ERR_IF(err, err);
-    CLEANUP_WITH_ERR_IF(temp_node->type != NUMBER, fail_cleanup,
-                        ERR_SYNTAX_ERROR);
-    sum += (i == 1 ? temp_node->as.value : -temp_node->as.value);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    err = number_apply(i == 1 ? INT_ADD : INT_SUB, &acc, temp_node);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
     free_temp_node_parts(temp_node);
+    temp_node = NULL;
   }
 
-  *result_node = get_number_node(sum);
-  RETURN_ERR_IF(!*result_node, ERR_OUT_OF_MEMORY);
-  (*result_node)->origin = TEMPORARY;
-
-  return ERR_NO_ERROR;
+  return get_acc_node(&acc, result_node);
 fail_cleanup:
+  bignum_free(acc.big);
   free_temp_node_parts(temp_node);
   return retval;
 }
 
 /**
  * @brief Evaluates and multiplies the arguments with eachother and returns a
- * new NUMBER node. All arguments must evaluate to NUMBER nodes or a syntax
- * error is returned.
+ * new number node, promoted to a BIGNUM on overflow and to a FLOAT once a
+ * float argument is met. All arguments must evaluate to NUMBER, BIGNUM or
+ * FLOAT nodes or a syntax error is returned.
  * @param list_node List node containing the operator
- * @param result_node out param pointer to the result NUMBER node with TEMPORARY
+ * @param result_node out param pointer to the result node with TEMPORARY
  * origin, NULL on failure
  * @param env The environment for variable lookup and evaluation
  * @return err_t
@@ -105,36 +119,36 @@ err_t oper_mul(astnode *list_node, astnode **result_node, env *env) {
   RETURN_ERR_IF(list_node->as.list.count < 3, ERR_SYNTAX_ERROR);
 
   err_t err, retval = ERR_NO_ERROR;
-  int i, prod = 1;
+  int i;
+  num_acc acc = {.fix = 1};
 
   astnode *temp_node = NULL;
   for (i = 1; i < list_node->as.list.count; i++) {
     RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
 
     err = eval_node(list_node->as.list.children[i], &temp_node, env);
-    RETURN_ERR_IF(err, err);
-    CLEANUP_WITH_ERR_IF(temp_node->type != NUMBER, fail_cleanup,
-                        ERR_SYNTAX_ERROR);
-    prod *= temp_node->as.value;
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    err = number_apply(INT_MUL, &acc, temp_node);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
     free_temp_node_parts(temp_node);
+    temp_node = NULL;
   }
 
-  *result_node = get_number_node(prod);
-  RETURN_ERR_IF(!*result_node, ERR_OUT_OF_MEMORY);
-  (*result_node)->origin = TEMPORARY;
-
-  return ERR_NO_ERROR;
+  return get_acc_node(&acc, result_node);
 fail_cleanup:
+  bignum_free(acc.big);
   free_temp_node_parts(temp_node);
   return retval;
 }
 
 /**
  * @brief Evaluates and divides first by all other arguments and returns a new
- * NUMBER node. All arguments must evaluate to NUMBER nodes or a syntax error is
- * returned.
+ * number node. Integers are divided truncating, once a float argument is met
+ * the division is a true division with a FLOAT result, so (/ 7 2 2.0) is 1.5.
+ * All arguments must evaluate to NUMBER, BIGNUM or FLOAT nodes or a syntax
+ * error is returned.
  * @param list_node List node containing the operator
- * @param result_node out param pointer to the result NUMBER node with TEMPORARY
+ * @param result_node out param pointer to the result node with TEMPORARY
  * origin, NULL on failure
  * @param env The environment for variable lookup and evaluation
  * @return err_t
@@ -146,35 +160,74 @@ err_t oper_div(astnode *list_node, astnode **result_node, env *env) {
   RETURN_ERR_IF(list_node->as.list.count < 3, ERR_SYNTAX_ERROR);
 
   err_t err, retval = ERR_NO_ERROR;
-  int i, res = 0;
+  int i;
+  num_acc acc = {0};
 
   astnode *temp_node = NULL;
   for (i = 1; i < list_node->as.list.count; i++) {
     RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
 
     err = eval_node(list_node->as.list.children[i], &temp_node, env);
-    RETURN_ERR_IF(err, err);
-    CLEANUP_WITH_ERR_IF(temp_node->type != NUMBER, fail_cleanup,
-                        ERR_SYNTAX_ERROR);
-    CLEANUP_WITH_ERR_IF(i != 1 && temp_node->as.value == 0, fail_cleanup,
-                        ERR_ZERO_DIVISON);
-    res = (i == 1 ? temp_node->as.value : res / temp_node->as.value);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    err = number_apply(i == 1 ? INT_ADD : INT_DIV, &acc, temp_node);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
     free_temp_node_parts(temp_node);
+    temp_node = NULL;
   }
 
-  *result_node = get_number_node(res);
-  RETURN_ERR_IF(!*result_node, ERR_OUT_OF_MEMORY);
-  (*result_node)->origin = TEMPORARY;
-
-  return ERR_NO_ERROR;
+  return get_acc_node(&acc, result_node);
 fail_cleanup:
+  bignum_free(acc.big);
   free_temp_node_parts(temp_node);
   return retval;
 }
 
+/**
+ * @brief Adds or subtracts the value to a number variable in place. An integer
+ * variable becomes a BIGNUM when the result leaves the 64-bit range and a
+ * NUMBER again once it fits, it becomes a FLOAT when the value is a float.
+ *
+ * @param var_node NUMBER, BIGNUM or FLOAT variable node
+ * @param op INT_ADD or INT_SUB
+ * @param value_node NUMBER, BIGNUM or FLOAT node
+ * @return err_t
+ */
+static err_t update_number_var(astnode *var_node, enum int_op op,
+                               const astnode *value_node) {
+  err_t err;
+  num_acc acc = {0};
+
+  if (var_node->type == FLOAT) {
+    acc.is_float = 1;
+    acc.real = var_node->as.real;
+  } else if (var_node->type == BIGNUM) {
+    acc.big = var_node->as.big;
+  } else {
+    acc.fix = var_node->as.value;
+  }
+
+  /* on success the previous bignum of the variable has been freed */
+  err = number_apply(op, &acc, value_node);
+  RETURN_ERR_IF(err, err);
+
+  if (acc.is_float) {
+    var_node->type = FLOAT;
+    var_node->as.real = acc.real;
+  } else if (acc.big) {
+    var_node->type = BIGNUM;
+    var_node->as.big = acc.big;
+  } else {
+    var_node->type = NUMBER;
+    var_node->as.value = acc.fix;
+  }
+  return ERR_NO_ERROR;
+}
+
 /**
  * @brief Increments a variable by a value and returns the updated variable
- * node. The first argument must be a variable node, the second a NUMBER node.
+ * node. The first argument must be a number variable node, the second a
+ * number node. An integer variable turns into a BIGNUM when it leaves 64 bits
+ * and into a FLOAT when the value is a float.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the updated variable node, NULL on
  * failure
@@ -196,13 +249,14 @@ err_t oper_inc(astnode *list_node, astnode **result_node, env *env) {
   RETURN_ERR_IF(err, err);
   CLEANUP_WITH_ERR_IF(var_node->origin != VARIABLE, cleanup,
                       ERR_NOT_A_VARIABLE);
-  CLEANUP_WITH_ERR_IF(var_node->type != NUMBER, cleanup, ERR_SYNTAX_ERROR);
+  CLEANUP_WITH_ERR_IF(!is_numeric(var_node), cleanup, ERR_SYNTAX_ERROR);
 
   err = eval_node(list_node->as.list.children[2], &value_node, env);
   RETURN_ERR_IF(err, err);
-  CLEANUP_WITH_ERR_IF(value_node->type != NUMBER, cleanup, err);
+  CLEANUP_WITH_ERR_IF(!is_numeric(value_node), cleanup, ERR_SYNTAX_ERROR);
 
-  var_node->as.value += value_node->as.value;
+  err = update_number_var(var_node, INT_ADD, value_node);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
   *result_node = var_node;
 
   retval = ERR_NO_ERROR;
@@ -215,7 +269,9 @@ cleanup:
 
 /**
  * @brief Decrements a variable by a value and returns the updated variable
- * node. The first argument must be a variable node, the second a NUMBER node.
+ * node. The first argument must be a number variable node, the second a
+ * number node. An integer variable turns into a BIGNUM when it leaves 64 bits
+ * and into a FLOAT when the value is a float.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the updated variable node, NULL on
  * failure
@@ -237,13 +293,14 @@ err_t oper_dec(astnode *list_node, astnode **result_node, env *env) {
   RETURN_ERR_IF(err, err);
   CLEANUP_WITH_ERR_IF(var_node->origin != VARIABLE, cleanup,
                       ERR_NOT_A_VARIABLE);
-  CLEANUP_WITH_ERR_IF(var_node->type != NUMBER, cleanup, ERR_SYNTAX_ERROR);
+  CLEANUP_WITH_ERR_IF(!is_numeric(var_node), cleanup, ERR_SYNTAX_ERROR);
 
   err = eval_node(list_node->as.list.children[2], &value_node, env);
   RETURN_ERR_IF(err, err);
-  CLEANUP_WITH_ERR_IF(value_node->type != NUMBER, cleanup, err);
+  CLEANUP_WITH_ERR_IF(!is_numeric(value_node), cleanup, ERR_SYNTAX_ERROR);
 
-  var_node->as.value -= value_node->as.value;
+  err = update_number_var(var_node, INT_SUB, value_node);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
   *result_node = var_node;
 
   retval = ERR_NO_ERROR;
@@ -254,9 +311,35 @@ cleanup:
   return retval;
 }
 
+/**
+ * @brief Keeps the value of an evaluated numeric argument while the arguments
+ * after it are evaluated, they may change or free the variable or list item
+ * it came from. Integers and floats are copied into the slot, bignums into a
+ * new temporary node, temporary arguments are owned already and kept.
+ * @param node in/out pointer to the argument, to its snapshot on return
+ * @param slot storage for the snapshot of an integer or float
+ * @return err_t
+ */
+static err_t hold_number(astnode **node, astnode *slot) {
+  astnode *copy = NULL;
+  err_t err;
+
+  RETURN_VAL_IF((*node)->origin == TEMPORARY, ERR_NO_ERROR);
+  if ((*node)->type != BIGNUM) {
+    *slot = **node;
+    *node = slot;
+    return ERR_NO_ERROR;
+  }
+  err = make_deep_copy(*node, &copy, TEMPORARY);
+  RETURN_ERR_IF(err, err);
+  *node = copy;
+  return ERR_NO_ERROR;
+}
+
 /**
  * @brief Checks if all arguments are equal and returns a BOOLEAN node.
- * All arguments must evaluate to NUMBER nodes or a syntax error is returned.
+ * All arguments must evaluate to NUMBER, BIGNUM or FLOAT nodes or a syntax
+ * error is returned, integers and floats are compared by value.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the result BOOLEAN node, NULL on
  * failure
@@ -272,39 +355,42 @@ err_t oper_eql(astnode *list_node, astnode **result_node, env *env) {
     RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
 
   err_t err, retval = ERR_NO_ERROR;
-  int ref_val, all_equal = 1;
-  astnode *temp;
+  int all_equal = 1;
+  astnode *ref = NULL, *temp = NULL, ref_slot;
 
-  err = eval_node(list_node->as.list.children[1], &temp, env);
+  err = eval_node(list_node->as.list.children[1], &ref, env);
   RETURN_ERR_IF(err, err);
-  CLEANUP_WITH_ERR_IF(temp->type != NUMBER, fail_cleanup, ERR_SYNTAX_ERROR);
-  ref_val = temp->as.value;
-  free_temp_node_parts(temp);
+  CLEANUP_WITH_ERR_IF(!is_numeric(ref), cleanup, ERR_SYNTAX_ERROR);
+  err = hold_number(&ref, &ref_slot);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
 
   for (int i = 2; i < list_node->as.list.count; i++) {
     err = eval_node(list_node->as.list.children[i], &temp, env);
-    RETURN_ERR_IF(err, err);
-    CLEANUP_WITH_ERR_IF(temp->type != NUMBER, fail_cleanup, ERR_SYNTAX_ERROR);
-    if (ref_val != temp->as.value) {
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    CLEANUP_WITH_ERR_IF(!is_numeric(temp), cleanup, ERR_SYNTAX_ERROR);
+    if (compare_numbers(ref, temp)) {
       all_equal = 0;
       break;
     }
     free_temp_node_parts(temp);
+    temp = NULL;
   }
 
   *result_node = get_bool_node(all_equal);
-  RETURN_ERR_IF(!*result_node, ERR_OUT_OF_MEMORY);
+  CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
   (*result_node)->origin = TEMPORARY;
 
-  return retval;
-fail_cleanup:
+cleanup:
+  free_temp_node_parts(ref);
   free_temp_node_parts(temp);
   return retval;
-};
+}
 
 /**
  * @brief Checks if all arguments are non-equal and returns a BOOLEAN node.
- * All arguments must evaluate to NUMBER nodes or a syntax error is returned.
+ * All arguments must evaluate to NUMBER, BIGNUM or FLOAT nodes or a syntax
+ * error is returned, integers and floats are compared by value. Many
+ * arguments are checked through a hash index in linear time.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the result BOOLEAN node, NULL on
  * failure
@@ -320,40 +406,39 @@ err_t oper_noneql(astnode *list_node, astnode **result_node, env *env) {
     RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
 
   err_t err, retval = ERR_NO_ERROR;
-  int all_non_equal = 1;
-  int *values = malloc(sizeof(int) * list_node->as.list.count);
+  int duplicate = 0, evaluated = 0;
+  astnode **values = malloc(sizeof(astnode *) * list_node->as.list.count);
+  astnode *slots = malloc(sizeof(astnode) * list_node->as.list.count);
   astnode *temp;
+  CLEANUP_WITH_ERR_IF(!values || !slots, cleanup, ERR_OUT_OF_MEMORY);
 
   for (int i = 1; i < list_node->as.list.count; i++) {
     err = eval_node(list_node->as.list.children[i], &temp, env);
-    RETURN_ERR_IF(err, err);
-    CLEANUP_WITH_ERR_IF(temp->type != NUMBER, fail_cleanup, ERR_SYNTAX_ERROR);
-    for (int j = 0; j < (i - 1); j++) {
-      if (values[j] == temp->as.value) {
-        all_non_equal = 0;
-        break;
-      }
-    }
-    values[i - 1] = temp->as.value;
-    free_temp_node_parts(temp);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    values[evaluated++] = temp;
+    CLEANUP_WITH_ERR_IF(!is_numeric(temp), cleanup, ERR_SYNTAX_ERROR);
+    err = hold_number(&values[evaluated - 1], &slots[i]);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
   }
-  free(values);
+  err = has_duplicates(values, evaluated, &duplicate);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
 
-  *result_node = get_bool_node(all_non_equal);
-  RETURN_ERR_IF(!*result_node, ERR_OUT_OF_MEMORY);
+  *result_node = get_bool_node(!duplicate);
+  CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
   (*result_node)->origin = TEMPORARY;
 
-  return retval;
-fail_cleanup:
+cleanup:
+  for (int i = 0; i < evaluated; i++)
+    free_temp_node_parts(values[i]);
   free(values);
-  free_temp_node_parts(temp);
+  free(slots);
   return retval;
-};
+}
 
 /**
  * @brief Compares arguments according to the relational operator (<, >, <=, >=)
- * and returns a BOOLEAN node. All arguments must evaluate to NUMBER nodes or a
- * syntax error is returned.
+ * and returns a BOOLEAN node. All arguments must evaluate to NUMBER, BIGNUM or
+ * FLOAT nodes or a syntax error is returned.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the result BOOLEAN node, NULL on
  * failure
@@ -369,61 +454,59 @@ err_t oper_grt_lwr(astnode *list_node, astnode **result_node, env *env) {
     RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
 
   err_t err, retval = ERR_NO_ERROR;
-  int all_true = 1, prev_val;
-  astnode *temp;
+  int all_true = 1, cmp, holds;
+  const char *oper = list_node->as.list.children[0]->as.symbol;
+  astnode *prev = NULL, *temp = NULL, slots[2];
 
   for (int i = 1; i < list_node->as.list.count; i++) {
     err = eval_node(list_node->as.list.children[i], &temp, env);
-    RETURN_ERR_IF(err, err);
-    CLEANUP_WITH_ERR_IF(temp->type != NUMBER, fail_cleanup, ERR_SYNTAX_ERROR);
-    if (i == 1)
-      prev_val = temp->as.value;
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    CLEANUP_WITH_ERR_IF(!is_numeric(temp), cleanup, ERR_SYNTAX_ERROR);
+    /* the previous argument may sit in the other slot */
+    err = hold_number(&temp, &slots[i % 2]);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
 
-    if (!strcmp(list_node->as.list.children[0]->as.symbol, "<")) {
-      if (!(prev_val < temp->as.value) && i != 1) {
-        all_true = 0;
-        break;
+    if (i != 1) {
+      cmp = compare_numbers(prev, temp);
+      if (!strcmp(oper, "<"))
+        holds = cmp < 0;
+      else if (!strcmp(oper, ">"))
+        holds = cmp > 0;
+      else if (!strcmp(oper, ">="))
+        holds = cmp >= 0;
+      else if (!strcmp(oper, "<="))
+        holds = cmp <= 0;
+      else {
+        retval = ERR_INTERNAL;
+        goto cleanup;
       }
-    } else if (!strcmp(list_node->as.list.children[0]->as.symbol, ">")) {
-      if (!(prev_val > temp->as.value) && i != 1) {
+      if (!holds) {
         all_true = 0;
         break;
       }
-    } else if (!strcmp(list_node->as.list.children[0]->as.symbol, ">=")) {
-      if (!(prev_val >= temp->as.value)) {
-        all_true = 0;
-        break;
-      }
-    } else if (!strcmp(list_node->as.list.children[0]->as.symbol, "<=")) {
-      if (!(prev_val <= temp->as.value)) {
-        all_true = 0;
-        break;
-      }
-    } else {
-      retval = ERR_INTERNAL;
-      goto fail_cleanup;
     }
-    prev_val = temp->as.value;
-    free_temp_node_parts(temp);
+    free_temp_node_parts(prev);
+    prev = temp;
+    temp = NULL;
   }
 
   *result_node = get_bool_node(all_true);
-  RETURN_ERR_IF(!*result_node, ERR_OUT_OF_MEMORY);
+  CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
   (*result_node)->origin = TEMPORARY;
 
-  return retval;
-fail_cleanup:
+cleanup:
+  free_temp_node_parts(prev);
   free_temp_node_parts(temp);
   return retval;
-};
+}
 
 /**
- * @brief Returns the minimum or maximum value among the arguments as a NUMBER
- * node. All arguments must evaluate to NUMBER nodes or a syntax error is
- * returned.
+ * @brief Returns the minimum or maximum value among the arguments as a new
+ * node of the same type. All arguments must evaluate to NUMBER, BIGNUM or
+ * FLOAT nodes or a syntax error is returned.
  * @param list_node List node containing the operator
- * @param result_node out param pointer to the result NUMBER node, NULL on
- * failure
+ * @param result_node out param pointer to the result node with TEMPORARY
+ * origin, NULL on failure
  * @param env The environment for variable lookup and evaluation
  * @return err_t
  */
@@ -435,42 +518,76 @@ err_t oper_min_max(astnode *list_node, astnode **result_node, env *env) {
   for (int i = 0; i < list_node->as.list.count; i++)
     RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
 
+  const char *oper = list_node->as.list.children[0]->as.symbol;
+  int is_min = !strcmp(oper, "MIN");
+  RETURN_ERR_IF(!is_min && strcmp(oper, "MAX"), ERR_INTERNAL);
+
   err_t err, retval = ERR_NO_ERROR;
-  int min_max_value;
-  astnode *temp;
+  int cmp;
+  astnode *best = NULL, *temp = NULL, slots[2];
 
   for (int i = 1; i < list_node->as.list.count; i++) {
     err = eval_node(list_node->as.list.children[i], &temp, env);
-    RETURN_ERR_IF(err, err);
-    CLEANUP_WITH_ERR_IF(temp->type != NUMBER, fail_cleanup, ERR_SYNTAX_ERROR);
-    if (i == 1)
-      min_max_value = temp->as.value;
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    CLEANUP_WITH_ERR_IF(!is_numeric(temp), cleanup, ERR_SYNTAX_ERROR);
+    /* the best argument so far may sit in one of the slots */
+    err = hold_number(&temp, best == &slots[0] ? &slots[1] : &slots[0]);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
 
-    if (!strcmp(list_node->as.list.children[0]->as.symbol, "MIN")) {
-      if (temp->as.value < min_max_value && i != 1) {
-        min_max_value = temp->as.value;
-      }
-    } else if (!strcmp(list_node->as.list.children[0]->as.symbol, "MAX")) {
-      if (temp->as.value > min_max_value && i != 1) {
-        min_max_value = temp->as.value;
-      }
+    cmp = best ? compare_numbers(temp, best) : 0;
+    if (!best || (is_min ? cmp < 0 : cmp > 0)) {
+      free_temp_node_parts(best);
+      best = temp;
     } else {
-      retval = ERR_INTERNAL;
-      goto fail_cleanup;
+      free_temp_node_parts(temp);
     }
-
-    free_temp_node_parts(temp);
+    temp = NULL;
   }
 
-  *result_node = get_number_node(min_max_value);
-  RETURN_ERR_IF(!*result_node, ERR_OUT_OF_MEMORY);
-  (*result_node)->origin = TEMPORARY;
+  /* a variable or literal is copied, a temporary result is passed on */
+  if (best->origin == TEMPORARY) {
+    *result_node = best;
+    return ERR_NO_ERROR;
+  }
+  err = make_deep_copy(best, result_node, TEMPORARY);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
 
-  return retval;
-fail_cleanup:
+cleanup:
+  free_temp_node_parts(best);
   free_temp_node_parts(temp);
   return retval;
-};
+}
+
+/**
+ * @brief Ranges have no element nodes, so a range variable assigned through
+ * (set (nth i var) value) or (set (car var) value) is turned into a list
+ * first
+ *
+ * @param target first argument of SET
+ * @param env The environment for variable lookup
+ * @return err_t
+ */
+static err_t materialize_place(astnode *target, env *env) {
+  astnode *seq_arg, *var;
+  const char *oper;
+
+  RETURN_VAL_IF(target->type != LIST || target->as.list.count < 2,
+                ERR_NO_ERROR);
+  RETURN_VAL_IF(target->as.list.children[0]->type != SYMBOL, ERR_NO_ERROR);
+
+  oper = target->as.list.children[0]->as.symbol;
+  if (!strcmp(oper, "NTH") && target->as.list.count == 3)
+    seq_arg = target->as.list.children[2];
+  else if (!strcmp(oper, "CAR") && target->as.list.count == 2)
+    seq_arg = target->as.list.children[1];
+  else
+    return ERR_NO_ERROR;
+
+  RETURN_VAL_IF(seq_arg->type != SYMBOL, ERR_NO_ERROR);
+  var = get_var(seq_arg->as.symbol, env);
+  RETURN_VAL_IF(!var || var->type != RANGE, ERR_NO_ERROR);
+  return materialize_range(var);
+}
 
 /**
  * @brief Sets a variable to a value and returns the updated variable node.
@@ -493,8 +610,26 @@ err_t oper_set(astnode *list_node, astnode **result_node, env *env) {
 
   err_t err, retval = ERR_NO_ERROR;
   astnode *var_node = NULL, *value_node = NULL, *value_node_copy = NULL;
+  astnode *target = list_node->as.list.children[1];
+
+  /* vector elements are plain integers, not variable nodes */
+  if (target->type == LIST && target->as.list.count &&
+      target->as.list.children[0]->type == SYMBOL &&
+      !strcmp(target->as.list.children[0]->as.symbol, "AREF"))
+    return oper_set_aref(list_node, result_node, env);
+  if (target->type == LIST && target->as.list.count &&
+      target->as.list.children[0]->type == SYMBOL &&
+      !strcmp(target->as.list.children[0]->as.symbol, "MREF"))
+    return oper_set_mref(list_node, result_node, env);
+  if (target->type == LIST && target->as.list.count &&
+      target->as.list.children[0]->type == SYMBOL &&
+      !strcmp(target->as.list.children[0]->as.symbol, "GETHASH"))
+    return oper_set_gethash(list_node, result_node, env);
+
+  err = materialize_place(target, env);
+  RETURN_ERR_IF(err, err);
 
-  err = eval_node(list_node->as.list.children[1], &var_node, env);
+  err = eval_node(target, &var_node, env);
   RETURN_ERR_IF(err, err);
 
   if (var_node->type == SYMBOL) {
@@ -517,19 +652,36 @@ err_t oper_set(astnode *list_node, astnode **result_node, env *env) {
   CLEANUP_WITH_ERR_IF(err, cleanup, err);
   CLEANUP_WITH_ERR_IF(value_node->type == SYMBOL, cleanup, ERR_SYNTAX_ERROR);
 
+  /* assigning a view of the variable itself, like (set 'l (cdr l)), only
+   * moves the window of the variable list instead of copying it */
+  if (is_view_of(value_node, var_node)) {
+    int skip = value_node->as.list.children - var_node->as.list.children;
+    for (int i = 0; i < var_node->as.list.count; i++) {
+      if (i < skip || i >= skip + value_node->as.list.count)
+        free_node(var_node->as.list.children[i]);
+    }
+    var_node->as.list.children = value_node->as.list.children;
+    var_node->as.list.count = value_node->as.list.count;
+    *result_node = var_node;
+    goto cleanup;
+  }
+
   /* make node copy with VARIABLE origin */
   err = make_deep_copy(value_node, &value_node_copy, VARIABLE);
   CLEANUP_WITH_ERR_IF(err, cleanup, err);
 
-  /* free the previous variable content */
-  free_node_content(var_node);
+  /* free the previous variable content, a view may still borrow a list */
+  err = free_var_content(var_node);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
   /* copy the entire structure */
   *var_node = *value_node_copy;
   /* return reference to the new variable */
   *result_node = var_node;
 
-  free(value_node_copy);
+  free_node_shell(value_node_copy);
+  value_node_copy = NULL;
 cleanup:
+  free_node(value_node_copy);
   free_temp_node_parts(var_node);
   free_temp_node_parts(value_node);
   return retval;
@@ -614,7 +766,7 @@ err_t oper_atom(astnode *list_node, astnode **result_node, env *env) {
   err = eval_node(list_node->as.list.children[1], &temp, env);
   RETURN_ERR_IF(err, err);
 
-  is_atomic = (temp->type != LIST);
+  is_atomic = (temp->type != LIST && temp->type != RANGE);
   free_temp_node_parts(temp);
 
   *result_node = get_bool_node(is_atomic);
@@ -624,7 +776,8 @@ err_t oper_atom(astnode *list_node, astnode **result_node, env *env) {
 }
 
 /**
- * @brief Returns the first element of a list argument.
+ * @brief Returns the first element of a list argument, a new NUMBER node for
+ * a range argument.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the CAR node, NULL on failure
  * @param env The environment for variable lookup and evaluation
@@ -643,6 +796,18 @@ err_t oper_car(astnode *list_node, astnode **result_node, env *env) {
 
   err = eval_node(list_node->as.list.children[1], &temp, env);
   RETURN_ERR_IF(err, err);
+
+  /* range elements are not nodes, return a new number */
+  if (temp->type == RANGE) {
+    CLEANUP_WITH_ERR_IF(temp->as.range.count < 1, fail_cleanup,
+                        ERR_SYNTAX_ERROR);
+    *result_node = get_number_node(temp->as.range.start);
+    CLEANUP_WITH_ERR_IF(!*result_node, fail_cleanup, ERR_OUT_OF_MEMORY);
+    (*result_node)->origin = TEMPORARY;
+    free_temp_node_parts(temp);
+    return ERR_NO_ERROR;
+  }
+
   CLEANUP_WITH_ERR_IF(temp->type != LIST || temp->as.list.count < 1,
                       fail_cleanup, ERR_SYNTAX_ERROR);
   CLEANUP_WITH_ERR_IF(!temp->as.list.children[0], fail_cleanup, ERR_INTERNAL);
@@ -667,6 +832,8 @@ fail_cleanup:
 
 /**
  * @brief Returns the rest of the list after the first element as a list node.
+ * The result is a view into the argument list, no children are copied, or a
+ * shorter range for a range argument.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the CDR list node, NULL on failure
  * @param env The environment for variable lookup and evaluation
@@ -681,37 +848,87 @@ err_t oper_cdr(astnode *list_node, astnode **result_node, env *env) {
     RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
 
   err_t retval = ERR_NO_ERROR, err;
-  astnode *new_list = get_list_node(), *arg_node = NULL;
-  RETURN_ERR_IF(!new_list, ERR_OUT_OF_MEMORY);
-  new_list->origin = TEMPORARY;
+  astnode *arg_node = NULL;
 
   err = eval_node(list_node->as.list.children[1], &arg_node, env);
-  CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+  RETURN_ERR_IF(err, err);
+
+  if (arg_node->type == RANGE) {
+    CLEANUP_WITH_ERR_IF(arg_node->as.range.count < 2, fail_cleanup,
+                        ERR_SYNTAX_ERROR);
+    err = get_range_tail(arg_node, 1, result_node);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    return retval;
+  }
+
   CLEANUP_WITH_ERR_IF(arg_node->type != LIST || arg_node->as.list.count < 2,
                       fail_cleanup, ERR_SYNTAX_ERROR);
-  for (int i = 1; i < arg_node->as.list.count; i++) {
-    err = add_child_node(new_list, arg_node->as.list.children[i]);
+
+  err = get_list_view(arg_node, 1, result_node);
+  CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+
+  return retval;
+fail_cleanup:
+  free_temp_node_parts(arg_node);
+  return retval;
+}
+
+/**
+ * @brief Returns the list without its first n elements as a list node.
+ * The result is a view into the argument list, no children are copied, or a
+ * shorter range for a range argument.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result list node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_nthcdr(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  int64_t nth;
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *temp = NULL;
+
+  err = eval_node(list_node->as.list.children[1], &temp, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(temp->type != NUMBER, fail_cleanup, ERR_SYNTAX_ERROR);
+
+  nth = temp->as.value;
+  free_temp_node_parts(temp);
+
+  err = eval_node(list_node->as.list.children[2], &temp, env);
+  RETURN_ERR_IF(err, err);
+
+  if (temp->type == RANGE) {
+    CLEANUP_WITH_ERR_IF(nth < 0 || nth >= temp->as.range.count, fail_cleanup,
+                        ERR_SYNTAX_ERROR);
+    err = get_range_tail(temp, (int)nth, result_node);
     CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    return retval;
   }
 
-  *result_node = new_list;
+  CLEANUP_WITH_ERR_IF(temp->type != LIST || nth < 0 ||
+                          nth >= temp->as.list.count,
+                      fail_cleanup, ERR_SYNTAX_ERROR);
 
-  /* the first item of the argument list would leak if its temporary */
-  free_temp_node_parts(arg_node->as.list.children[0]);
-  if (arg_node->origin == TEMPORARY) {
-    free(arg_node->as.list.children);
-    free(arg_node);
-  }
+  err = get_list_view(temp, (int)nth, result_node);
+  CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
 
   return retval;
 fail_cleanup:
-  free_temp_node_parts(arg_node);
-  free_temp_node_parts(new_list);
+  free_temp_node_parts(temp);
   return retval;
 }
 
 /**
  * @brief Returns the nth element of a list argument without evaluating it.
+ * For a vector or range argument a new NUMBER node with the element value is
+ * returned.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the nth node, NULL on failure
  * @param env The environment for variable lookup and evaluation
@@ -725,7 +942,7 @@ err_t oper_nth(astnode *list_node, astnode **result_node, env *env) {
   for (int i = 0; i < list_node->as.list.count; i++)
     RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
 
-  int nth;
+  int64_t nth;
   err_t err, retval = ERR_NO_ERROR;
   astnode *temp = NULL;
 
@@ -738,7 +955,24 @@ err_t oper_nth(astnode *list_node, astnode **result_node, env *env) {
 
   err = eval_node(list_node->as.list.children[2], &temp, env);
   RETURN_ERR_IF(err, err);
-  CLEANUP_WITH_ERR_IF(temp->type != LIST || nth >= temp->as.list.count,
+
+  /* vector and range elements are not nodes, return a new number */
+  if (temp->type == VECTOR || temp->type == RANGE) {
+    CLEANUP_WITH_ERR_IF(nth < 0 || nth >= (temp->type == VECTOR
+                                               ? temp->as.vector.count
+                                               : temp->as.range.count),
+                        fail_cleanup, ERR_SYNTAX_ERROR);
+    *result_node = temp->type == VECTOR
+                       ? vector_get_node(temp, (int)nth)
+                       : get_number_node(range_get(temp, (int)nth));
+    CLEANUP_WITH_ERR_IF(!*result_node, fail_cleanup, ERR_OUT_OF_MEMORY);
+    (*result_node)->origin = TEMPORARY;
+    free_temp_node_parts(temp);
+    return ERR_NO_ERROR;
+  }
+
+  CLEANUP_WITH_ERR_IF(temp->type != LIST || nth < 0 ||
+                          nth >= temp->as.list.count,
                       fail_cleanup, ERR_SYNTAX_ERROR);
   CLEANUP_WITH_ERR_IF(!temp->as.list.children[nth], fail_cleanup, ERR_INTERNAL);
 
@@ -762,7 +996,8 @@ fail_cleanup:
 }
 
 /**
- * @brief Returns the length of a list argument as a NUMBER node.
+ * @brief Returns the length of a list, vector or range argument, or the count
+ * of entries of a hash table, as a NUMBER node.
  * @param list_node List node containing the operator
  * @param result_node out param pointer to the result NUMBER node, NULL on
  * failure
@@ -783,10 +1018,20 @@ err_t oper_len(astnode *list_node, astnode **result_node, env *env) {
 
   err = eval_node(list_node->as.list.children[1], &temp, env);
   RETURN_ERR_IF(err, err);
-  CLEANUP_WITH_ERR_IF(temp->type != LIST, cleanup, ERR_SYNTAX_ERROR);
-
-  len = temp->as.list.count;
+  CLEANUP_WITH_ERR_IF(temp->type != LIST && temp->type != VECTOR &&
+                          temp->type != HASH && temp->type != RANGE,
+                      cleanup, ERR_SYNTAX_ERROR);
+
+  if (temp->type == HASH)
+    len = temp->as.hash->count;
+  else if (temp->type == RANGE)
+    len = temp->as.range.count;
+  else if (temp->type == VECTOR)
+    len = temp->as.vector.count;
+  else
+    len = temp->as.list.count;
   free_temp_node_parts(temp);
+  temp = NULL;
 
   *result_node = get_number_node(len);
   CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
@@ -797,6 +1042,208 @@ cleanup:
   return retval;
 }
 
+/**
+ * @brief Evaluates the target of PUSH, APPEND! and RESERVE, which has to be a
+ * variable holding a list. A variable holding NIL becomes an empty list and a
+ * range is turned into the list of its elements.
+ *
+ * @param target node to evaluate
+ * @param var_node out param, the variable LIST node
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t eval_list_variable(astnode *target, astnode **var_node,
+                                env *env) {
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *temp = NULL;
+
+  err = eval_node(target, &temp, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(temp->origin != VARIABLE, fail_cleanup,
+                      ERR_NOT_A_VARIABLE);
+
+  if (temp->type == BOOLEAN && !temp->as.value) {
+    temp->type = LIST;
+    memset(&temp->as, 0, sizeof(temp->as));
+  }
+  if (temp->type == RANGE) {
+    err = materialize_range(temp);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+  }
+  CLEANUP_WITH_ERR_IF(temp->type != LIST, fail_cleanup, ERR_SYNTAX_ERROR);
+
+  *var_node = temp;
+  return retval;
+fail_cleanup:
+  free_temp_node_parts(temp);
+  return retval;
+}
+
+/**
+ * @brief Appends the evaluated arguments to the end of a list held by a
+ * variable, (push list item...). The list grows in place in amortized
+ * constant time, returns the variable.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the variable LIST node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_push(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *var_node = NULL, *value_node = NULL, *value_node_copy = NULL;
+
+  err = eval_list_variable(list_node->as.list.children[1], &var_node, env);
+  RETURN_ERR_IF(err, err);
+
+  for (int i = 2; i < list_node->as.list.count; i++) {
+    err = eval_node(list_node->as.list.children[i], &value_node, env);
+    RETURN_ERR_IF(err, err);
+    CLEANUP_WITH_ERR_IF(value_node->type == SYMBOL, cleanup, ERR_SYNTAX_ERROR);
+
+    /* make node copy with VARIABLE origin */
+    err = make_deep_copy(value_node, &value_node_copy, VARIABLE);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    err = add_child_node(var_node, value_node_copy);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    value_node_copy = NULL;
+
+    free_temp_node_parts(value_node);
+    value_node = NULL;
+  }
+  *result_node = var_node;
+
+cleanup:
+  free_node(value_node_copy);
+  free_temp_node_parts(value_node);
+  return retval;
+}
+
+/**
+ * @brief Appends all items of the second list argument to the end of a list
+ * held by a variable, (append! list other). Returns the variable.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the variable LIST node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_append_in_place(astnode *list_node, astnode **result_node,
+                           env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *var_node = NULL, *other = NULL, *item_copy = NULL;
+
+  err = eval_list_variable(list_node->as.list.children[1], &var_node, env);
+  RETURN_ERR_IF(err, err);
+
+  err = eval_node(list_node->as.list.children[2], &other, env);
+  RETURN_ERR_IF(err, err);
+  /* appending NIL appends nothing */
+  if (other->type == BOOLEAN && !other->as.value) {
+    *result_node = var_node;
+    goto cleanup;
+  }
+  CLEANUP_WITH_ERR_IF(other->type != LIST && other->type != RANGE, cleanup,
+                      ERR_SYNTAX_ERROR);
+
+  if (other->type == RANGE) {
+    err = reserve_children(var_node,
+                           var_node->as.list.count + other->as.range.count);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    for (int i = 0; i < other->as.range.count; i++) {
+      item_copy = get_number_node(range_get(other, i));
+      CLEANUP_WITH_ERR_IF(!item_copy, cleanup, ERR_OUT_OF_MEMORY);
+      item_copy->origin = VARIABLE;
+      err = add_child_node(var_node, item_copy);
+      CLEANUP_WITH_ERR_IF(err, cleanup, err);
+      item_copy = NULL;
+    }
+    *result_node = var_node;
+    goto cleanup;
+  }
+
+  /* growing the list would move the items of (append! l l) under our hands */
+  if (other == var_node || is_view_of(other, var_node)) {
+    err = make_deep_copy(other, &item_copy, TEMPORARY);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    free_temp_node_parts(other);
+    other = item_copy;
+    item_copy = NULL;
+  }
+
+  err = reserve_children(var_node,
+                         var_node->as.list.count + other->as.list.count);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+  for (int i = 0; i < other->as.list.count; i++) {
+    err = make_deep_copy(other->as.list.children[i], &item_copy, VARIABLE);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    err = add_child_node(var_node, item_copy);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    item_copy = NULL;
+  }
+  *result_node = var_node;
+
+cleanup:
+  free_node(item_copy);
+  free_temp_node_parts(other);
+  return retval;
+}
+
+/**
+ * @brief Preallocates room for n items in a list held by a variable, so that
+ * pushing up to n items does not reallocate, (reserve list n). Returns the
+ * variable.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the variable LIST node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_reserve(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  int needed;
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *var_node = NULL, *temp = NULL;
+
+  err = eval_node(list_node->as.list.children[2], &temp, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(temp->type != NUMBER || temp->as.value < 0 ||
+                          temp->as.value > INT_MAX,
+                      cleanup, ERR_SYNTAX_ERROR);
+  needed = (int)temp->as.value;
+
+  err = eval_list_variable(list_node->as.list.children[1], &var_node, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  err = reserve_children(var_node, needed);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  *result_node = var_node;
+
+cleanup:
+  free_temp_node_parts(temp);
+  return retval;
+}
+
 /**
  * @brief Evaluates a conditional expression and returns the result of the
  * true(3rd arg) or false branch(4th arg).
@@ -893,6 +1340,238 @@ fail_cleanup:
   return retval;
 }
 
+/**
+ * @brief Evaluates the loop body, the children of the list node from index
+ * first on, once
+ *
+ * @param list_node List node containing the operator
+ * @param first index of the first body form
+ * @param brk_stop out param, set to 1 when the body called BRK
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t eval_loop_body(astnode *list_node, int first, int *brk_stop,
+                            env *env) {
+  err_t err;
+  astnode *temp = NULL;
+
+  for (int i = first; i < list_node->as.list.count; i++) {
+    err = eval_node(list_node->as.list.children[i], &temp, env);
+    if (err == CONTROL_BREAK) {
+      *brk_stop = 1;
+      return ERR_NO_ERROR;
+    }
+    RETURN_ERR_IF(err, err);
+    free_temp_node_parts(temp);
+  }
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Parses the (var init [result]) header of DOTIMES and DOLIST and
+ * returns the loop variable node, creating the variable if needed
+ *
+ * @param header the first argument of the loop operator
+ * @param var_node out param, the variable node the loop binds
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t get_loop_var(astnode *header, astnode **var_node, env *env) {
+  err_t err;
+  astnode *symbol;
+
+  RETURN_ERR_IF(header->type != LIST || header->as.list.count < 2 ||
+                    header->as.list.count > 3,
+                ERR_SYNTAX_ERROR);
+  symbol = header->as.list.children[0];
+  RETURN_ERR_IF(symbol->type != SYMBOL, ERR_SYNTAX_ERROR);
+
+  if (!exists_var(symbol->as.symbol, env)) {
+    err = add_empty_var(symbol->as.symbol, env);
+    RETURN_ERR_IF(err, err);
+  }
+  *var_node = get_var(symbol->as.symbol, env);
+  RETURN_ERR_IF(!*var_node, ERR_INTERNAL);
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Stores a number into the loop variable in place, without allocating
+ *
+ * @param var_node variable node
+ * @param value to store
+ */
+static void bind_number(astnode *var_node, int64_t value) {
+  if (var_node->type != NUMBER) {
+    free_node_content(var_node);
+    memset(&var_node->as, 0, sizeof(var_node->as));
+    var_node->type = NUMBER;
+  }
+  var_node->as.value = value;
+}
+
+/**
+ * @brief Stores a float into the loop variable in place, without allocating
+ *
+ * @param var_node variable node
+ * @param real to store
+ */
+static void bind_real(astnode *var_node, double real) {
+  if (var_node->type != FLOAT) {
+    free_node_content(var_node);
+    memset(&var_node->as, 0, sizeof(var_node->as));
+    var_node->type = FLOAT;
+  }
+  var_node->as.real = real;
+}
+
+/**
+ * @brief Evaluates the optional result form of a loop header, NIL if missing
+ *
+ * @param header the first argument of the loop operator
+ * @param result_node out param pointer to the result node
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t eval_loop_result(astnode *header, astnode **result_node,
+                              env *env) {
+  if (header->as.list.count == 3)
+    return eval_node(header->as.list.children[2], result_node, env);
+
+  *result_node = get_bool_node(0);
+  RETURN_ERR_IF(!*result_node, ERR_OUT_OF_MEMORY);
+  (*result_node)->origin = TEMPORARY;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Evaluates the body count times with the variable bound to 0, 1, ...
+ * count - 1, (dotimes (var count [result]) body...). The counter is kept in C
+ * and stored into the variable in place. Returns the result form or NIL.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_dotimes(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 2, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  int brk_stop = 0;
+  int64_t count;
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *header = list_node->as.list.children[1], *var_node, *temp = NULL;
+
+  err = get_loop_var(header, &var_node, env);
+  RETURN_ERR_IF(err, err);
+
+  err = eval_node(header->as.list.children[1], &temp, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(temp->type != NUMBER, fail_cleanup, ERR_SYNTAX_ERROR);
+  count = temp->as.value;
+  free_temp_node_parts(temp);
+
+  for (int64_t i = 0; i < count && !brk_stop; i++) {
+    bind_number(var_node, i);
+    err = eval_loop_body(list_node, 2, &brk_stop, env);
+    RETURN_ERR_IF(err, err);
+  }
+
+  return eval_loop_result(header, result_node, env);
+fail_cleanup:
+  free_temp_node_parts(temp);
+  return retval;
+}
+
+/**
+ * @brief Evaluates the body once for every element of a list, vector or range
+ * with the variable bound to the element, (dolist (var sequence [result])
+ * body...). Numbers are stored into the variable in place, other elements are
+ * copied like SET does. Returns the result form or NIL.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result node, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_dolist(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 2, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  int brk_stop = 0;
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *header = list_node->as.list.children[1], *var_node, *seq = NULL,
+          *item, *copy = NULL;
+
+  err = get_loop_var(header, &var_node, env);
+  RETURN_ERR_IF(err, err);
+
+  err = eval_node(header->as.list.children[1], &seq, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(seq->type != LIST && seq->type != VECTOR &&
+                          seq->type != RANGE,
+                      cleanup, ERR_SYNTAX_ERROR);
+
+  /* the body may reassign, grow or free a variable we walk, or the list a
+   * view borrows its items from, and binding the loop variable overwrites
+   * the sequence when both are the same variable, so these are walked in a
+   * private copy */
+  if (seq->origin != TEMPORARY ||
+      (seq->type == LIST && !seq->as.list.base && seq->as.list.count)) {
+    err = make_deep_copy(seq, &copy, TEMPORARY);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    free_temp_node_parts(seq);
+    seq = copy;
+    copy = NULL;
+  }
+
+  for (int i = 0; !brk_stop; i++) {
+    if (seq->type == VECTOR) {
+      if (i >= seq->as.vector.count)
+        break;
+      if (seq->as.vector.kind == VEC_F64)
+        bind_real(var_node, vector_get_real(seq, i));
+      else
+        bind_number(var_node, vector_get(seq, i));
+    } else if (seq->type == RANGE) {
+      if (i >= seq->as.range.count)
+        break;
+      bind_number(var_node, range_get(seq, i));
+    } else {
+      if (i >= seq->as.list.count)
+        break;
+      item = seq->as.list.children[i];
+      if (item->type == NUMBER) {
+        bind_number(var_node, item->as.value);
+      } else {
+        /* make node copy with VARIABLE origin */
+        err = make_deep_copy(item, &copy, VARIABLE);
+        CLEANUP_WITH_ERR_IF(err, cleanup, err);
+        free_node_content(var_node);
+        *var_node = *copy;
+        free_node_shell(copy);
+        copy = NULL;
+      }
+    }
+    err = eval_loop_body(list_node, 2, &brk_stop, env);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  }
+
+  err = eval_loop_result(header, result_node, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+cleanup:
+  free_temp_node_parts(seq);
+  return retval;
+}
+
 /**
  * @brief Breaks out of a loop, returning CONTROL_BREAK.
  * @param list_node List node containing the operator
@@ -972,17 +1651,122 @@ struct operator_entry operators[] = {
     {"QUOTE", oper_quote},
     {"SET", oper_set},
     {"LIST", oper_list},
+    {"RANGE", oper_range},
     {"ATOM", oper_atom},
     {"CAR", oper_car},
     {"CDR", oper_cdr},
+    {"NTHCDR", oper_nthcdr},
     {"NTH", oper_nth},
     {"LENGTH", oper_len},
+    {"PUSH", oper_push},
+    {"APPEND!", oper_append_in_place},
+    {"RESERVE", oper_reserve},
+    /* vectors */
+    {"MAKE-VECTOR", oper_make_vector},
+    {"AREF", oper_aref},
+    {"V+", oper_vec_arith},
+    {"V-", oper_vec_arith},
+    {"V*", oper_vec_arith},
+    {"VMIN", oper_vec_arith},
+    {"VMAX", oper_vec_arith},
+    /* matrices */
+    {"MAKE-MATRIX", oper_make_matrix},
+    {"MREF", oper_mref},
+    {"MATMUL", oper_matmul},
+    {"TRANSPOSE", oper_transpose},
+    {"ROW-SUM", oper_matrix_reduce},
+    {"ROW-MIN", oper_matrix_reduce},
+    {"ROW-MAX", oper_matrix_reduce},
+    {"COL-SUM", oper_matrix_reduce},
+    {"COL-MIN", oper_matrix_reduce},
+    {"COL-MAX", oper_matrix_reduce},
+    /* heaps */
+    {"MAKE-HEAP", oper_make_heap},
+    {"HEAP-PUSH", oper_heap_push},
+    {"HEAP-POP", oper_heap_pop},
+    {"HEAP-PEEK", oper_heap_peek},
+    {"HEAP-SIZE", oper_heap_size},
+    {"TOP-K", oper_top_k},
+    /* hash tables */
+    {"MAKE-HASH", oper_make_hash},
+    {"GETHASH", oper_gethash},
+    {"PUTHASH", oper_puthash},
+    {"REMHASH", oper_remhash},
+    /* sets */
+    {"DISTINCT", oper_set_op},
+    {"UNION", oper_set_op},
+    {"INTERSECTION", oper_set_op},
+    {"SET-DIFFERENCE", oper_set_op},
+    /* reductions */
+    {"SUM", oper_reduce},
+    {"PRODUCT", oper_reduce},
+    {"REDUCE-MIN", oper_reduce},
+    {"REDUCE-MAX", oper_reduce},
+    {"COUNT-IF-EQ", oper_count_if_eq},
+    {"COUNT-BY", oper_count_by},
+    {"SUM-BY", oper_sum_by},
+    /* pipelines */
+    {"MAPCAR", oper_mapcar},
+    {"REMOVE-IF-NOT", oper_remove_if_not},
+    {"REDUCE", oper_fold},
+    /* sorting */
+    {"SORT", oper_sort},
+    {"SORT!", oper_sort_in_place},
     /* control */
     {"IF", oper_if},
     {"WHILE", oper_while},
+    {"DOTIMES", oper_dotimes},
+    {"DOLIST", oper_dolist},
     {"BRK", oper_brk},
     {"PRINT", oper_print},
+    {"TIME", oper_time},
+    {"ROOM", oper_room},
     {"QUIT", oper_quit},
 };
 
-int oper_count = sizeof(operators) / sizeof(operators[0]);
\ No newline at end of file
+int oper_count = sizeof(operators) / sizeof(operators[0]);
+
+/* slots of the operator index, a power of two more than twice the count of
+ * operators keeps the linear probes short */
+#define OPER_INDEX_SIZE 256
+
+/* index of the operator in each slot plus one, 0 for an empty slot */
+static int oper_index[OPER_INDEX_SIZE];
+static int oper_index_ready = 0;
+
+/**
+ * @brief Fills the operator index by the hash of each operator symbol
+ */
+static void build_oper_index(void) {
+  astnode key = {0};
+  int slot;
+
+  key.type = SYMBOL;
+  for (int i = 0; i < oper_count; i++) {
+    key.as.symbol = operators[i].symbol;
+    slot = (int)(hash_node(&key) & (OPER_INDEX_SIZE - 1));
+    while (oper_index[slot])
+      slot = (slot + 1) & (OPER_INDEX_SIZE - 1);
+    oper_index[slot] = i + 1;
+  }
+  oper_index_ready = 1;
+}
+
+/**
+ * @brief Looks the operator up by its symbol through the operator index
+ *
+ * @param symbol SYMBOL type node
+ * @return int index of the operator in the operators array, -1 if unknown
+ */
+int find_operator(const astnode *symbol) {
+  int slot, index;
+
+  RETURN_VAL_IF(!symbol || symbol->type != SYMBOL, -1);
+  if (!oper_index_ready)
+    build_oper_index();
+  slot = (int)(hash_node(symbol) & (OPER_INDEX_SIZE - 1));
+  for (; (index = oper_index[slot]); slot = (slot + 1) & (OPER_INDEX_SIZE - 1))
+    RETURN_VAL_IF(!strcmp(operators[index - 1].symbol, symbol->as.symbol),
+                  index - 1);
+  return -1;
+}
\ No newline at end of file
@@ -1,8 +1,12 @@
 #include "parser.h"
 #include "ast.h"
+#include "bignum.h"
 #include "err.h"
+#include "lexer.h"
 #include "macros.h"
+#include "vector.h"
 #include <ctype.h>
+#include <errno.h>
 #include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
@@ -25,18 +29,20 @@
  *
  * @param out_node root of resulting AST, NULL on failure
  * @param tokens array of all tokens to process
+ * @param spans where the tokens are in the source
  * @param curr_tok index into tokens pointing to current token to parse
  * @return err_t error ERR_NO_ERROR on success, otherwise syntax error or
  * out_of_memory
  */
-err_t parse_list(astnode **out_node, const char **tokens, int *curr_tok) {
+err_t parse_list(astnode **out_node, const char **tokens,
+                 const struct source_span *spans, int *curr_tok) {
   err_t err, retval;
   astnode *node = NULL;
 
   RETURN_ERR_IF(!out_node, ERR_INTERNAL);
   *out_node = get_list_node();
   while (tokens[*curr_tok] && tokens[*curr_tok][0] != ')') {
-    err = parse_expr(&node, tokens, curr_tok);
+    err = parse_expr(&node, tokens, spans, curr_tok);
     CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
     err = add_child_node(*out_node, node);
     CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
@@ -97,13 +103,61 @@ int is_number(const char *s) {
   return 1;
 }
 
+/**
+ * @brief Checks if the string is a decimal floating point literal, an
+ * optionally signed mantissa with a decimal point, an exponent or both, like
+ * 1.5, -.5, 2E10 or 1.5E-3. Tokens are upper case by now.
+ *
+ * @param s
+ * @return int 1 if float, 0 otherwise
+ */
+int is_float(const char *s) {
+  int digits = 0, point = 0, exponent = 0;
+
+  RETURN_VAL_IF(!s || !*s, 0);
+  if (*s == '-' || *s == '+')
+    s++;
+  for (; isdigit(*s) || (*s == '.' && !point); s++) {
+    if (*s == '.')
+      point = 1;
+    else
+      digits++;
+  }
+  RETURN_VAL_IF(!digits, 0);
+
+  if (*s == 'E') {
+    s++;
+    if (*s == '-' || *s == '+')
+      s++;
+    for (; isdigit(*s); s++)
+      exponent++;
+    RETURN_VAL_IF(!exponent, 0);
+  }
+  return !*s && (point || exponent);
+}
+
+/**
+ * @brief Checks if the node is a non-empty list of NUMBER or FLOAT nodes only
+ *
+ * @param node to check
+ * @return int 1 if list of numbers, 0 otherwise
+ */
+int is_number_list(const astnode *node) {
+  RETURN_VAL_IF(!node || node->type != LIST || !node->as.list.count, 0);
+  for (int i = 0; i < node->as.list.count; i++)
+    RETURN_VAL_IF(node->as.list.children[i]->type != NUMBER &&
+                      node->as.list.children[i]->type != FLOAT,
+                  0);
+  return 1;
+}
+
 /**
  * @brief Parser for grammar rule: "E -> 'E | (L) | C | S"
  *
  * Decides form by current token and builds AST:
  *  - 'E  -> (quote <expr>)
  *  - (L) -> parse_list(...) until ')'
- *  - C   -> number node (digits only)
+ *  - C   -> number node (digits only) or float node (decimal literal)
  *  - S   -> symbol node (printable token)
  *
  * Advances curr_tok past the whole expression. Expects "'", "(", ")"
@@ -111,21 +165,36 @@ int is_number(const char *s) {
  *
  * @param out_node root of resulting AST, NULL on failure
  * @param tokens array of all tokens to process
+ * @param spans where the tokens are in the source
  * @param curr_tok index into tokens pointing to current token
  * @return err_t ERR_NO_ERROR on success, otherwise syntax/out_of_memory
  */
-err_t parse_expr(astnode **out_node, const char **tokens, int *curr_tok) {
+err_t parse_expr(astnode **out_node, const char **tokens,
+                 const struct source_span *spans, int *curr_tok) {
   err_t err, retval = ERR_NO_ERROR;
   astnode *quote_symbol_node = NULL, *inner_node = NULL;
 
   const char *next_token = tokens[*curr_tok];
+  const struct source_span *first = &spans[*curr_tok], *last;
   /* turns the "'E" into node: (quote <expr>) and parse anything after "'" as
    * expresion*/
   if (next_token[0] == '\'') {
     (*curr_tok)++;
-    err = parse_expr(&inner_node, tokens, curr_tok);
+    err = parse_expr(&inner_node, tokens, spans, curr_tok);
     CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
 
+#if PARSE_NUMERIC_VECTORS
+    /* pack quoted lists of numbers right away */
+    if (is_number_list(inner_node)) {
+      astnode *vec_node = NULL;
+      err = list_to_vector(inner_node, &vec_node);
+      CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+      free_node(inner_node);
+      inner_node = vec_node;
+      inner_node->origin = AST;
+    }
+#endif
+
     *out_node = get_list_node();
     CLEANUP_WITH_ERR_IF(!*out_node, fail_cleanup, ERR_OUT_OF_MEMORY);
     (*out_node)->origin = AST;
@@ -143,7 +212,7 @@ err_t parse_expr(astnode **out_node, const char **tokens, int *curr_tok) {
     /* parse a list node surrounded by brackets */
   } else if (next_token[0] == '(') {
     (*curr_tok)++;
-    err = parse_list(out_node, tokens, curr_tok);
+    err = parse_list(out_node, tokens, spans, curr_tok);
     CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
     (*out_node)->origin = AST;
     CLEANUP_WITH_ERR_IF(tokens[*curr_tok][0] != ')', fail_cleanup,
@@ -154,9 +223,25 @@ err_t parse_expr(astnode **out_node, const char **tokens, int *curr_tok) {
   } else if (is_number(next_token)) {
     (*curr_tok)++;
     char *endptr = NULL;
-    int val = strtol(next_token, &endptr, 10);
+    errno = 0;
+    long long val = strtoll(next_token, &endptr, 10);
     CLEANUP_WITH_ERR_IF(*endptr != '\0', fail_cleanup, ERR_SYNTAX_ERROR);
-    *out_node = get_number_node(val);
+    if (errno == ERANGE) {
+      /* literals beyond 64 bits become bignums */
+      bignum *big = bignum_parse(next_token);
+      CLEANUP_WITH_ERR_IF(!big, fail_cleanup, ERR_OUT_OF_MEMORY);
+      err = get_integer_node(0, big, out_node);
+      CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    } else {
+      *out_node = get_number_node(val);
+      CLEANUP_WITH_ERR_IF(!*out_node, fail_cleanup, ERR_OUT_OF_MEMORY);
+    }
+    (*out_node)->origin = AST;
+
+    /* create a float node */
+  } else if (is_float(next_token)) {
+    (*curr_tok)++;
+    *out_node = get_float_node(strtod(next_token, NULL));
     CLEANUP_WITH_ERR_IF(!*out_node, fail_cleanup, ERR_OUT_OF_MEMORY);
     (*out_node)->origin = AST;
 
@@ -179,6 +264,12 @@ err_t parse_expr(astnode **out_node, const char **tokens, int *curr_tok) {
     goto fail_cleanup;
   }
 
+  /* the node spans all the tokens it was read from */
+  last = &spans[*curr_tok - 1];
+  (*out_node)->span.offset = first->offset;
+  (*out_node)->span.length = last->offset + last->length - first->offset;
+  (*out_node)->span.line = first->line;
+
   // printf("parsed: %s, returning:", next_token);
   // print_node(*out_node);
   // printf("\n");
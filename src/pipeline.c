@@ -0,0 +1,691 @@
+#include "pipeline.h"
+#include "ast.h"
+#include "bignum.h"
+#include "env.h"
+#include "err.h"
+#include "macros.h"
+#include "number.h"
+#include "range.h"
+#include "vector.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* arithmetic functions come first, only those can be used by REDUCE */
+enum pipe_func {
+  PIPE_ADD,
+  PIPE_SUB,
+  PIPE_MUL,
+  PIPE_DIV,
+  PIPE_MIN,
+  PIPE_MAX,
+  PIPE_EQ,
+  PIPE_NEQ,
+  PIPE_LT,
+  PIPE_GT,
+  PIPE_LE,
+  PIPE_GE,
+  PIPE_ATOM,
+};
+
+#define IS_ARITHMETIC(func) ((func) <= PIPE_MAX)
+
+static const struct {
+  const char *symbol;
+  enum pipe_func func;
+} pipe_funcs[] = {
+    {"+", PIPE_ADD},  {"-", PIPE_SUB},   {"*", PIPE_MUL},  {"/", PIPE_DIV},
+    {"MIN", PIPE_MIN}, {"MAX", PIPE_MAX}, {"=", PIPE_EQ},   {"/=", PIPE_NEQ},
+    {"<", PIPE_LT},   {">", PIPE_GT},    {"<=", PIPE_LE},  {">=", PIPE_GE},
+    {"ATOM", PIPE_ATOM},
+};
+
+enum stream_kind { STREAM_SEQUENCE, STREAM_CONSTANT, STREAM_MAP, STREAM_FILTER };
+
+/**
+ * @brief Element flowing through a pipeline. Computed fixnums, floats and
+ * booleans are stored inline, other elements point into their source sequence
+ * or to the bignum result of the stage that computed them.
+ */
+struct pipe_value {
+  enum node_type type;
+  int64_t value;
+  double real;
+  astnode *node;
+};
+
+/**
+ * @brief Pull based element source. A SEQUENCE walks an evaluated list, vector
+ * or range, a CONSTANT repeats an atom, MAP and FILTER apply their function to
+ * the next values of the argc streams starting at index first. A MAP keeps its
+ * last BIGNUM result in big, valid until it is pulled again.
+ */
+struct stream {
+  enum stream_kind kind;
+  enum pipe_func func;
+  astnode *seq;
+  astnode big;
+  int pos;
+  int first;
+  int argc;
+  int bounded;
+};
+
+/**
+ * @brief Fused MAPCAR / REMOVE-IF-NOT chain, values[i] holds the current value
+ * of streams[i], so the arguments of a stage are contiguous in values
+ */
+struct pipeline {
+  struct stream *streams;
+  struct pipe_value *values;
+  int count;
+  int capacity;
+};
+
+/**
+ * @brief Looks up the builtin function named by a symbol node
+ *
+ * @param symbol evaluated function argument
+ * @param func out param, the function
+ * @return err_t
+ */
+static err_t lookup_func(const astnode *symbol, enum pipe_func *func) {
+  RETURN_ERR_IF(symbol->type != SYMBOL, ERR_SYNTAX_ERROR);
+  size_t i, count = sizeof(pipe_funcs) / sizeof(pipe_funcs[0]);
+  for (i = 0; i < count; i++)
+    if (!strcmp(pipe_funcs[i].symbol, symbol->as.symbol))
+      break;
+  RETURN_ERR_IF(i == count, ERR_UNKNOWN_OPERATOR);
+
+  *func = pipe_funcs[i].func;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Appends n zeroed streams to the pipeline
+ *
+ * @param p pipeline
+ * @param n count of streams
+ * @param first out param, index of the first new stream
+ * @return err_t
+ */
+static err_t add_streams(struct pipeline *p, int n, int *first) {
+  if (p->count + n > p->capacity) {
+    int capacity = p->capacity ? p->capacity : 4;
+    while (capacity < p->count + n)
+      capacity *= 2;
+
+    struct stream *streams =
+        realloc(p->streams, sizeof(struct stream) * capacity);
+    RETURN_ERR_IF(!streams, ERR_OUT_OF_MEMORY);
+    p->streams = streams;
+    struct pipe_value *values =
+        realloc(p->values, sizeof(struct pipe_value) * capacity);
+    RETURN_ERR_IF(!values, ERR_OUT_OF_MEMORY);
+    p->values = values;
+    p->capacity = capacity;
+  }
+
+  memset(p->streams + p->count, 0, sizeof(struct stream) * n);
+  memset(p->values + p->count, 0, sizeof(struct pipe_value) * n);
+  *first = p->count;
+  p->count += n;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Frees the pipeline and the evaluated arguments of its streams
+ *
+ * @param p pipeline
+ */
+static void free_pipeline(struct pipeline *p) {
+  for (int i = 0; i < p->count; i++) {
+    free_temp_node_parts(p->streams[i].seq);
+    if (p->streams[i].big.type == BIGNUM)
+      bignum_free(p->streams[i].big.as.big);
+  }
+  free(p->streams);
+  free(p->values);
+}
+
+/**
+ * @brief Checks whether the expression is a MAPCAR or REMOVE-IF-NOT call that
+ * can be fused into the enclosing pipeline
+ *
+ * @param expr unevaluated argument
+ * @return int 1 if it is, 0 otherwise
+ */
+static int is_stage(const astnode *expr) {
+  RETURN_VAL_IF(expr->type != LIST || !expr->as.list.count, 0);
+  const astnode *head = expr->as.list.children[0];
+  RETURN_VAL_IF(!head || head->type != SYMBOL, 0);
+  return !strcmp(head->as.symbol, "MAPCAR") ||
+         !strcmp(head->as.symbol, "REMOVE-IF-NOT");
+}
+
+/**
+ * @brief Compiles an argument expression into the stream at index slot.
+ * MAPCAR and REMOVE-IF-NOT calls become stages whose arguments are compiled
+ * recursively, anything else is evaluated once.
+ *
+ * @param p pipeline
+ * @param expr unevaluated argument
+ * @param slot index of the stream to fill
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t compile_stream(struct pipeline *p, astnode *expr, int slot,
+                            env *env) {
+  err_t err;
+  enum pipe_func func;
+  int first, argc, bounded = 0;
+  astnode *temp = NULL;
+  struct stream *s;
+
+  if (!is_stage(expr)) {
+    err = eval_node(expr, &temp, env);
+    RETURN_ERR_IF(err, err);
+    s = &p->streams[slot];
+    s->seq = temp;
+
+    RETURN_ERR_IF(temp->type == HASH, ERR_SYNTAX_ERROR);
+
+    if (temp->type == LIST || temp->type == VECTOR || temp->type == RANGE) {
+      s->kind = STREAM_SEQUENCE;
+      s->bounded = 1;
+    } else {
+      /* atoms are passed to every call */
+      s->kind = STREAM_CONSTANT;
+      p->values[slot].type = temp->type;
+      if (temp->type == SYMBOL || temp->type == BIGNUM || temp->type == FLOAT)
+        p->values[slot].node = temp;
+      else
+        p->values[slot].value = temp->as.value;
+    }
+    return ERR_NO_ERROR;
+  }
+
+  argc = expr->as.list.count - 2;
+  RETURN_ERR_IF(argc < 1, ERR_SYNTAX_ERROR);
+  for (int i = 1; i < expr->as.list.count; i++)
+    RETURN_ERR_IF(!expr->as.list.children[i], ERR_INTERNAL);
+
+  err = eval_node(expr->as.list.children[1], &temp, env);
+  RETURN_ERR_IF(err, err);
+  err = lookup_func(temp, &func);
+  free_temp_node_parts(temp);
+  RETURN_ERR_IF(err, err);
+  RETURN_ERR_IF(func == PIPE_ATOM && argc != 1, ERR_SYNTAX_ERROR);
+
+  int is_filter =
+      !strcmp(expr->as.list.children[0]->as.symbol, "REMOVE-IF-NOT");
+  RETURN_ERR_IF(is_filter && IS_ARITHMETIC(func), ERR_SYNTAX_ERROR);
+
+  err = add_streams(p, argc, &first);
+  RETURN_ERR_IF(err, err);
+  for (int i = 0; i < argc; i++) {
+    err = compile_stream(p, expr->as.list.children[i + 2], first + i, env);
+    RETURN_ERR_IF(err, err);
+    bounded |= p->streams[first + i].bounded;
+  }
+  /* atoms repeat forever, at least one argument must be a sequence */
+  RETURN_ERR_IF(!bounded, ERR_SYNTAX_ERROR);
+
+  /* the streams may have moved while compiling the arguments */
+  s = &p->streams[slot];
+  s->kind = is_filter ? STREAM_FILTER : STREAM_MAP;
+  s->func = func;
+  s->first = first;
+  s->argc = argc;
+  s->bounded = 1;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Returns an upper bound of the count of values the stream yields
+ *
+ * @param p pipeline
+ * @param slot index of the stream
+ * @return int
+ */
+static int stream_length(const struct pipeline *p, int slot) {
+  const struct stream *s = &p->streams[slot];
+  int length = INT_MAX, arg_length;
+
+  switch (s->kind) {
+  case STREAM_SEQUENCE:
+    if (s->seq->type == VECTOR)
+      return s->seq->as.vector.count;
+    if (s->seq->type == RANGE)
+      return s->seq->as.range.count;
+    return s->seq->as.list.count;
+  case STREAM_CONSTANT:
+    return INT_MAX;
+  case STREAM_FILTER:
+    return stream_length(p, s->first);
+  default:
+    for (int i = 0; i < s->argc; i++) {
+      arg_length = stream_length(p, s->first + i);
+      if (arg_length < length)
+        length = arg_length;
+    }
+    return length;
+  }
+}
+
+/**
+ * @brief Views a NUMBER, BIGNUM or FLOAT pipeline value as a node
+ *
+ * @param value pipeline value
+ * @param scratch node to fill for inline fixnums and floats
+ * @return const astnode* the node
+ */
+static const astnode *value_node(const struct pipe_value *value,
+                                 astnode *scratch) {
+  RETURN_VAL_IF(value->node, value->node);
+  scratch->type = value->type;
+  if (value->type == FLOAT)
+    scratch->as.real = value->real;
+  else
+    scratch->as.value = value->value;
+  return scratch;
+}
+
+/**
+ * @brief Compares two NUMBER, BIGNUM or FLOAT pipeline values
+ *
+ * @param a first value
+ * @param b second value
+ * @return int negative if a < b, 0 if equal, positive if a > b
+ */
+static int compare_values(const struct pipe_value *a,
+                          const struct pipe_value *b) {
+  astnode scratch_a = {0}, scratch_b = {0};
+  if (a->type == NUMBER && b->type == NUMBER)
+    return (a->value > b->value) - (a->value < b->value);
+  return compare_numbers(value_node(a, &scratch_a), value_node(b, &scratch_b));
+}
+
+/**
+ * @brief Applies the builtin function to argc values. Arithmetic runs on
+ * fixnums while the results fit 64 bits and in doubles once an argument is a
+ * float, a BIGNUM result is stored in big and replaces the previous one.
+ *
+ * @param func function to apply
+ * @param args values of the arguments
+ * @param argc count of the arguments, at least 1
+ * @param big node owning the BIGNUM result
+ * @param out out param, the computed NUMBER, BIGNUM, FLOAT or BOOLEAN value
+ * @return err_t
+ */
+static err_t apply_func(enum pipe_func func, const struct pipe_value *args,
+                        int argc, astnode *big, struct pipe_value *out) {
+  err_t err;
+  num_acc acc = {0};
+  astnode scratch = {0};
+  int best = 0, holds = 1;
+
+  if (func == PIPE_ATOM) {
+    out->type = BOOLEAN;
+    out->value = args[0].type != LIST && args[0].type != RANGE;
+    out->node = NULL;
+    return ERR_NO_ERROR;
+  }
+
+  for (int i = 0; i < argc; i++)
+    RETURN_ERR_IF(args[i].type != NUMBER && args[i].type != BIGNUM &&
+                      args[i].type != FLOAT,
+                  ERR_SYNTAX_ERROR);
+
+  switch (func) {
+  case PIPE_ADD:
+  case PIPE_SUB:
+  case PIPE_MUL:
+  case PIPE_DIV:
+    err = number_apply(func == PIPE_SUB && argc == 1 ? INT_SUB : INT_ADD, &acc,
+                       value_node(args, &scratch));
+    RETURN_ERR_IF(err, err);
+    for (int i = 1; i < argc; i++) {
+      err = number_apply(func == PIPE_ADD   ? INT_ADD
+                         : func == PIPE_SUB ? INT_SUB
+                         : func == PIPE_MUL ? INT_MUL
+                                            : INT_DIV,
+                         &acc, value_node(args + i, &scratch));
+      if (err) {
+        bignum_free(acc.big);
+        return err;
+      }
+    }
+    break;
+  case PIPE_MIN:
+  case PIPE_MAX:
+    for (int i = 1; i < argc; i++) {
+      int cmp = compare_values(args + i, args + best);
+      if (func == PIPE_MIN ? cmp < 0 : cmp > 0)
+        best = i;
+    }
+    err = number_apply(INT_ADD, &acc, value_node(args + best, &scratch));
+    RETURN_ERR_IF(err, err);
+    break;
+  default:
+    for (int i = 1; i < argc; i++) {
+      switch (func) {
+      case PIPE_EQ:
+        holds &= !compare_values(args + i, args);
+        break;
+      case PIPE_NEQ:
+        for (int j = 0; j < i; j++)
+          holds &= compare_values(args + i, args + j) != 0;
+        break;
+      case PIPE_LT:
+        holds &= compare_values(args + i - 1, args + i) < 0;
+        break;
+      case PIPE_GT:
+        holds &= compare_values(args + i - 1, args + i) > 0;
+        break;
+      case PIPE_LE:
+        holds &= compare_values(args + i - 1, args + i) <= 0;
+        break;
+      default:
+        holds &= compare_values(args + i - 1, args + i) >= 0;
+        break;
+      }
+    }
+    out->type = BOOLEAN;
+    out->value = holds;
+    out->node = NULL;
+    return ERR_NO_ERROR;
+  }
+
+  /* the arguments are read, the previous result can be replaced */
+  if (big->type == BIGNUM)
+    bignum_free(big->as.big);
+  big->type = acc.big ? BIGNUM : NUMBER;
+  big->as.big = acc.big;
+  out->type = acc.is_float ? FLOAT : acc.big ? BIGNUM : NUMBER;
+  out->value = acc.fix;
+  out->real = acc.real;
+  out->node = acc.big ? big : NULL;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Advances the stream to its next value, stored in p->values[slot]
+ *
+ * @param p pipeline
+ * @param slot index of the stream
+ * @param done out param, set to 1 when the stream is exhausted
+ * @return err_t
+ */
+static err_t stream_next(struct pipeline *p, int slot, int *done) {
+  err_t err;
+  struct stream *s = &p->streams[slot];
+  struct pipe_value *out = &p->values[slot];
+  astnode *item;
+
+  switch (s->kind) {
+  case STREAM_CONSTANT:
+    return ERR_NO_ERROR;
+  case STREAM_SEQUENCE:
+    if (s->seq->type == VECTOR) {
+      if (s->pos >= s->seq->as.vector.count)
+        break;
+      if (s->seq->as.vector.kind == VEC_F64) {
+        out->type = FLOAT;
+        out->real = vector_get_real(s->seq, s->pos++);
+      } else {
+        out->type = NUMBER;
+        out->value = vector_get(s->seq, s->pos++);
+      }
+      out->node = NULL;
+    } else if (s->seq->type == RANGE) {
+      if (s->pos >= s->seq->as.range.count)
+        break;
+      out->type = NUMBER;
+      out->value = range_get(s->seq, s->pos++);
+      out->node = NULL;
+    } else {
+      if (s->pos >= s->seq->as.list.count)
+        break;
+      item = s->seq->as.list.children[s->pos++];
+      out->type = item->type;
+      if (item->type == NUMBER || item->type == BOOLEAN) {
+        out->value = item->as.value;
+        out->node = NULL;
+      } else {
+        out->node = item;
+      }
+    }
+    return ERR_NO_ERROR;
+  default:
+    do {
+      for (int i = 0; i < s->argc; i++) {
+        err = stream_next(p, s->first + i, done);
+        RETURN_ERR_IF(err, err);
+        RETURN_VAL_IF(*done, ERR_NO_ERROR);
+      }
+      err = apply_func(s->func, &p->values[s->first], s->argc, &s->big, out);
+      RETURN_ERR_IF(err, err);
+    } while (s->kind == STREAM_FILTER && !out->value);
+
+    if (s->kind == STREAM_FILTER)
+      *out = p->values[s->first];
+    return ERR_NO_ERROR;
+  }
+
+  *done = 1;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Makes a TEMPORARY node holding the value
+ *
+ * @param value pipeline value
+ * @param out_node out param, the new node
+ * @return err_t
+ */
+static err_t value_to_node(const struct pipe_value *value,
+                           astnode **out_node) {
+  if (value->node)
+    return make_deep_copy(value->node, out_node, TEMPORARY);
+
+  if (value->type == BOOLEAN)
+    *out_node = get_bool_node(value->value);
+  else if (value->type == FLOAT)
+    *out_node = get_float_node(value->real);
+  else
+    *out_node = get_number_node(value->value);
+  RETURN_ERR_IF(!*out_node, ERR_OUT_OF_MEMORY);
+  (*out_node)->origin = TEMPORARY;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Runs the MAPCAR or REMOVE-IF-NOT call as a fused pipeline and
+ * collects its values into a new list
+ *
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result LIST node
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t collect_pipeline(astnode *list_node, astnode **result_node,
+                              env *env) {
+  err_t err, retval = ERR_NO_ERROR;
+  int root, done = 0;
+  struct pipeline p = {0};
+  astnode *list = NULL, *item = NULL;
+
+  err = add_streams(&p, 1, &root);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  err = compile_stream(&p, list_node, root, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+  list = get_list_node();
+  CLEANUP_WITH_ERR_IF(!list, cleanup, ERR_OUT_OF_MEMORY);
+  list->origin = TEMPORARY;
+  /* a map yields exactly as many values as its shortest argument */
+  if (p.streams[root].kind == STREAM_MAP) {
+    err = reserve_children(list, stream_length(&p, root));
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  }
+
+  for (;;) {
+    err = stream_next(&p, root, &done);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    if (done)
+      break;
+    err = value_to_node(&p.values[root], &item);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    err = add_child_node(list, item);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    item = NULL;
+  }
+
+  *result_node = list;
+  list = NULL;
+
+cleanup:
+  free_temp_node_parts(item);
+  free_temp_node_parts(list);
+  free_pipeline(&p);
+  return retval;
+}
+
+/**
+ * @brief Applies a builtin function to the elements of the sequences at the
+ * same index and returns the list of results, (mapcar 'function sequence...).
+ * The function is one of + - * / MIN MAX = /= < > <= >= ATOM. An atom argument
+ * is passed to every call, the result is as long as the shortest sequence.
+ * Nested MAPCAR and REMOVE-IF-NOT arguments are fused into a single pass.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result LIST node with TEMPORARY
+ * origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_mapcar(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  return collect_pipeline(list_node, result_node, env);
+}
+
+/**
+ * @brief Returns the elements of the first sequence for which the builtin
+ * predicate holds, (remove-if-not 'predicate sequence [argument...]). The
+ * predicate gets the elements at the same index of all arguments, so
+ * (remove-if-not '> xs 0) keeps the positive numbers. Nested MAPCAR and
+ * REMOVE-IF-NOT arguments are fused into a single pass.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result LIST node with TEMPORARY
+ * origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_remove_if_not(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  return collect_pipeline(list_node, result_node, env);
+}
+
+/**
+ * @brief Folds the sequence with a builtin arithmetic function, (reduce
+ * 'function sequence [initial]). An empty sequence without initial value
+ * gives 0 for + and 1 for *, an error otherwise. A nested MAPCAR or
+ * REMOVE-IF-NOT argument is consumed element by element without building the
+ * intermediate list.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result NUMBER node with TEMPORARY
+ * origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_fold(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 3 || list_node->as.list.count > 4,
+                ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int root, done = 0, has_acc = 0;
+  enum pipe_func func;
+  struct pipe_value args[2] = {0};
+  struct pipeline p = {0};
+  astnode *temp = NULL, acc = {0};
+
+  err = eval_node(list_node->as.list.children[1], &temp, env);
+  RETURN_ERR_IF(err, err);
+  err = lookup_func(temp, &func);
+  free_temp_node_parts(temp);
+  temp = NULL;
+  RETURN_ERR_IF(err, err);
+  RETURN_ERR_IF(!IS_ARITHMETIC(func), ERR_SYNTAX_ERROR);
+
+  if (list_node->as.list.count == 4) {
+    err = eval_node(list_node->as.list.children[3], &temp, env);
+    RETURN_ERR_IF(err, err);
+    CLEANUP_WITH_ERR_IF(!is_numeric(temp), cleanup, ERR_SYNTAX_ERROR);
+    args[0].type = temp->type;
+    args[0].node = temp;
+    has_acc = 1;
+  }
+
+  err = add_streams(&p, 1, &root);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  err = compile_stream(&p, list_node->as.list.children[2], root, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  CLEANUP_WITH_ERR_IF(!p.streams[root].bounded, cleanup, ERR_SYNTAX_ERROR);
+
+  for (;;) {
+    err = stream_next(&p, root, &done);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    if (done)
+      break;
+    CLEANUP_WITH_ERR_IF(p.values[root].type != NUMBER &&
+                            p.values[root].type != BIGNUM &&
+                            p.values[root].type != FLOAT,
+                        cleanup, ERR_SYNTAX_ERROR);
+    if (!has_acc) {
+      /* a BIGNUM value is only valid until the next pull, keep a copy */
+      err = apply_func(PIPE_ADD, &p.values[root], 1, &acc, args);
+      CLEANUP_WITH_ERR_IF(err, cleanup, err);
+      has_acc = 1;
+      continue;
+    }
+    args[1] = p.values[root];
+    err = apply_func(func, args, 2, &acc, args);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  }
+
+  if (!has_acc) {
+    /* identity of the function, (+) is 0 and (*) is 1 */
+    CLEANUP_WITH_ERR_IF(func != PIPE_ADD && func != PIPE_MUL, cleanup,
+                        ERR_SYNTAX_ERROR);
+    args[0].type = NUMBER;
+    args[0].value = func == PIPE_MUL;
+  }
+
+  err = value_to_node(args, result_node);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+cleanup:
+  if (acc.type == BIGNUM)
+    bignum_free(acc.as.big);
+  free_temp_node_parts(temp);
+  free_pipeline(&p);
+  return retval;
+}
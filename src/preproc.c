@@ -4,7 +4,8 @@
 #include <string.h>
 
 /**
- * @brief Replaces Lisp comments and line separators with spaces
+ * @brief Replaces Lisp comments and carriage returns with spaces. Line feeds
+ * are kept, so the lexer can tell the line of every token.
  *
  * @param code_string Lisp source code
  * @return -1 if code_string is NULL
@@ -20,7 +21,7 @@ err_t preprocess(char *code_string) {
       commenting = 1;
     if (c == '\n' || c == '\r')
       commenting = 0;
-    if (commenting || c == '\n' || c == '\r')
+    if (commenting || c == '\r')
       code_string[i] = ' ';
   }
   return ERR_NO_ERROR;
@@ -0,0 +1,460 @@
+#define _XOPEN_SOURCE 600
+#include "profile.h"
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include "macros.h"
+#include "operators.h"
+#include "trace.h"
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+int profiling = 0;
+
+static struct oper_profile *stats = NULL;
+
+/* time and allocations of the operators nested in the running one so far */
+static uint64_t nested_ns = 0;
+static uint64_t nested_allocs = 0;
+
+/* operator calls in progress, read by the SIGPROF handler, so a frame is
+ * complete before the depth counts it */
+static volatile struct sample_frame running[SAMPLE_MAX_DEPTH];
+static volatile sig_atomic_t running_depth = 0;
+
+/* samples, each a header frame with the count of frames in `line` and -1 in
+ * `oper` followed by the frames from the outermost call */
+static struct sample_frame *samples = NULL;
+static volatile sig_atomic_t samples_used = 0;
+static volatile sig_atomic_t samples_dropped = 0;
+static const char *sampled_source = NULL;
+
+/**
+ * @brief Reads the monotonic clock
+ *
+ * @return uint64_t nanoseconds
+ */
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Allocates the statistics of all operators and turns profiling of
+ * operator calls on
+ *
+ * @return err_t
+ */
+err_t profile_start(void) {
+  free(stats);
+  stats = calloc(oper_count, sizeof(struct oper_profile));
+  RETURN_ERR_IF(!stats, ERR_OUT_OF_MEMORY);
+  nested_ns = 0;
+  nested_allocs = 0;
+  profiling |= PROFILE_OPERATORS;
+  return ERR_NO_ERROR;
+}
+
+#ifdef SIGPROF
+/**
+ * @brief SIGPROF handler, copies the operator calls in progress to the
+ * samples. Only touches preallocated memory.
+ *
+ * @param sig unused
+ */
+static void take_sample(int sig) {
+  (void)sig;
+  int depth = running_depth < SAMPLE_MAX_DEPTH ? running_depth
+                                               : SAMPLE_MAX_DEPTH;
+
+  /* time outside of any operator is not attributed */
+  if (!depth)
+    return;
+  if (samples_used + depth + 1 > SAMPLE_BUFFER_FRAMES) {
+    samples_dropped++;
+    return;
+  }
+  samples[samples_used].line = depth;
+  samples[samples_used].oper = -1;
+  for (int i = 0; i < depth; i++) {
+    samples[samples_used + 1 + i].line = running[i].line;
+    samples[samples_used + 1 + i].oper = running[i].oper;
+  }
+  samples_used += depth + 1;
+}
+
+/**
+ * @brief Sets the profiling timer, a zero rate stops it
+ *
+ * @param hz samples per second of CPU time or 0
+ * @return int 0 on success
+ */
+static int set_timer(int hz) {
+  struct itimerval timer = {0};
+  if (hz) {
+    timer.it_interval.tv_sec = hz == 1;
+    timer.it_interval.tv_usec = hz == 1 ? 0 : 1000000 / hz;
+    timer.it_value = timer.it_interval;
+  }
+  return setitimer(ITIMER_PROF, &timer, NULL);
+}
+#endif
+
+/**
+ * @brief Starts sampling the chain of running operators on every SIGPROF of
+ * a profiling timer
+ *
+ * @param source path of the profiled file, names the frames
+ * @param hz samples per second of CPU time
+ * @return err_t
+ */
+err_t sampling_start(const char *source, int hz) {
+  /* sanity check */
+  RETURN_ERR_IF(!source, ERR_INTERNAL);
+  RETURN_ERR_IF(hz < 1 || hz > 1000000, ERR_INVALID_ARGS);
+
+#ifdef SIGPROF
+  struct sigaction action;
+
+  free(samples);
+  samples = malloc(SAMPLE_BUFFER_FRAMES * sizeof(struct sample_frame));
+  RETURN_ERR_IF(!samples, ERR_OUT_OF_MEMORY);
+  samples_used = 0;
+  samples_dropped = 0;
+  running_depth = 0;
+  sampled_source = source;
+  profiling |= PROFILE_SAMPLES;
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = take_sample;
+  sigemptyset(&action.sa_mask);
+  /* reads and writes of the program go on after a sample */
+  action.sa_flags = SA_RESTART;
+  RETURN_ERR_IF(sigaction(SIGPROF, &action, NULL), ERR_INTERNAL);
+  RETURN_ERR_IF(set_timer(hz), ERR_INTERNAL);
+  return ERR_NO_ERROR;
+#else
+  /* no profiling timer on this platform */
+  return ERR_INVALID_ARGS;
+#endif
+}
+
+/**
+ * @brief Calls the operator at the index of the operators array and records
+ * its call count, time and allocations, makes it a frame of the samples or
+ * traces its begin and end
+ *
+ * @param index of the operator in the operators array
+ * @param list_node List node containing the operator
+ * @param result_node out param of the operator
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t of the operator
+ */
+err_t profile_call(int index, astnode *list_node, astnode **result_node,
+                   env *env) {
+  struct oper_profile *stat;
+  uint64_t outer_ns = nested_ns, outer_allocs = nested_allocs;
+  uint64_t allocs = node_allocs, start, elapsed;
+  err_t err;
+
+  if (profiling & PROFILE_SAMPLES) {
+    if (running_depth < SAMPLE_MAX_DEPTH) {
+      running[running_depth].line = list_node->span.line;
+      running[running_depth].oper = index;
+    }
+    running_depth++;
+  }
+  if (profiling & PROFILE_TRACE)
+    trace_call_begin(index, list_node);
+  if (!(profiling & PROFILE_OPERATORS)) {
+    err = operators[index].func(list_node, result_node, env);
+    if (profiling & PROFILE_TRACE)
+      trace_call_end();
+    if (profiling & PROFILE_SAMPLES)
+      running_depth--;
+    return err;
+  }
+
+  stat = &stats[index];
+  nested_ns = 0;
+  nested_allocs = 0;
+  stat->active++;
+  start = now_ns();
+  err = operators[index].func(list_node, result_node, env);
+  elapsed = now_ns() - start;
+  allocs = node_allocs - allocs;
+
+  stat->calls++;
+  stat->exclusive_ns += elapsed - nested_ns;
+  stat->allocs += allocs - nested_allocs;
+  /* a recursive call is already covered by the outermost one */
+  if (!--stat->active)
+    stat->inclusive_ns += elapsed;
+
+  nested_ns = outer_ns + elapsed;
+  nested_allocs = outer_allocs + allocs;
+  if (profiling & PROFILE_TRACE)
+    trace_call_end();
+  if (profiling & PROFILE_SAMPLES)
+    running_depth--;
+  return err;
+}
+
+/**
+ * @brief Orders operator indices by exclusive time, longest first
+ *
+ * @param a pointer to an index
+ * @param b pointer to an index
+ * @return int
+ */
+static int by_exclusive_time(const void *a, const void *b) {
+  uint64_t ta = stats[*(const int *)a].exclusive_ns;
+  uint64_t tb = stats[*(const int *)b].exclusive_ns;
+  return (ta < tb) - (ta > tb);
+}
+
+/**
+ * @brief Returns the indices of the called operators sorted by exclusive time
+ *
+ * @param count out param, count of the indices
+ * @return int* or NULL if memory could not be allocated
+ */
+static int *called_operators(int *count) {
+  int *order = malloc((oper_count ? oper_count : 1) * sizeof(int));
+  RETURN_NULL_IF(!order);
+
+  *count = 0;
+  for (int i = 0; i < oper_count; i++) {
+    if (stats[i].calls)
+      order[(*count)++] = i;
+  }
+  qsort(order, *count, sizeof(int), by_exclusive_time);
+  return order;
+}
+
+/**
+ * @brief Prints a table of the called operators sorted by exclusive time
+ *
+ * @param out stream to print to
+ */
+void profile_print(FILE *out) {
+  int count;
+  uint64_t total_ns = 0;
+  int *order;
+
+  if (!stats)
+    return;
+  order = called_operators(&count);
+  if (!order)
+    return;
+  for (int i = 0; i < count; i++)
+    total_ns += stats[order[i]].exclusive_ns;
+
+  fprintf(out, "%-16s %12s %12s %12s %6s %12s\n", "operator", "calls",
+          "incl ms", "excl ms", "excl%", "allocs");
+  for (int i = 0; i < count; i++) {
+    struct oper_profile *stat = &stats[order[i]];
+    fprintf(out, "%-16s %12llu %12.3f %12.3f %6.1f %12llu\n",
+            operators[order[i]].symbol, (unsigned long long)stat->calls,
+            stat->inclusive_ns / 1e6, stat->exclusive_ns / 1e6,
+            total_ns ? 100.0 * stat->exclusive_ns / total_ns : 0.0,
+            (unsigned long long)stat->allocs);
+  }
+  free(order);
+}
+
+/**
+ * @brief Writes the statistics of the called operators as a JSON array
+ *
+ * @param path of the file to write
+ * @return err_t
+ */
+err_t profile_write_json(const char *path) {
+  /* sanity check */
+  RETURN_ERR_IF(!path || !stats, ERR_INTERNAL);
+
+  err_t retval = ERR_NO_ERROR;
+  int count;
+  int *order = NULL;
+  FILE *out = fopen(path, "w");
+  RETURN_ERR_IF(!out, ERR_FILE_ACCESS_FAILURE);
+
+  order = called_operators(&count);
+  CLEANUP_WITH_ERR_IF(!order, cleanup, ERR_OUT_OF_MEMORY);
+
+  /* operator symbols never contain quotes or backslashes */
+  fprintf(out, "[\n");
+  for (int i = 0; i < count; i++) {
+    struct oper_profile *stat = &stats[order[i]];
+    fprintf(out,
+            "  {\"operator\": \"%s\", \"calls\": %llu, \"inclusive_ns\": "
+            "%llu, \"exclusive_ns\": %llu, \"allocs\": %llu}%s\n",
+            operators[order[i]].symbol, (unsigned long long)stat->calls,
+            (unsigned long long)stat->inclusive_ns,
+            (unsigned long long)stat->exclusive_ns,
+            (unsigned long long)stat->allocs, i + 1 < count ? "," : "");
+  }
+  fprintf(out, "]\n");
+  CLEANUP_WITH_ERR_IF(ferror(out), cleanup, ERR_FILE_ACCESS_FAILURE);
+
+cleanup:
+  free(order);
+  fclose(out);
+  return retval;
+}
+
+/**
+ * @brief Appends a frame of a folded stack to the buffer
+ *
+ * @param buffer in/out param, the folded stack so far
+ * @param length in/out param, length of the buffer contents
+ * @param capacity in/out param, size of the buffer
+ * @param frame to append
+ * @return err_t
+ */
+static err_t append_frame(char **buffer, int *length, int *capacity,
+                          const struct sample_frame *frame) {
+  const char *symbol = operators[frame->oper].symbol;
+  int needed = *length + (int)strlen(sampled_source) + (int)strlen(symbol) + 16;
+  char *tmp;
+
+  if (needed > *capacity) {
+    tmp = realloc(*buffer, needed * 2);
+    RETURN_ERR_IF(!tmp, ERR_OUT_OF_MEMORY);
+    *buffer = tmp;
+    *capacity = needed * 2;
+  }
+  *length += sprintf(*buffer + *length, "%s%s:%d %s", *length ? ";" : "",
+                     sampled_source, frame->line, symbol);
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Orders folded stacks alphabetically
+ *
+ * @param a pointer to a string
+ * @param b pointer to a string
+ * @return int
+ */
+static int by_stack(const void *a, const void *b) {
+  return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * @brief Stops the timer and writes the samples as folded stacks, one line
+ * per distinct chain of operators with its count of samples, like
+ * "file:3 DOTIMES;file:5 SET 42", the input of flamegraph.pl
+ *
+ * @param path of the file to write
+ * @return err_t
+ */
+err_t sampling_write(const char *path) {
+  /* sanity check */
+  RETURN_ERR_IF(!path || !samples, ERR_INTERNAL);
+
+#ifdef SIGPROF
+  set_timer(0);
+  signal(SIGPROF, SIG_IGN);
+#endif
+
+  err_t err, retval = ERR_NO_ERROR;
+  int count = 0, length, capacity, used = samples_used;
+  char **stacks = NULL;
+  FILE *out = NULL;
+
+  for (int i = 0; i < used; i += samples[i].line + 1)
+    count++;
+  stacks = calloc(count ? count : 1, sizeof(char *));
+  RETURN_ERR_IF(!stacks, ERR_OUT_OF_MEMORY);
+
+  /* identical stacks end up next to each other once sorted */
+  for (int i = 0, n = 0; i < used; i += samples[i].line + 1, n++) {
+    length = capacity = 0;
+    for (int j = 1; j <= samples[i].line; j++) {
+      err = append_frame(&stacks[n], &length, &capacity, &samples[i + j]);
+      CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    }
+  }
+  qsort(stacks, count, sizeof(char *), by_stack);
+
+  out = fopen(path, "w");
+  CLEANUP_WITH_ERR_IF(!out, cleanup, ERR_FILE_ACCESS_FAILURE);
+  for (int i = 0, run = 1; i < count; i++, run++) {
+    if (i + 1 < count && !strcmp(stacks[i], stacks[i + 1]))
+      continue;
+    fprintf(out, "%s %d\n", stacks[i], run);
+    run = 0;
+  }
+  CLEANUP_WITH_ERR_IF(ferror(out), cleanup, ERR_FILE_ACCESS_FAILURE);
+  if (samples_dropped)
+    fprintf(stderr, "sampling: %d samples dropped, the buffer was full\n",
+            (int)samples_dropped);
+
+cleanup:
+  if (out)
+    fclose(out);
+  for (int i = 0; i < count; i++)
+    free(stacks[i]);
+  free(stacks);
+  return retval;
+}
+
+/**
+ * @brief Frees the statistics and the samples and turns profiling off
+ */
+void profile_stop(void) {
+#ifdef SIGPROF
+  if (profiling & PROFILE_SAMPLES) {
+    set_timer(0);
+    signal(SIGPROF, SIG_IGN);
+  }
+#endif
+  free(stats);
+  stats = NULL;
+  free(samples);
+  samples = NULL;
+  profiling = 0;
+}
+
+/**
+ * @brief Evaluates the argument and returns its result like the argument
+ * itself would. Prints the elapsed wall and CPU time, the count of eval_node
+ * calls and of nodes allocated and freed during the evaluation to stderr.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result of the argument, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t of the argument
+ */
+err_t oper_time(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 2, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  uint64_t evals = node_evals, allocs = node_allocs, frees = node_frees;
+  uint64_t start = now_ns();
+  clock_t cpu_start = clock();
+  err_t err;
+
+  err = eval_node(list_node->as.list.children[1], result_node, env);
+
+  fprintf(stderr,
+          "time: %.3f ms wall, %.3f ms cpu, %llu evaluations, %llu "
+          "allocated, %llu freed\n",
+          (now_ns() - start) / 1e6,
+          (double)(clock() - cpu_start) * 1e3 / CLOCKS_PER_SEC,
+          (unsigned long long)(node_evals - evals),
+          (unsigned long long)(node_allocs - allocs),
+          (unsigned long long)(node_frees - frees));
+  RETURN_ERR_IF(err, err);
+  return ERR_NO_ERROR;
+}
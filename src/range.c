@@ -0,0 +1,143 @@
+#include "range.h"
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include "macros.h"
+#include <limits.h>
+#include <stdlib.h>
+
+/**
+ * @brief Returns the i-th element of a RANGE node, no bounds checking
+ *
+ * @param range RANGE type node
+ * @param i index of the element
+ * @return int64_t
+ */
+int64_t range_get(const astnode *range, int i) {
+  /* the element fits, see oper_range, but i * step alone may not, so the
+   * arithmetic is unsigned and wraps back into range */
+  return (int64_t)((uint64_t)range->as.range.start +
+                   (uint64_t)i * (uint64_t)range->as.range.step);
+}
+
+/**
+ * @brief Returns the range without its first `skip` elements. A temporary
+ * range is moved in place, otherwise a new temporary range is returned.
+ *
+ * @param range RANGE type node
+ * @param skip count of leading elements to leave out, 0 <= skip < count
+ * @param out_node out param, the resulting TEMPORARY range node
+ * @return err_t
+ */
+err_t get_range_tail(astnode *range, int skip, astnode **out_node) {
+  /* sanity check */
+  RETURN_ERR_IF(!range || !out_node || range->type != RANGE, ERR_INTERNAL);
+  RETURN_ERR_IF(skip < 0 || skip >= range->as.range.count, ERR_INTERNAL);
+
+  if (range->origin == TEMPORARY) {
+    range->as.range.start = range_get(range, skip);
+    range->as.range.count -= skip;
+    *out_node = range;
+    return ERR_NO_ERROR;
+  }
+
+  *out_node = get_range_node(range_get(range, skip), range->as.range.step,
+                             range->as.range.count - skip);
+  RETURN_ERR_IF(!*out_node, ERR_OUT_OF_MEMORY);
+  (*out_node)->origin = TEMPORARY;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Converts a RANGE node into a LIST node of NUMBER nodes in place.
+ * The numbers get the origin of the node, so a variable stays a variable.
+ *
+ * @param node RANGE type node
+ * @return err_t
+ */
+err_t materialize_range(astnode *node) {
+  /* sanity check */
+  RETURN_ERR_IF(!node || node->type != RANGE, ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  astnode list = {0}, *item;
+  int count = node->as.range.count;
+
+  list.type = LIST;
+  list.origin = node->origin;
+  err = reserve_children(&list, count);
+  RETURN_ERR_IF(err, err);
+
+  for (int i = 0; i < count; i++) {
+    item = get_number_node(range_get(node, i));
+    CLEANUP_WITH_ERR_IF(!item, fail_cleanup, ERR_OUT_OF_MEMORY);
+    item->origin = node->origin;
+    err = add_child_node(&list, item);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+  }
+
+  *node = list;
+  return retval;
+fail_cleanup:
+  free_node_content(&list);
+  return retval;
+}
+
+/**
+ * @brief Returns a lazy sequence of the integers from start up to, but not
+ * including, end, (range start end [step]). The step defaults to 1 and may be
+ * negative to count down. Elements are computed on access, so the range takes
+ * constant memory until it is mutated. Like a list it holds at most INT_MAX
+ * elements, longer ranges are a syntax error.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result RANGE node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_range(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 3 || list_node->as.list.count > 4,
+                ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int64_t args[3] = {0, 0, 1};
+  uint64_t span, step, count = 0;
+  astnode *temp = NULL;
+
+  for (int i = 1; i < list_node->as.list.count; i++) {
+    err = eval_node(list_node->as.list.children[i], &temp, env);
+    RETURN_ERR_IF(err, err);
+    CLEANUP_WITH_ERR_IF(temp->type != NUMBER, cleanup, ERR_SYNTAX_ERROR);
+    args[i - 1] = temp->as.value;
+    free_temp_node_parts(temp);
+    temp = NULL;
+  }
+  RETURN_ERR_IF(!args[2], ERR_SYNTAX_ERROR);
+
+  /* count of steps needed to reach the end, rounded up, the distance is
+   * computed unsigned as it may not fit a signed 64-bit integer */
+  if (args[2] > 0 && args[1] > args[0]) {
+    span = (uint64_t)args[1] - (uint64_t)args[0];
+    step = (uint64_t)args[2];
+    count = span / step + (span % step != 0);
+  } else if (args[2] < 0 && args[1] < args[0]) {
+    span = (uint64_t)args[0] - (uint64_t)args[1];
+    step = 0 - (uint64_t)args[2];
+    count = span / step + (span % step != 0);
+  }
+  RETURN_ERR_IF(count > INT_MAX, ERR_SYNTAX_ERROR);
+
+  *result_node = get_range_node(args[0], args[2], (int)count);
+  RETURN_ERR_IF(!*result_node, ERR_OUT_OF_MEMORY);
+  (*result_node)->origin = TEMPORARY;
+  return retval;
+
+cleanup:
+  free_temp_node_parts(temp);
+  return retval;
+}
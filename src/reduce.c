@@ -0,0 +1,578 @@
+#include "reduce.h"
+#include "ast.h"
+#include "bignum.h"
+#include "env.h"
+#include "err.h"
+#include "hash.h"
+#include "macros.h"
+#include "number.h"
+#include "range.h"
+#include "simd.h"
+#include "vector.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Applies op to an integer accumulator and a 64-bit value
+ *
+ * @param op INT_ADD or INT_MUL
+ * @param fix in/out param, fixnum accumulator
+ * @param big in/out param, bignum accumulator or NULL
+ * @param value right operand
+ * @return err_t
+ */
+static err_t fold_value(enum int_op op, int64_t *fix, bignum **big,
+                        int64_t value) {
+  astnode arg = {0};
+  arg.type = NUMBER;
+  arg.as.value = value;
+  return integer_apply(op, fix, big, &arg);
+}
+
+/**
+ * @brief Reduces the elements of a vector node
+ *
+ * @param vec VECTOR type node
+ * @param op SIMD_ADD, SIMD_MUL, SIMD_MIN or SIMD_MAX
+ * @param acc in/out param, the accumulator
+ * @return err_t
+ */
+static err_t reduce_vector(const astnode *vec, enum simd_op op,
+                           num_acc *acc) {
+  err_t err;
+  int count = vec->as.vector.count;
+
+  if (vec->as.vector.kind == VEC_F64) {
+    acc->is_float = 1;
+    acc->real = simd_reduce_f64(op, vec->as.vector.data, count);
+    return ERR_NO_ERROR;
+  }
+
+  /* 32-bit sums are accumulated in 64 bits and cannot overflow, minimum and
+   * maximum never do */
+  if (op != SIMD_MUL && (op != SIMD_ADD || vec->as.vector.kind == VEC_INT32)) {
+    if (vec->as.vector.kind == VEC_INT64)
+      acc->fix = simd_reduce_i64(op, vec->as.vector.data, count);
+    else
+      acc->fix = simd_reduce_i32(op, vec->as.vector.data, count);
+    return ERR_NO_ERROR;
+  }
+
+  for (int i = 0; i < count; i++) {
+    err = fold_value(op == SIMD_MUL ? INT_MUL : INT_ADD, &acc->fix, &acc->big,
+                     vector_get(vec, i));
+    RETURN_ERR_IF(err, err);
+  }
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Reduces the elements of a range node in constant time, except for the
+ * product
+ *
+ * @param range RANGE type node
+ * @param op SIMD_ADD, SIMD_MUL, SIMD_MIN or SIMD_MAX
+ * @param fix in/out param, fixnum accumulator
+ * @param big in/out param, bignum accumulator or NULL
+ * @return err_t
+ */
+static err_t reduce_range(const astnode *range, enum simd_op op, int64_t *fix,
+                          bignum **big) {
+  err_t err;
+  int count = range->as.range.count;
+  int64_t first, last, step_sum;
+  bignum *step_big = NULL;
+  astnode step_node = {0};
+
+  RETURN_VAL_IF(!count, ERR_NO_ERROR);
+  first = range_get(range, 0);
+  last = range_get(range, count - 1);
+
+  switch (op) {
+  case SIMD_ADD:
+    /* count * first + step * count * (count - 1) / 2 */
+    *fix = count;
+    err = fold_value(INT_MUL, fix, big, first);
+    RETURN_ERR_IF(err, err);
+    step_sum = (int64_t)count * (count - 1) / 2;
+    err = fold_value(INT_MUL, &step_sum, &step_big, range->as.range.step);
+    RETURN_ERR_IF(err, err);
+    step_node.type = step_big ? BIGNUM : NUMBER;
+    if (step_big)
+      step_node.as.big = step_big;
+    else
+      step_node.as.value = step_sum;
+    err = integer_apply(INT_ADD, fix, big, &step_node);
+    bignum_free(step_big);
+    return err;
+  case SIMD_MUL:
+    for (int i = 0; i < count && (*fix || *big); i++) {
+      err = fold_value(INT_MUL, fix, big, range_get(range, i));
+      RETURN_ERR_IF(err, err);
+    }
+    return ERR_NO_ERROR;
+  case SIMD_MIN:
+    *fix = first < last ? first : last;
+    return ERR_NO_ERROR;
+  default:
+    *fix = first > last ? first : last;
+    return ERR_NO_ERROR;
+  }
+}
+
+/**
+ * @brief Reduces the elements of a list node, all of them must be numbers
+ *
+ * @param list LIST type node
+ * @param op SIMD_ADD, SIMD_MUL, SIMD_MIN or SIMD_MAX
+ * @param acc in/out param, the accumulator
+ * @return err_t
+ */
+static err_t reduce_list(const astnode *list, enum simd_op op, num_acc *acc) {
+  err_t err;
+  const astnode *item, *best = NULL;
+
+  for (int i = 0; i < list->as.list.count; i++) {
+    item = list->as.list.children[i];
+    RETURN_ERR_IF(!is_numeric(item), ERR_SYNTAX_ERROR);
+    switch (op) {
+    case SIMD_ADD:
+    case SIMD_MUL:
+      err = number_apply(op == SIMD_MUL ? INT_MUL : INT_ADD, acc, item);
+      RETURN_ERR_IF(err, err);
+      break;
+    case SIMD_MIN:
+      if (!best || compare_numbers(item, best) < 0)
+        best = item;
+      break;
+    default:
+      if (!best || compare_numbers(item, best) > 0)
+        best = item;
+      break;
+    }
+  }
+
+  if (best && best->type == FLOAT) {
+    acc->is_float = 1;
+    acc->real = best->as.real;
+  } else if (best && best->type == BIGNUM) {
+    acc->big = bignum_copy(best->as.big);
+    RETURN_ERR_IF(!acc->big, ERR_OUT_OF_MEMORY);
+  } else if (best) {
+    acc->fix = best->as.value;
+  }
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Reduces all elements of a list or vector argument with SUM, PRODUCT,
+ * REDUCE-MIN or REDUCE-MAX in a single native loop and returns a NUMBER node.
+ * All elements must be numbers, REDUCE-MIN and REDUCE-MAX need at least one.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result NUMBER node with TEMPORARY
+ * origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_reduce(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 2, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  const char *symbol = list_node->as.list.children[0]->as.symbol;
+  enum simd_op op;
+  if (!strcmp(symbol, "SUM"))
+    op = SIMD_ADD;
+  else if (!strcmp(symbol, "PRODUCT"))
+    op = SIMD_MUL;
+  else if (!strcmp(symbol, "REDUCE-MIN"))
+    op = SIMD_MIN;
+  else if (!strcmp(symbol, "REDUCE-MAX"))
+    op = SIMD_MAX;
+  else
+    return ERR_INTERNAL;
+
+  err_t err, retval = ERR_NO_ERROR;
+  int count;
+  num_acc acc = {0};
+  astnode *seq = NULL;
+
+  err = eval_node(list_node->as.list.children[1], &seq, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(seq->type != LIST && seq->type != VECTOR &&
+                          seq->type != RANGE,
+                      cleanup, ERR_SYNTAX_ERROR);
+
+  if (seq->type == VECTOR)
+    count = seq->as.vector.count;
+  else if (seq->type == RANGE)
+    count = seq->as.range.count;
+  else
+    count = seq->as.list.count;
+  CLEANUP_WITH_ERR_IF(!count && (op == SIMD_MIN || op == SIMD_MAX), cleanup,
+                      ERR_SYNTAX_ERROR);
+
+  acc.fix = op == SIMD_MUL;
+  if (seq->type == VECTOR)
+    err = reduce_vector(seq, op, &acc);
+  else if (seq->type == RANGE)
+    err = reduce_range(seq, op, &acc.fix, &acc.big);
+  else
+    err = reduce_list(seq, op, &acc);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+  err = get_acc_node(&acc, result_node);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+cleanup:
+  bignum_free(acc.big);
+  free_temp_node_parts(seq);
+  return retval;
+}
+
+/**
+ * @brief Checks if two atomic nodes are equal, lists are never equal.
+ * Numbers are compared by value like =, so 1.0 equals 1.
+ *
+ * @param a first node
+ * @param b second node
+ * @return int 1 if equal, 0 otherwise
+ */
+static int atoms_equal(const astnode *a, const astnode *b) {
+  if (is_numeric(a) && is_numeric(b))
+    return !compare_numbers(a, b);
+  RETURN_VAL_IF(a->type != b->type, 0);
+  switch (a->type) {
+  case BOOLEAN:
+    return a->as.value == b->as.value;
+  case SYMBOL:
+    return !strcmp(a->as.symbol, b->as.symbol);
+  default:
+    return 0;
+  }
+}
+
+/**
+ * @brief Gets the 64-bit integer a NUMBER or an integral FLOAT node equals
+ *
+ * @param node to convert
+ * @param value out param for the integer
+ * @return int 1 if the node equals a 64-bit integer, 0 otherwise
+ */
+static int integer_value(const astnode *node, int64_t *value) {
+  if (node->type == NUMBER) {
+    *value = node->as.value;
+    return 1;
+  }
+  /* 2^63 is exact as a double, the range check has to come before the cast */
+  RETURN_VAL_IF(node->type != FLOAT || !(node->as.real >= -0x1p63) ||
+                    node->as.real >= 0x1p63,
+                0);
+  *value = (int64_t)node->as.real;
+  return (double)*value == node->as.real;
+}
+
+/**
+ * @brief Counts the elements of a list or vector equal to the value,
+ * (count-if-eq value sequence), and returns a NUMBER node.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result NUMBER node with TEMPORARY
+ * origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_count_if_eq(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int count = 0, integral;
+  int64_t value = 0;
+  astnode *needle = NULL, *seq = NULL, elem = {0};
+
+  err = eval_node(list_node->as.list.children[1], &needle, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(needle->type == LIST || needle->type == VECTOR ||
+                          needle->type == RANGE,
+                      cleanup, ERR_SYNTAX_ERROR);
+
+  err = eval_node(list_node->as.list.children[2], &seq, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+  /* numbers are equal by value like =, an integer vector or a range holds
+   * only numbers equal to a NUMBER or an integral FLOAT */
+  integral = integer_value(needle, &value);
+  if (seq->type == VECTOR) {
+    if (seq->as.vector.kind == VEC_F64) {
+      const double *reals = seq->as.vector.data;
+      elem.type = FLOAT;
+      for (int i = 0; is_numeric(needle) && i < seq->as.vector.count; i++) {
+        elem.as.real = reals[i];
+        count += !compare_numbers(needle, &elem);
+      }
+    } else if (integral && seq->as.vector.kind == VEC_INT64)
+      count = simd_count_eq_i64(seq->as.vector.data, seq->as.vector.count,
+                                value);
+    else if (integral && value >= INT32_MIN && value <= INT32_MAX)
+      count = simd_count_eq_i32(seq->as.vector.data, seq->as.vector.count,
+                                value);
+  } else if (seq->type == RANGE) {
+    /* a range holds distinct numbers, the needle is either one of them */
+    if (integral && seq->as.range.count) {
+      int64_t offset, index;
+      if (!__builtin_sub_overflow(value, seq->as.range.start, &offset)) {
+        index = offset / seq->as.range.step;
+        count = offset % seq->as.range.step == 0 && index >= 0 &&
+                index < seq->as.range.count;
+      }
+    }
+  } else {
+    CLEANUP_WITH_ERR_IF(seq->type != LIST, cleanup, ERR_SYNTAX_ERROR);
+    for (int i = 0; i < seq->as.list.count; i++)
+      count += atoms_equal(needle, seq->as.list.children[i]);
+  }
+
+  *result_node = get_number_node(count);
+  CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
+  (*result_node)->origin = TEMPORARY;
+
+cleanup:
+  free_temp_node_parts(needle);
+  free_temp_node_parts(seq);
+  return retval;
+}
+
+/**
+ * @brief Returns the count of items of a LIST, VECTOR or RANGE node
+ *
+ * @param seq LIST, VECTOR or RANGE type node
+ * @return int
+ */
+static int seq_count(const astnode *seq) {
+  switch (seq->type) {
+  case VECTOR:
+    return seq->as.vector.count;
+  case RANGE:
+    return seq->as.range.count;
+  default:
+    return seq->as.list.count;
+  }
+}
+
+/**
+ * @brief Returns the i-th item of a LIST, VECTOR or RANGE node, an element of
+ * a vector or range is built in the scratch node
+ *
+ * @param seq LIST, VECTOR or RANGE type node
+ * @param i index of the item
+ * @param scratch node to hold a vector or range element
+ * @return const astnode*
+ */
+static const astnode *seq_item(const astnode *seq, int i, astnode *scratch) {
+  switch (seq->type) {
+  case VECTOR:
+    if (seq->as.vector.kind == VEC_F64) {
+      scratch->type = FLOAT;
+      scratch->as.real = vector_get_real(seq, i);
+    } else {
+      scratch->type = NUMBER;
+      scratch->as.value = vector_get(seq, i);
+    }
+    return scratch;
+  case RANGE:
+    scratch->type = NUMBER;
+    scratch->as.value = range_get(seq, i);
+    return scratch;
+  default:
+    return seq->as.list.children[i];
+  }
+}
+
+/**
+ * @brief Evaluates a sequence argument of COUNT-BY or SUM-BY
+ *
+ * @param node to evaluate
+ * @param seq out param, the LIST, VECTOR or RANGE node
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t eval_group_seq(astnode *node, astnode **seq, env *env) {
+  err_t err, retval = ERR_NO_ERROR;
+
+  err = eval_node(node, seq, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF((*seq)->type != LIST && (*seq)->type != VECTOR &&
+                          (*seq)->type != RANGE,
+                      fail_cleanup, ERR_SYNTAX_ERROR);
+  return retval;
+fail_cleanup:
+  free_temp_node_parts(*seq);
+  *seq = NULL;
+  return retval;
+}
+
+/**
+ * @brief Adds the value to the sum stored under the key, a missing key
+ * starts from zero. Fixnum and float sums are updated in place.
+ *
+ * @param table to update
+ * @param key a valid key node
+ * @param value NUMBER, BIGNUM or FLOAT node
+ * @return err_t
+ */
+static err_t add_to_group(hashtable *table, const astnode *key,
+                          const astnode *value) {
+  err_t err, retval = ERR_NO_ERROR;
+  num_acc acc = {0};
+  int64_t fix;
+  astnode *sum = hash_table_get(table, key), *new_sum = NULL;
+
+  RETURN_ERR_IF(!is_numeric(value), ERR_SYNTAX_ERROR);
+  if (sum && sum->type == NUMBER && value->type == NUMBER &&
+      !__builtin_add_overflow(sum->as.value, value->as.value, &fix)) {
+    sum->as.value = fix;
+    return ERR_NO_ERROR;
+  }
+  if (sum && sum->type == FLOAT && value->type != BIGNUM) {
+    sum->as.real += to_real(value);
+    return ERR_NO_ERROR;
+  }
+
+  /* overflow into a bignum, bignum operands and the first value of a key */
+  if (sum) {
+    err = number_apply(INT_ADD, &acc, sum);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  }
+  err = number_apply(INT_ADD, &acc, value);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  err = get_acc_node(&acc, &new_sum);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  new_sum->origin = VARIABLE;
+  err = hash_table_put(table, key, new_sum);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  new_sum = NULL;
+
+cleanup:
+  free_node(new_sum);
+  bignum_free(acc.big);
+  return retval;
+}
+
+/**
+ * @brief Counts the occurrences of every key of a list, vector or range in a
+ * single pass, (count-by keys). Keys are numbers, symbols and booleans.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result HASH node with TEMPORARY
+ * origin mapping each key to its count, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_count_by(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 2, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int count;
+  astnode scratch = {0};
+  const astnode *key;
+  astnode *keys = NULL, *result = NULL, *counter = NULL, *one = NULL;
+
+  err = eval_group_seq(list_node->as.list.children[1], &keys, env);
+  RETURN_ERR_IF(err, err);
+  count = seq_count(keys);
+  result = get_hash_node(count < GROUP_INITIAL_KEYS ? count
+                                                    : GROUP_INITIAL_KEYS);
+  CLEANUP_WITH_ERR_IF(!result, cleanup, ERR_OUT_OF_MEMORY);
+  result->origin = TEMPORARY;
+
+  for (int i = 0; i < count; i++) {
+    key = seq_item(keys, i, &scratch);
+    CLEANUP_WITH_ERR_IF(!is_hash_key(key), cleanup, ERR_SYNTAX_ERROR);
+    counter = hash_table_get(result->as.hash, key);
+    if (counter) {
+      counter->as.value++;
+      continue;
+    }
+    one = get_number_node(1);
+    CLEANUP_WITH_ERR_IF(!one, cleanup, ERR_OUT_OF_MEMORY);
+    one->origin = VARIABLE;
+    err = hash_table_put(result->as.hash, key, one);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    one = NULL;
+  }
+
+  *result_node = result;
+  result = NULL;
+
+cleanup:
+  free_node(one);
+  free_temp_node_parts(result);
+  free_temp_node_parts(keys);
+  return retval;
+}
+
+/**
+ * @brief Sums the values of every key in a single pass, (sum-by keys
+ * values). The values are a list, vector or range of numbers of the same
+ * length as the keys, the value at index i is added to the key at index i.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result HASH node with TEMPORARY
+ * origin mapping each key to its sum, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_sum_by(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int count;
+  astnode key_scratch = {0}, value_scratch = {0};
+  const astnode *key;
+  astnode *keys = NULL, *values = NULL, *result = NULL;
+
+  err = eval_group_seq(list_node->as.list.children[1], &keys, env);
+  RETURN_ERR_IF(err, err);
+  err = eval_group_seq(list_node->as.list.children[2], &values, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  count = seq_count(keys);
+  CLEANUP_WITH_ERR_IF(seq_count(values) != count, cleanup, ERR_SYNTAX_ERROR);
+
+  result = get_hash_node(count < GROUP_INITIAL_KEYS ? count
+                                                    : GROUP_INITIAL_KEYS);
+  CLEANUP_WITH_ERR_IF(!result, cleanup, ERR_OUT_OF_MEMORY);
+  result->origin = TEMPORARY;
+
+  for (int i = 0; i < count; i++) {
+    key = seq_item(keys, i, &key_scratch);
+    CLEANUP_WITH_ERR_IF(!is_hash_key(key), cleanup, ERR_SYNTAX_ERROR);
+    err = add_to_group(result->as.hash, key,
+                       seq_item(values, i, &value_scratch));
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  }
+
+  *result_node = result;
+  result = NULL;
+
+cleanup:
+  free_temp_node_parts(result);
+  free_temp_node_parts(keys);
+  free_temp_node_parts(values);
+  return retval;
+}
@@ -0,0 +1,320 @@
+#include "set.h"
+#include "ast.h"
+#include "bignum.h"
+#include "env.h"
+#include "err.h"
+#include "hash.h"
+#include "macros.h"
+#include "number.h"
+#include "range.h"
+#include "sort.h"
+#include "vector.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Elements of a set argument. Items of a list are borrowed, elements
+ * of vectors and ranges are built in the owned `scratch` array.
+ */
+struct elements {
+  astnode **items;
+  astnode *scratch;
+  int count;
+};
+
+/**
+ * @brief Index of distinct elements, the hash slots hold positions in
+ * `items`. Without slots lookups scan the items.
+ */
+struct lookup {
+  astnode **items;
+  int count;
+  int *slots;
+  int mask;
+};
+
+/**
+ * @brief Checks whether the node can be an element of a set
+ *
+ * @param item node to check
+ * @return int 1 if it can, 0 otherwise
+ */
+static int is_element(const astnode *item) {
+  return is_numeric(item) || item->type == SYMBOL || item->type == BOOLEAN;
+}
+
+/**
+ * @brief Hashes a set element consistently with compare_nodes, so a float
+ * with an integral value hashes like the integer
+ *
+ * @param item NUMBER, BIGNUM, FLOAT, SYMBOL or BOOLEAN node
+ * @return uint64_t
+ */
+static uint64_t element_hash(const astnode *item) {
+  astnode key = {0};
+  double real = 0;
+  uint64_t bits;
+
+  switch (item->type) {
+  case FLOAT:
+    real = item->as.real;
+    break;
+  case BIGNUM:
+    /* a double close to the bignum, exact when a float equals it */
+    for (int i = item->as.big->count - 1; i >= 0; i--)
+      real = real * 4294967296.0 + item->as.big->limbs[i];
+    real = item->as.big->sign < 0 ? -real : real;
+    break;
+  default:
+    return hash_node(item);
+  }
+
+  key.type = NUMBER;
+  if (isnan(real)) {
+    key.as.value = INT64_MIN;
+  } else if (real >= -9223372036854775808.0 &&
+             real < 9223372036854775808.0 && (double)(int64_t)real == real) {
+    key.as.value = (int64_t)real;
+  } else {
+    memcpy(&bits, &real, sizeof(bits));
+    key.as.value = (int64_t)bits;
+  }
+  return hash_node(&key);
+}
+
+/**
+ * @brief Prepares an empty index for up to `capacity` elements, hashed if
+ * there are more of them than SET_PAIRWISE_LIMIT
+ *
+ * @param lookup to initialize
+ * @param capacity maximal count of elements
+ * @return err_t
+ */
+static err_t lookup_init(struct lookup *lookup, int capacity) {
+  int size = 1;
+
+  lookup->count = 0;
+  lookup->slots = NULL;
+  lookup->items = malloc((capacity ? capacity : 1) * sizeof(astnode *));
+  RETURN_ERR_IF(!lookup->items, ERR_OUT_OF_MEMORY);
+  RETURN_VAL_IF(capacity <= SET_PAIRWISE_LIMIT, ERR_NO_ERROR);
+
+  /* at most half full keeps the linear probes short */
+  while (size < 2 * capacity)
+    size *= 2;
+  lookup->slots = malloc(size * sizeof(int));
+  RETURN_ERR_IF(!lookup->slots, ERR_OUT_OF_MEMORY);
+  memset(lookup->slots, 0xff, size * sizeof(int));
+  lookup->mask = size - 1;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Frees the arrays of the index, not the elements
+ *
+ * @param lookup to free
+ */
+static void lookup_free(struct lookup *lookup) {
+  free(lookup->items);
+  free(lookup->slots);
+}
+
+/**
+ * @brief Looks the element up in the index
+ *
+ * @param lookup to search
+ * @param item element to find
+ * @param add insert the element when it is missing if nonzero
+ * @return int 1 if the element was present, 0 otherwise
+ */
+static int lookup_find(struct lookup *lookup, astnode *item, int add) {
+  int slot = -1;
+
+  if (!lookup->slots) {
+    for (int i = 0; i < lookup->count; i++)
+      RETURN_VAL_IF(!compare_nodes(lookup->items[i], item), 1);
+  } else {
+    slot = (int)(element_hash(item) & lookup->mask);
+    for (; lookup->slots[slot] >= 0; slot = (slot + 1) & lookup->mask)
+      RETURN_VAL_IF(!compare_nodes(lookup->items[lookup->slots[slot]], item),
+                    1);
+  }
+
+  if (add) {
+    if (slot >= 0)
+      lookup->slots[slot] = lookup->count;
+    lookup->items[lookup->count++] = item;
+  }
+  return 0;
+}
+
+/**
+ * @brief Checks whether any two of the items are equal. Numbers are equal by
+ * value whether integer or float, symbols by name. Small inputs are compared
+ * pairwise, larger ones through a hash index.
+ *
+ * @param items NUMBER, BIGNUM, FLOAT, SYMBOL or BOOLEAN nodes
+ * @param count count of items
+ * @param found out param, 1 if two items are equal, 0 otherwise
+ * @return err_t
+ */
+err_t has_duplicates(astnode *const *items, int count, int *found) {
+  /* sanity check */
+  RETURN_ERR_IF(!items || !found, ERR_INTERNAL);
+
+  struct lookup seen;
+  err_t err = lookup_init(&seen, count);
+  if (err) {
+    lookup_free(&seen);
+    return err;
+  }
+
+  *found = 0;
+  for (int i = 0; !*found && i < count; i++)
+    *found = lookup_find(&seen, items[i], 1);
+  lookup_free(&seen);
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Collects the elements of a set argument
+ *
+ * @param seq LIST, VECTOR or RANGE node
+ * @param elems out param, the elements, to be freed with free_elements
+ * @return err_t
+ */
+static err_t load_elements(astnode *seq, struct elements *elems) {
+  RETURN_ERR_IF(seq->type != LIST && seq->type != VECTOR && seq->type != RANGE,
+                ERR_SYNTAX_ERROR);
+
+  if (seq->type == LIST) {
+    for (int i = 0; i < seq->as.list.count; i++)
+      RETURN_ERR_IF(!is_element(seq->as.list.children[i]), ERR_SYNTAX_ERROR);
+    elems->items = seq->as.list.children;
+    elems->count = seq->as.list.count;
+    return ERR_NO_ERROR;
+  }
+
+  elems->count = seq->type == VECTOR ? seq->as.vector.count
+                                     : seq->as.range.count;
+  elems->scratch = calloc(elems->count ? elems->count : 1, sizeof(astnode));
+  elems->items = malloc((elems->count ? elems->count : 1) * sizeof(astnode *));
+  RETURN_ERR_IF(!elems->scratch || !elems->items, ERR_OUT_OF_MEMORY);
+
+  for (int i = 0; i < elems->count; i++) {
+    astnode *item = &elems->scratch[i];
+    if (seq->type == RANGE) {
+      item->type = NUMBER;
+      item->as.value = range_get(seq, i);
+    } else if (seq->as.vector.kind == VEC_F64) {
+      item->type = FLOAT;
+      item->as.real = vector_get_real(seq, i);
+    } else {
+      item->type = NUMBER;
+      item->as.value = vector_get(seq, i);
+    }
+    elems->items[i] = item;
+  }
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Frees the arrays of the elements built by load_elements
+ *
+ * @param elems to free
+ */
+static void free_elements(struct elements *elems) {
+  if (elems->scratch)
+    free(elems->items);
+  free(elems->scratch);
+}
+
+/**
+ * @brief Set operations on lists, vectors or ranges of numbers, symbols and
+ * booleans: (distinct a), (union a b), (intersection a b) and
+ * (set-difference a b). The resulting list holds every element once, in the
+ * order of its first occurrence in a, then b. Numbers are equal by value
+ * whether integer or float. Small inputs are compared pairwise, larger ones
+ * through a hash index, so the operations run in linear time.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result TEMPORARY LIST node,
+ * NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_set_op(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  const char *symbol = list_node->as.list.children[0]->as.symbol;
+  int distinct = !strcmp(symbol, "DISTINCT");
+  int keep_common = !strcmp(symbol, "INTERSECTION");
+  int is_union = !strcmp(symbol, "UNION");
+  RETURN_ERR_IF(list_node->as.list.count != (distinct ? 2 : 3),
+                ERR_SYNTAX_ERROR);
+
+  err_t err, retval = ERR_NO_ERROR;
+  struct elements a = {0}, b = {0};
+  struct lookup seen = {0}, other = {0};
+  astnode *seq_a = NULL, *seq_b = NULL, *result = NULL, *copy = NULL;
+
+  err = eval_node(list_node->as.list.children[1], &seq_a, env);
+  RETURN_ERR_IF(err, err);
+  err = load_elements(seq_a, &a);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  if (!distinct) {
+    err = eval_node(list_node->as.list.children[2], &seq_b, env);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    err = load_elements(seq_b, &b);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  }
+
+  err = lookup_init(&seen, a.count + (is_union ? b.count : 0));
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+  if (distinct || is_union) {
+    for (int i = 0; i < a.count; i++)
+      lookup_find(&seen, a.items[i], 1);
+    for (int i = 0; i < b.count; i++)
+      lookup_find(&seen, b.items[i], 1);
+  } else {
+    /* index b once, then keep the elements of a by their membership */
+    err = lookup_init(&other, b.count);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    for (int i = 0; i < b.count; i++)
+      lookup_find(&other, b.items[i], 1);
+    for (int i = 0; i < a.count; i++) {
+      if (lookup_find(&other, a.items[i], 0) == keep_common)
+        lookup_find(&seen, a.items[i], 1);
+    }
+  }
+
+  result = get_list_node();
+  CLEANUP_WITH_ERR_IF(!result, cleanup, ERR_OUT_OF_MEMORY);
+  result->origin = TEMPORARY;
+  err = reserve_children(result, seen.count);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  for (int i = 0; i < seen.count; i++) {
+    err = make_deep_copy(seen.items[i], &copy, TEMPORARY);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    result->as.list.children[result->as.list.count++] = copy;
+  }
+
+  *result_node = result;
+  result = NULL;
+
+cleanup:
+  free_temp_node_parts(result);
+  lookup_free(&seen);
+  lookup_free(&other);
+  free_elements(&a);
+  free_elements(&b);
+  free_temp_node_parts(seq_a);
+  free_temp_node_parts(seq_b);
+  return retval;
+}
@@ -0,0 +1,782 @@
+#include "simd.h"
+#include <stdint.h>
+
+/* x86 kernels are compiled with function level target attributes and chosen
+ * at runtime, so the binary still runs on CPUs without AVX2 */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+enum simd_level {
+  LEVEL_SCALAR,
+  LEVEL_SSE41,
+  LEVEL_AVX2,
+};
+
+/**
+ * @brief Detects the best instruction set available, only once
+ *
+ * @return enum simd_level
+ */
+static enum simd_level get_simd_level(void) {
+  static int level = -1;
+  if (level >= 0)
+    return level;
+  level = LEVEL_SCALAR;
+#ifdef SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    level = LEVEL_AVX2;
+  else if (__builtin_cpu_supports("sse4.1"))
+    level = LEVEL_SSE41;
+#endif
+  return level;
+}
+
+/**
+ * @brief Scalar kernel for 32-bit integers, also handles the tails of the
+ * vectorized loops. Arithmetic is done unsigned to wrap around on overflow.
+ */
+static void binop_i32_scalar(enum simd_op op, int32_t *dst, const int32_t *a,
+                             const int32_t *b, int from, int n) {
+  int i;
+  switch (op) {
+  case SIMD_ADD:
+    for (i = from; i < n; i++)
+      dst[i] = (int32_t)((uint32_t)a[i] + (uint32_t)b[i]);
+    break;
+  case SIMD_SUB:
+    for (i = from; i < n; i++)
+      dst[i] = (int32_t)((uint32_t)a[i] - (uint32_t)b[i]);
+    break;
+  case SIMD_MUL:
+    for (i = from; i < n; i++)
+      dst[i] = (int32_t)((uint32_t)a[i] * (uint32_t)b[i]);
+    break;
+  case SIMD_MIN:
+    for (i = from; i < n; i++)
+      dst[i] = a[i] < b[i] ? a[i] : b[i];
+    break;
+  case SIMD_MAX:
+    for (i = from; i < n; i++)
+      dst[i] = a[i] > b[i] ? a[i] : b[i];
+    break;
+  }
+}
+
+/**
+ * @brief Scalar kernel for 64-bit integers, see binop_i32_scalar
+ */
+static void binop_i64_scalar(enum simd_op op, int64_t *dst, const int64_t *a,
+                             const int64_t *b, int from, int n) {
+  int i;
+  switch (op) {
+  case SIMD_ADD:
+    for (i = from; i < n; i++)
+      dst[i] = (int64_t)((uint64_t)a[i] + (uint64_t)b[i]);
+    break;
+  case SIMD_SUB:
+    for (i = from; i < n; i++)
+      dst[i] = (int64_t)((uint64_t)a[i] - (uint64_t)b[i]);
+    break;
+  case SIMD_MUL:
+    for (i = from; i < n; i++)
+      dst[i] = (int64_t)((uint64_t)a[i] * (uint64_t)b[i]);
+    break;
+  case SIMD_MIN:
+    for (i = from; i < n; i++)
+      dst[i] = a[i] < b[i] ? a[i] : b[i];
+    break;
+  case SIMD_MAX:
+    for (i = from; i < n; i++)
+      dst[i] = a[i] > b[i] ? a[i] : b[i];
+    break;
+  }
+}
+
+/**
+ * @brief Scalar kernel for doubles, see binop_i32_scalar
+ */
+static void binop_f64_scalar(enum simd_op op, double *dst, const double *a,
+                             const double *b, int from, int n) {
+  int i;
+  switch (op) {
+  case SIMD_ADD:
+    for (i = from; i < n; i++)
+      dst[i] = a[i] + b[i];
+    break;
+  case SIMD_SUB:
+    for (i = from; i < n; i++)
+      dst[i] = a[i] - b[i];
+    break;
+  case SIMD_MUL:
+    for (i = from; i < n; i++)
+      dst[i] = a[i] * b[i];
+    break;
+  case SIMD_MIN:
+    for (i = from; i < n; i++)
+      dst[i] = a[i] < b[i] ? a[i] : b[i];
+    break;
+  case SIMD_MAX:
+    for (i = from; i < n; i++)
+      dst[i] = a[i] > b[i] ? a[i] : b[i];
+    break;
+  }
+}
+
+#ifdef SIMD_X86
+__attribute__((target("avx2"))) static int
+binop_i32_avx2(enum simd_op op, int32_t *dst, const int32_t *a,
+               const int32_t *b, int n) {
+  int i;
+  __m256i x, y, r;
+  for (i = 0; i + 8 <= n; i += 8) {
+    x = _mm256_loadu_si256((const __m256i *)(a + i));
+    y = _mm256_loadu_si256((const __m256i *)(b + i));
+    switch (op) {
+    case SIMD_ADD:
+      r = _mm256_add_epi32(x, y);
+      break;
+    case SIMD_SUB:
+      r = _mm256_sub_epi32(x, y);
+      break;
+    case SIMD_MUL:
+      r = _mm256_mullo_epi32(x, y);
+      break;
+    case SIMD_MIN:
+      r = _mm256_min_epi32(x, y);
+      break;
+    default:
+      r = _mm256_max_epi32(x, y);
+      break;
+    }
+    _mm256_storeu_si256((__m256i *)(dst + i), r);
+  }
+  return i;
+}
+
+__attribute__((target("sse4.1"))) static int
+binop_i32_sse41(enum simd_op op, int32_t *dst, const int32_t *a,
+                const int32_t *b, int n) {
+  int i;
+  __m128i x, y, r;
+  for (i = 0; i + 4 <= n; i += 4) {
+    x = _mm_loadu_si128((const __m128i *)(a + i));
+    y = _mm_loadu_si128((const __m128i *)(b + i));
+    switch (op) {
+    case SIMD_ADD:
+      r = _mm_add_epi32(x, y);
+      break;
+    case SIMD_SUB:
+      r = _mm_sub_epi32(x, y);
+      break;
+    case SIMD_MUL:
+      r = _mm_mullo_epi32(x, y);
+      break;
+    case SIMD_MIN:
+      r = _mm_min_epi32(x, y);
+      break;
+    default:
+      r = _mm_max_epi32(x, y);
+      break;
+    }
+    _mm_storeu_si128((__m128i *)(dst + i), r);
+  }
+  return i;
+}
+
+/* AVX2 has no 64-bit multiply, SIMD_MUL is left to the scalar loop */
+__attribute__((target("avx2"))) static int
+binop_i64_avx2(enum simd_op op, int64_t *dst, const int64_t *a,
+               const int64_t *b, int n) {
+  int i;
+  __m256i x, y, r;
+  if (op == SIMD_MUL)
+    return 0;
+  for (i = 0; i + 4 <= n; i += 4) {
+    x = _mm256_loadu_si256((const __m256i *)(a + i));
+    y = _mm256_loadu_si256((const __m256i *)(b + i));
+    switch (op) {
+    case SIMD_ADD:
+      r = _mm256_add_epi64(x, y);
+      break;
+    case SIMD_SUB:
+      r = _mm256_sub_epi64(x, y);
+      break;
+    case SIMD_MIN:
+      r = _mm256_blendv_epi8(x, y, _mm256_cmpgt_epi64(x, y));
+      break;
+    default:
+      r = _mm256_blendv_epi8(y, x, _mm256_cmpgt_epi64(x, y));
+      break;
+    }
+    _mm256_storeu_si256((__m256i *)(dst + i), r);
+  }
+  return i;
+}
+
+/* the packed min and max return the second operand when the first is not
+ * less or greater, like the scalar kernel */
+__attribute__((target("avx"))) static int
+binop_f64_avx(enum simd_op op, double *dst, const double *a, const double *b,
+              int n) {
+  int i;
+  __m256d x, y, r;
+  for (i = 0; i + 4 <= n; i += 4) {
+    x = _mm256_loadu_pd(a + i);
+    y = _mm256_loadu_pd(b + i);
+    switch (op) {
+    case SIMD_ADD:
+      r = _mm256_add_pd(x, y);
+      break;
+    case SIMD_SUB:
+      r = _mm256_sub_pd(x, y);
+      break;
+    case SIMD_MUL:
+      r = _mm256_mul_pd(x, y);
+      break;
+    case SIMD_MIN:
+      r = _mm256_min_pd(x, y);
+      break;
+    default:
+      r = _mm256_max_pd(x, y);
+      break;
+    }
+    _mm256_storeu_pd(dst + i, r);
+  }
+  return i;
+}
+
+__attribute__((target("sse2"))) static int
+binop_f64_sse2(enum simd_op op, double *dst, const double *a, const double *b,
+               int n) {
+  int i;
+  __m128d x, y, r;
+  for (i = 0; i + 2 <= n; i += 2) {
+    x = _mm_loadu_pd(a + i);
+    y = _mm_loadu_pd(b + i);
+    switch (op) {
+    case SIMD_ADD:
+      r = _mm_add_pd(x, y);
+      break;
+    case SIMD_SUB:
+      r = _mm_sub_pd(x, y);
+      break;
+    case SIMD_MUL:
+      r = _mm_mul_pd(x, y);
+      break;
+    case SIMD_MIN:
+      r = _mm_min_pd(x, y);
+      break;
+    default:
+      r = _mm_max_pd(x, y);
+      break;
+    }
+    _mm_storeu_pd(dst + i, r);
+  }
+  return i;
+}
+#endif
+
+/**
+ * @brief Computes dst[i] = a[i] op b[i] for n 32-bit integers.
+ * Uses AVX2 or SSE4.1 when the CPU supports it, scalar code otherwise.
+ * The results wrap around on overflow, dst may alias a or b.
+ *
+ * @param op operation to apply
+ * @param dst output array of n elements
+ * @param a left operands
+ * @param b right operands
+ * @param n count of elements
+ */
+void simd_binop_i32(enum simd_op op, int32_t *dst, const int32_t *a,
+                    const int32_t *b, int n) {
+  int done = 0;
+#ifdef SIMD_X86
+  switch (get_simd_level()) {
+  case LEVEL_AVX2:
+    done = binop_i32_avx2(op, dst, a, b, n);
+    break;
+  case LEVEL_SSE41:
+    done = binop_i32_sse41(op, dst, a, b, n);
+    break;
+  default:
+    break;
+  }
+#endif
+  binop_i32_scalar(op, dst, a, b, done, n);
+}
+
+/**
+ * @brief Computes dst[i] = a[i] op b[i] for n 64-bit integers.
+ * Uses AVX2 when the CPU supports it, scalar code otherwise.
+ * The results wrap around on overflow, dst may alias a or b.
+ *
+ * @param op operation to apply
+ * @param dst output array of n elements
+ * @param a left operands
+ * @param b right operands
+ * @param n count of elements
+ */
+void simd_binop_i64(enum simd_op op, int64_t *dst, const int64_t *a,
+                    const int64_t *b, int n) {
+  int done = 0;
+#ifdef SIMD_X86
+  if (get_simd_level() == LEVEL_AVX2)
+    done = binop_i64_avx2(op, dst, a, b, n);
+#endif
+  binop_i64_scalar(op, dst, a, b, done, n);
+}
+
+/**
+ * @brief Computes dst[i] = a[i] op b[i] for n doubles.
+ * Uses AVX or SSE2 when the CPU supports it, scalar code otherwise.
+ * dst may alias a or b.
+ *
+ * @param op operation to apply
+ * @param dst output array of n elements
+ * @param a left operands
+ * @param b right operands
+ * @param n count of elements
+ */
+void simd_binop_f64(enum simd_op op, double *dst, const double *a,
+                    const double *b, int n) {
+  int done = 0;
+#ifdef SIMD_X86
+  switch (get_simd_level()) {
+  case LEVEL_AVX2:
+    done = binop_f64_avx(op, dst, a, b, n);
+    break;
+  case LEVEL_SSE41:
+    done = binop_f64_sse2(op, dst, a, b, n);
+    break;
+  default:
+    break;
+  }
+#endif
+  binop_f64_scalar(op, dst, a, b, done, n);
+}
+
+/**
+ * @brief Merges value into the running reduction result
+ */
+static int64_t reduce_step(enum simd_op op, int64_t acc, int64_t value) {
+  switch (op) {
+  case SIMD_MIN:
+    return value < acc ? value : acc;
+  case SIMD_MAX:
+    return value > acc ? value : acc;
+  default:
+    return (int64_t)((uint64_t)acc + (uint64_t)value);
+  }
+}
+
+/**
+ * @brief Merges value into the running reduction result of doubles
+ */
+static double reduce_step_f64(enum simd_op op, double acc, double value) {
+  switch (op) {
+  case SIMD_MIN:
+    return value < acc ? value : acc;
+  case SIMD_MAX:
+    return value > acc ? value : acc;
+  case SIMD_MUL:
+    return acc * value;
+  default:
+    return acc + value;
+  }
+}
+
+#ifdef SIMD_X86
+__attribute__((target("avx2"))) static int
+reduce_i32_avx2(enum simd_op op, const int32_t *a, int n, int64_t *acc) {
+  int i, k;
+  int64_t lanes64[4];
+  int32_t lanes32[8];
+  __m256i x, sum = _mm256_setzero_si256(), ext = _mm256_set1_epi32(a[0]);
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    x = _mm256_loadu_si256((const __m256i *)(a + i));
+    if (op == SIMD_ADD) {
+      /* widen to 64 bits, the sum of 32-bit lanes could overflow */
+      sum = _mm256_add_epi64(
+          sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+      sum = _mm256_add_epi64(
+          sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+    } else if (op == SIMD_MIN) {
+      ext = _mm256_min_epi32(ext, x);
+    } else {
+      ext = _mm256_max_epi32(ext, x);
+    }
+  }
+
+  if (op == SIMD_ADD) {
+    _mm256_storeu_si256((__m256i *)lanes64, sum);
+    for (k = 0; k < 4; k++)
+      *acc = reduce_step(op, *acc, lanes64[k]);
+  } else {
+    _mm256_storeu_si256((__m256i *)lanes32, ext);
+    for (k = 0; k < 8; k++)
+      *acc = reduce_step(op, *acc, lanes32[k]);
+  }
+  return i;
+}
+
+__attribute__((target("sse4.1"))) static int
+reduce_i32_sse41(enum simd_op op, const int32_t *a, int n, int64_t *acc) {
+  int i, k;
+  int64_t lanes64[2];
+  int32_t lanes32[4];
+  __m128i x, sum = _mm_setzero_si128(), ext = _mm_set1_epi32(a[0]);
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    x = _mm_loadu_si128((const __m128i *)(a + i));
+    if (op == SIMD_ADD) {
+      sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(x));
+      sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(_mm_srli_si128(x, 8)));
+    } else if (op == SIMD_MIN) {
+      ext = _mm_min_epi32(ext, x);
+    } else {
+      ext = _mm_max_epi32(ext, x);
+    }
+  }
+
+  if (op == SIMD_ADD) {
+    _mm_storeu_si128((__m128i *)lanes64, sum);
+    for (k = 0; k < 2; k++)
+      *acc = reduce_step(op, *acc, lanes64[k]);
+  } else {
+    _mm_storeu_si128((__m128i *)lanes32, ext);
+    for (k = 0; k < 4; k++)
+      *acc = reduce_step(op, *acc, lanes32[k]);
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) static int
+reduce_i64_avx2(enum simd_op op, const int64_t *a, int n, int64_t *acc) {
+  int i, k;
+  int64_t lanes[4];
+  __m256i x, r = op == SIMD_ADD ? _mm256_setzero_si256()
+                                : _mm256_set1_epi64x(a[0]);
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    x = _mm256_loadu_si256((const __m256i *)(a + i));
+    if (op == SIMD_ADD)
+      r = _mm256_add_epi64(r, x);
+    else if (op == SIMD_MIN)
+      r = _mm256_blendv_epi8(r, x, _mm256_cmpgt_epi64(r, x));
+    else
+      r = _mm256_blendv_epi8(x, r, _mm256_cmpgt_epi64(r, x));
+  }
+
+  _mm256_storeu_si256((__m256i *)lanes, r);
+  for (k = 0; k < 4; k++)
+    *acc = reduce_step(op, *acc, lanes[k]);
+  return i;
+}
+
+__attribute__((target("avx"))) static int
+reduce_f64_avx(enum simd_op op, const double *a, int n, double *acc) {
+  int i, k;
+  double lanes[4];
+  __m256d x, r = op == SIMD_ADD   ? _mm256_setzero_pd()
+                 : op == SIMD_MUL ? _mm256_set1_pd(1)
+                                  : _mm256_set1_pd(a[0]);
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    x = _mm256_loadu_pd(a + i);
+    if (op == SIMD_ADD)
+      r = _mm256_add_pd(r, x);
+    else if (op == SIMD_MUL)
+      r = _mm256_mul_pd(r, x);
+    else if (op == SIMD_MIN)
+      r = _mm256_min_pd(x, r);
+    else
+      r = _mm256_max_pd(x, r);
+  }
+
+  _mm256_storeu_pd(lanes, r);
+  for (k = 0; k < 4; k++)
+    *acc = reduce_step_f64(op, *acc, lanes[k]);
+  return i;
+}
+
+__attribute__((target("sse2"))) static int
+reduce_f64_sse2(enum simd_op op, const double *a, int n, double *acc) {
+  int i, k;
+  double lanes[2];
+  __m128d x, r = op == SIMD_ADD   ? _mm_setzero_pd()
+                 : op == SIMD_MUL ? _mm_set1_pd(1)
+                                  : _mm_set1_pd(a[0]);
+
+  for (i = 0; i + 2 <= n; i += 2) {
+    x = _mm_loadu_pd(a + i);
+    if (op == SIMD_ADD)
+      r = _mm_add_pd(r, x);
+    else if (op == SIMD_MUL)
+      r = _mm_mul_pd(r, x);
+    else if (op == SIMD_MIN)
+      r = _mm_min_pd(x, r);
+    else
+      r = _mm_max_pd(x, r);
+  }
+
+  _mm_storeu_pd(lanes, r);
+  for (k = 0; k < 2; k++)
+    *acc = reduce_step_f64(op, *acc, lanes[k]);
+  return i;
+}
+
+__attribute__((target("avx2"))) static int
+count_eq_i32_avx2(const int32_t *a, int n, int32_t x, int *count) {
+  int i, k;
+  int32_t lanes[8];
+  __m256i needle = _mm256_set1_epi32(x), hits = _mm256_setzero_si256();
+
+  /* matching lanes compare to -1, subtracting counts them */
+  for (i = 0; i + 8 <= n; i += 8)
+    hits = _mm256_sub_epi32(
+        hits, _mm256_cmpeq_epi32(
+                  needle, _mm256_loadu_si256((const __m256i *)(a + i))));
+
+  _mm256_storeu_si256((__m256i *)lanes, hits);
+  for (k = 0; k < 8; k++)
+    *count += lanes[k];
+  return i;
+}
+
+__attribute__((target("sse4.1"))) static int
+count_eq_i32_sse41(const int32_t *a, int n, int32_t x, int *count) {
+  int i, k;
+  int32_t lanes[4];
+  __m128i needle = _mm_set1_epi32(x), hits = _mm_setzero_si128();
+
+  for (i = 0; i + 4 <= n; i += 4)
+    hits = _mm_sub_epi32(
+        hits,
+        _mm_cmpeq_epi32(needle, _mm_loadu_si128((const __m128i *)(a + i))));
+
+  _mm_storeu_si128((__m128i *)lanes, hits);
+  for (k = 0; k < 4; k++)
+    *count += lanes[k];
+  return i;
+}
+
+__attribute__((target("avx2"))) static int
+count_eq_i64_avx2(const int64_t *a, int n, int64_t x, int *count) {
+  int i, k;
+  int64_t lanes[4];
+  __m256i needle = _mm256_set1_epi64x(x), hits = _mm256_setzero_si256();
+
+  for (i = 0; i + 4 <= n; i += 4)
+    hits = _mm256_sub_epi64(
+        hits, _mm256_cmpeq_epi64(
+                  needle, _mm256_loadu_si256((const __m256i *)(a + i))));
+
+  _mm256_storeu_si256((__m256i *)lanes, hits);
+  for (k = 0; k < 4; k++)
+    *count += (int)lanes[k];
+  return i;
+}
+#endif
+
+/**
+ * @brief Reduces n 32-bit integers with SIMD_ADD, SIMD_MIN or SIMD_MAX.
+ * The sum is accumulated in 64 bits so it does not overflow, minimum and
+ * maximum require n > 0.
+ *
+ * @param op SIMD_ADD, SIMD_MIN or SIMD_MAX
+ * @param a elements to reduce
+ * @param n count of elements
+ * @return int64_t
+ */
+int64_t simd_reduce_i32(enum simd_op op, const int32_t *a, int n) {
+  int i = 0;
+  int64_t acc = (op == SIMD_ADD || !n) ? 0 : a[0];
+#ifdef SIMD_X86
+  switch (n ? get_simd_level() : LEVEL_SCALAR) {
+  case LEVEL_AVX2:
+    i = reduce_i32_avx2(op, a, n, &acc);
+    break;
+  case LEVEL_SSE41:
+    i = reduce_i32_sse41(op, a, n, &acc);
+    break;
+  default:
+    break;
+  }
+#endif
+  for (; i < n; i++)
+    acc = reduce_step(op, acc, a[i]);
+  return acc;
+}
+
+/**
+ * @brief Reduces n 64-bit integers with SIMD_ADD, SIMD_MIN or SIMD_MAX.
+ * The sum wraps around on overflow, minimum and maximum require n > 0.
+ *
+ * @param op SIMD_ADD, SIMD_MIN or SIMD_MAX
+ * @param a elements to reduce
+ * @param n count of elements
+ * @return int64_t
+ */
+int64_t simd_reduce_i64(enum simd_op op, const int64_t *a, int n) {
+  int i = 0;
+  int64_t acc = (op == SIMD_ADD || !n) ? 0 : a[0];
+#ifdef SIMD_X86
+  if (n && get_simd_level() == LEVEL_AVX2)
+    i = reduce_i64_avx2(op, a, n, &acc);
+#endif
+  for (; i < n; i++)
+    acc = reduce_step(op, acc, a[i]);
+  return acc;
+}
+
+/**
+ * @brief Reduces n doubles with SIMD_ADD, SIMD_MUL, SIMD_MIN or SIMD_MAX.
+ * The vectorized sum and product add up the lanes separately, so the result
+ * can differ from a sequential loop in the last bits. Minimum and maximum
+ * require n > 0.
+ *
+ * @param op SIMD_ADD, SIMD_MUL, SIMD_MIN or SIMD_MAX
+ * @param a elements to reduce
+ * @param n count of elements
+ * @return double
+ */
+double simd_reduce_f64(enum simd_op op, const double *a, int n) {
+  int i = 0;
+  double acc = op == SIMD_ADD ? 0 : op == SIMD_MUL ? 1 : n ? a[0] : 0;
+#ifdef SIMD_X86
+  switch (n ? get_simd_level() : LEVEL_SCALAR) {
+  case LEVEL_AVX2:
+    i = reduce_f64_avx(op, a, n, &acc);
+    break;
+  case LEVEL_SSE41:
+    i = reduce_f64_sse2(op, a, n, &acc);
+    break;
+  default:
+    break;
+  }
+#endif
+  for (; i < n; i++)
+    acc = reduce_step_f64(op, acc, a[i]);
+  return acc;
+}
+
+/**
+ * @brief Counts the 32-bit integers equal to x
+ *
+ * @param a elements to search
+ * @param n count of elements
+ * @param x value to count
+ * @return int
+ */
+int simd_count_eq_i32(const int32_t *a, int n, int32_t x) {
+  int i = 0, count = 0;
+#ifdef SIMD_X86
+  switch (get_simd_level()) {
+  case LEVEL_AVX2:
+    i = count_eq_i32_avx2(a, n, x, &count);
+    break;
+  case LEVEL_SSE41:
+    i = count_eq_i32_sse41(a, n, x, &count);
+    break;
+  default:
+    break;
+  }
+#endif
+  for (; i < n; i++)
+    count += a[i] == x;
+  return count;
+}
+
+/**
+ * @brief Counts the 64-bit integers equal to x
+ *
+ * @param a elements to search
+ * @param n count of elements
+ * @param x value to count
+ * @return int
+ */
+int simd_count_eq_i64(const int64_t *a, int n, int64_t x) {
+  int i = 0, count = 0;
+#ifdef SIMD_X86
+  if (get_simd_level() == LEVEL_AVX2)
+    i = count_eq_i64_avx2(a, n, x, &count);
+#endif
+  for (; i < n; i++)
+    count += a[i] == x;
+  return count;
+}
+
+#ifdef SIMD_X86
+/* there is no packed 64-bit multiply below AVX-512, the low 64 bits of the
+ * product are put together from three 32x32 bit multiplies:
+ * lo(b) * lo(k) + ((hi(b) * lo(k) + lo(b) * hi(k)) << 32) */
+__attribute__((target("avx2"))) static int
+axpy_i64_avx2(int64_t *dst, int64_t k, const int64_t *b, int n) {
+  int i;
+  __m256i k_lo = _mm256_set1_epi64x(k);
+  __m256i k_hi = _mm256_set1_epi64x((int64_t)((uint64_t)k >> 32));
+  __m256i x, cross, r;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    x = _mm256_loadu_si256((const __m256i *)(b + i));
+    cross = _mm256_add_epi64(
+        _mm256_mul_epu32(_mm256_srli_epi64(x, 32), k_lo),
+        _mm256_mul_epu32(x, k_hi));
+    r = _mm256_add_epi64(_mm256_mul_epu32(x, k_lo),
+                         _mm256_slli_epi64(cross, 32));
+    r = _mm256_add_epi64(r, _mm256_loadu_si256((const __m256i *)(dst + i)));
+    _mm256_storeu_si256((__m256i *)(dst + i), r);
+  }
+  return i;
+}
+
+__attribute__((target("sse4.1"))) static int
+axpy_i64_sse41(int64_t *dst, int64_t k, const int64_t *b, int n) {
+  int i;
+  __m128i k_lo = _mm_set1_epi64x(k);
+  __m128i k_hi = _mm_set1_epi64x((int64_t)((uint64_t)k >> 32));
+  __m128i x, cross, r;
+
+  for (i = 0; i + 2 <= n; i += 2) {
+    x = _mm_loadu_si128((const __m128i *)(b + i));
+    cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(x, 32), k_lo),
+                          _mm_mul_epu32(x, k_hi));
+    r = _mm_add_epi64(_mm_mul_epu32(x, k_lo), _mm_slli_epi64(cross, 32));
+    r = _mm_add_epi64(r, _mm_loadu_si128((const __m128i *)(dst + i)));
+    _mm_storeu_si128((__m128i *)(dst + i), r);
+  }
+  return i;
+}
+#endif
+
+/**
+ * @brief Computes dst[i] += k * b[i] for n 64-bit integers, the inner loop of
+ * the matrix product. Uses AVX2 or SSE4.1 when the CPU supports it, scalar
+ * code otherwise. The results wrap around on overflow.
+ *
+ * @param dst accumulated array of n elements
+ * @param k factor applied to every element of b
+ * @param b right operands, must not overlap dst
+ * @param n count of elements
+ */
+void simd_axpy_i64(int64_t *dst, int64_t k, const int64_t *b, int n) {
+  int i = 0;
+#ifdef SIMD_X86
+  switch (get_simd_level()) {
+  case LEVEL_AVX2:
+    i = axpy_i64_avx2(dst, k, b, n);
+    break;
+  case LEVEL_SSE41:
+    i = axpy_i64_sse41(dst, k, b, n);
+    break;
+  default:
+    break;
+  }
+#endif
+  for (; i < n; i++)
+    dst[i] = (int64_t)((uint64_t)dst[i] + (uint64_t)k * (uint64_t)b[i]);
+}
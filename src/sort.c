@@ -0,0 +1,664 @@
+#include "sort.h"
+#include "ast.h"
+#include "bignum.h"
+#include "env.h"
+#include "err.h"
+#include "hash.h"
+#include "macros.h"
+#include "number.h"
+#include "range.h"
+#include "vector.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ranges shorter than this are left to the insertion sort */
+#define INSERTION_THRESHOLD 16
+
+/**
+ * @brief Rank of the node type in the sort order
+ *
+ * @param node to rank
+ * @return int
+ */
+static int type_rank(const astnode *node) {
+  switch (node->type) {
+  case BOOLEAN:
+    return 0;
+  case NUMBER:
+  case BIGNUM:
+  case FLOAT:
+    return 1;
+  case SYMBOL:
+    return 2;
+  case LIST:
+  case RANGE:
+    return 3;
+  case VECTOR:
+    return 4;
+  case MATRIX:
+    return 5;
+  case HEAP:
+    return 6;
+  default:
+    return 7;
+  }
+}
+
+/**
+ * @brief Returns the count of items of a LIST or RANGE node
+ *
+ * @param seq LIST or RANGE type node
+ * @return int
+ */
+static int seq_count(const astnode *seq) {
+  return seq->type == RANGE ? seq->as.range.count : seq->as.list.count;
+}
+
+/**
+ * @brief Returns the i-th item of a LIST or RANGE node, the number of a range
+ * is built in the scratch node
+ *
+ * @param seq LIST or RANGE type node
+ * @param i index of the item
+ * @param scratch node to hold a range element
+ * @return const astnode*
+ */
+static const astnode *seq_item(const astnode *seq, int i, astnode *scratch) {
+  if (seq->type != RANGE)
+    return seq->as.list.children[i];
+  scratch->type = NUMBER;
+  scratch->as.value = range_get(seq, i);
+  return scratch;
+}
+
+/**
+ * @brief Returns the i-th element of a VECTOR node built in the scratch node
+ *
+ * @param vec VECTOR type node
+ * @param i index of the element
+ * @param scratch node to hold the element
+ * @return const astnode*
+ */
+static const astnode *vector_item(const astnode *vec, int i,
+                                  astnode *scratch) {
+  if (vec->as.vector.kind == VEC_F64) {
+    scratch->type = FLOAT;
+    scratch->as.real = vector_get_real(vec, i);
+  } else {
+    scratch->type = NUMBER;
+    scratch->as.value = vector_get(vec, i);
+  }
+  return scratch;
+}
+
+/**
+ * @brief Total order of nodes used for sorting. Nodes are ordered by type
+ * first (booleans, numbers, symbols, lists, vectors, matrices, heaps, hash
+ * tables), then numbers by value whether integer or float, symbols
+ * alphabetically, lists and vectors element by element, matrices by shape and
+ * then element by element and heaps and hash tables by size. Ranges compare
+ * as lists.
+ *
+ * @param a first node
+ * @param b second node
+ * @return int negative if a < b, 0 if equal, positive if a > b
+ */
+int compare_nodes(const astnode *a, const astnode *b) {
+  int rank_a = type_rank(a), rank_b = type_rank(b), cmp, i;
+
+  RETURN_VAL_IF(rank_a != rank_b, rank_a - rank_b);
+
+  switch (a->type) {
+  case BOOLEAN:
+    return (a->as.value > b->as.value) - (a->as.value < b->as.value);
+  case NUMBER:
+  case BIGNUM:
+  case FLOAT:
+    return compare_numbers(a, b);
+  case SYMBOL:
+    return strcmp(a->as.symbol, b->as.symbol);
+  case LIST:
+  case RANGE: {
+    astnode scratch_a = {0}, scratch_b = {0};
+    int count_a = seq_count(a), count_b = seq_count(b);
+    for (i = 0; i < count_a && i < count_b; i++) {
+      cmp = compare_nodes(seq_item(a, i, &scratch_a),
+                          seq_item(b, i, &scratch_b));
+      RETURN_VAL_IF(cmp, cmp);
+    }
+    return (count_a > count_b) - (count_a < count_b);
+  }
+  case VECTOR: {
+    astnode scratch_a = {0}, scratch_b = {0};
+    for (i = 0; i < a->as.vector.count && i < b->as.vector.count; i++) {
+      if (a->as.vector.kind != VEC_F64 && b->as.vector.kind != VEC_F64) {
+        int64_t x = vector_get(a, i), y = vector_get(b, i);
+        RETURN_VAL_IF(x != y, x < y ? -1 : 1);
+        continue;
+      }
+      cmp = compare_numbers(vector_item(a, i, &scratch_a),
+                            vector_item(b, i, &scratch_b));
+      RETURN_VAL_IF(cmp, cmp);
+    }
+    return (a->as.vector.count > b->as.vector.count) -
+           (a->as.vector.count < b->as.vector.count);
+  }
+  case MATRIX: {
+    int64_t count = (int64_t)a->as.matrix.rows * a->as.matrix.cols;
+    RETURN_VAL_IF(a->as.matrix.rows != b->as.matrix.rows,
+                  a->as.matrix.rows < b->as.matrix.rows ? -1 : 1);
+    RETURN_VAL_IF(a->as.matrix.cols != b->as.matrix.cols,
+                  a->as.matrix.cols < b->as.matrix.cols ? -1 : 1);
+    for (int64_t k = 0; k < count; k++) {
+      int64_t x = a->as.matrix.data[k], y = b->as.matrix.data[k];
+      RETURN_VAL_IF(x != y, x < y ? -1 : 1);
+    }
+    return 0;
+  }
+  case HEAP:
+    return (a->as.heap.count > b->as.heap.count) -
+           (a->as.heap.count < b->as.heap.count);
+  case HASH:
+    return (a->as.hash->count > b->as.hash->count) -
+           (a->as.hash->count < b->as.hash->count);
+  }
+  return 0;
+}
+
+/**
+ * @brief Stable LSD radix sort of unsigned 64-bit keys, one byte per pass.
+ * Passes where all keys share the same byte are skipped, so keys of small
+ * magnitude only take a few passes. The payload array, if not NULL, is
+ * permuted together with the keys.
+ *
+ * @param keys to sort
+ * @param payload pointers moved along with the keys or NULL
+ * @param n count of keys
+ * @return err_t
+ */
+static err_t radix_sort_u64(uint64_t *keys, astnode **payload, int n) {
+  err_t retval = ERR_NO_ERROR;
+  int i, pass;
+  size_t counts[8][256] = {{0}}, offset, tmp;
+  uint64_t *src_keys = keys, *dst_keys, *swap_keys;
+  astnode **src_payload = payload, **dst_payload = NULL, **swap_payload;
+
+  RETURN_VAL_IF(n < 2, ERR_NO_ERROR);
+
+  dst_keys = malloc(n * sizeof(uint64_t));
+  if (payload)
+    dst_payload = malloc(n * sizeof(astnode *));
+  CLEANUP_WITH_ERR_IF(!dst_keys || (payload && !dst_payload), cleanup,
+                      ERR_OUT_OF_MEMORY);
+
+  /* histograms of all bytes in a single pass */
+  for (i = 0; i < n; i++)
+    for (pass = 0; pass < 8; pass++)
+      counts[pass][(keys[i] >> (pass * 8)) & 0xff]++;
+
+  for (pass = 0; pass < 8; pass++) {
+    size_t *count = counts[pass];
+    if (count[(keys[0] >> (pass * 8)) & 0xff] == (size_t)n)
+      continue;
+
+    /* exclusive prefix sums give the first slot of every bucket */
+    offset = 0;
+    for (i = 0; i < 256; i++) {
+      tmp = count[i];
+      count[i] = offset;
+      offset += tmp;
+    }
+
+    for (i = 0; i < n; i++) {
+      size_t slot = count[(src_keys[i] >> (pass * 8)) & 0xff]++;
+      dst_keys[slot] = src_keys[i];
+      if (payload)
+        dst_payload[slot] = src_payload[i];
+    }
+
+    swap_keys = src_keys;
+    src_keys = dst_keys;
+    dst_keys = swap_keys;
+    swap_payload = src_payload;
+    src_payload = dst_payload;
+    dst_payload = swap_payload;
+  }
+
+  /* an odd number of passes leaves the result in the scratch buffers */
+  if (src_keys != keys) {
+    memcpy(keys, src_keys, n * sizeof(uint64_t));
+    if (payload)
+      memcpy(payload, src_payload, n * sizeof(astnode *));
+    dst_keys = src_keys;
+    dst_payload = src_payload;
+  }
+cleanup:
+  free(dst_keys);
+  free(dst_payload);
+  return retval;
+}
+
+/**
+ * @brief Maps a signed integer to an unsigned key with the same order
+ *
+ * @param value to map
+ * @return uint64_t
+ */
+static uint64_t to_radix_key(int64_t value) {
+  return (uint64_t)value ^ ((uint64_t)1 << 63);
+}
+
+/**
+ * @brief Maps a double to an unsigned key with the same order, negative
+ * numbers have all bits flipped and positive ones just the sign bit
+ *
+ * @param real to map
+ * @return uint64_t
+ */
+static uint64_t real_to_radix_key(double real) {
+  uint64_t bits;
+  memcpy(&bits, &real, sizeof(bits));
+  return bits >> 63 ? ~bits : bits ^ ((uint64_t)1 << 63);
+}
+
+/**
+ * @brief Inverse of real_to_radix_key
+ *
+ * @param key to map back
+ * @return double
+ */
+static double radix_key_to_real(uint64_t key) {
+  uint64_t bits = key >> 63 ? key ^ ((uint64_t)1 << 63) : ~key;
+  double real;
+  memcpy(&real, &bits, sizeof(real));
+  return real;
+}
+
+/**
+ * @brief Sorts items[lo..hi] by insertion, fast for short ranges
+ *
+ * @param items to sort
+ * @param lo first index
+ * @param hi last index, inclusive
+ */
+static void insertion_sort(astnode **items, int lo, int hi) {
+  for (int i = lo + 1; i <= hi; i++) {
+    astnode *item = items[i];
+    int j = i - 1;
+    while (j >= lo && compare_nodes(items[j], item) > 0) {
+      items[j + 1] = items[j];
+      j--;
+    }
+    items[j + 1] = item;
+  }
+}
+
+/**
+ * @brief Restores the max-heap property below the root of a heap stored in
+ * items[lo..lo+n-1]
+ *
+ * @param items heap array
+ * @param lo first index of the heap
+ * @param root heap index of the node to sift down
+ * @param n count of heap nodes
+ */
+static void sift_down(astnode **items, int lo, int root, int n) {
+  int child;
+  astnode *tmp;
+  while ((child = 2 * root + 1) < n) {
+    if (child + 1 < n &&
+        compare_nodes(items[lo + child], items[lo + child + 1]) < 0)
+      child++;
+    if (compare_nodes(items[lo + root], items[lo + child]) >= 0)
+      return;
+    tmp = items[lo + root];
+    items[lo + root] = items[lo + child];
+    items[lo + child] = tmp;
+    root = child;
+  }
+}
+
+/**
+ * @brief Sorts items[lo..hi] by heap sort, the fallback of introsort when the
+ * quicksort recursion gets too deep
+ *
+ * @param items to sort
+ * @param lo first index
+ * @param hi last index, inclusive
+ */
+static void heap_sort(astnode **items, int lo, int hi) {
+  int n = hi - lo + 1, i;
+  astnode *tmp;
+  for (i = n / 2 - 1; i >= 0; i--)
+    sift_down(items, lo, i, n);
+  for (i = n - 1; i > 0; i--) {
+    tmp = items[lo];
+    items[lo] = items[lo + i];
+    items[lo + i] = tmp;
+    sift_down(items, lo, 0, i);
+  }
+}
+
+/**
+ * @brief Quicksort with median of three pivots, switching to heap sort when
+ * the depth limit runs out. Leaves ranges shorter than INSERTION_THRESHOLD
+ * unsorted for the final insertion sort.
+ *
+ * @param items to sort
+ * @param lo first index
+ * @param hi last index, inclusive
+ * @param depth remaining recursion depth
+ */
+static void introsort_loop(astnode **items, int lo, int hi, int depth) {
+  int i, j, mid;
+  astnode *pivot, *tmp;
+
+  while (hi - lo + 1 > INSERTION_THRESHOLD) {
+    if (!depth--) {
+      heap_sort(items, lo, hi);
+      return;
+    }
+
+    /* order lo, mid, hi and take the middle one as pivot */
+    mid = lo + (hi - lo) / 2;
+    if (compare_nodes(items[mid], items[lo]) < 0) {
+      tmp = items[mid], items[mid] = items[lo], items[lo] = tmp;
+    }
+    if (compare_nodes(items[hi], items[lo]) < 0) {
+      tmp = items[hi], items[hi] = items[lo], items[lo] = tmp;
+    }
+    if (compare_nodes(items[hi], items[mid]) < 0) {
+      tmp = items[hi], items[hi] = items[mid], items[mid] = tmp;
+    }
+    pivot = items[mid];
+
+    /* Hoare partition */
+    i = lo;
+    j = hi;
+    while (i <= j) {
+      while (compare_nodes(items[i], pivot) < 0)
+        i++;
+      while (compare_nodes(items[j], pivot) > 0)
+        j--;
+      if (i <= j) {
+        tmp = items[i], items[i] = items[j], items[j] = tmp;
+        i++;
+        j--;
+      }
+    }
+
+    /* recurse into the smaller part to bound the stack depth */
+    if (j - lo < hi - i) {
+      introsort_loop(items, lo, j, depth);
+      lo = i;
+    } else {
+      introsort_loop(items, i, hi, depth);
+      hi = j;
+    }
+  }
+}
+
+/**
+ * @brief Sorts an array of nodes by compare_nodes using introsort
+ *
+ * @param items to sort
+ * @param n count of items
+ */
+static void introsort(astnode **items, int n) {
+  int depth = 0;
+  for (int size = n; size > 1; size >>= 1)
+    depth += 2;
+  introsort_loop(items, 0, n - 1, depth);
+  insertion_sort(items, 0, n - 1);
+}
+
+/**
+ * @brief Sorts a list whose children are all NUMBER nodes by radix sort
+ *
+ * @param list LIST type node
+ * @return err_t
+ */
+static err_t radix_sort_list(astnode *list) {
+  int n = list->as.list.count;
+  /* also tells the compiler the size below is never negative */
+  RETURN_VAL_IF(n < 2, ERR_NO_ERROR);
+  uint64_t *keys = malloc((size_t)n * sizeof(uint64_t));
+  RETURN_ERR_IF(!keys, ERR_OUT_OF_MEMORY);
+
+  for (int i = 0; i < n; i++)
+    keys[i] = to_radix_key(list->as.list.children[i]->as.value);
+
+  err_t err = radix_sort_u64(keys, list->as.list.children, n);
+  free(keys);
+  return err;
+}
+
+/**
+ * @brief Sorts the elements of a vector by radix sort
+ *
+ * @param vec VECTOR type node
+ * @return err_t
+ */
+static err_t radix_sort_vector(astnode *vec) {
+  int n = vec->as.vector.count;
+  uint64_t *keys = malloc((n ? n : 1) * sizeof(uint64_t));
+  RETURN_ERR_IF(!keys, ERR_OUT_OF_MEMORY);
+
+  int32_t *data32 = vec->as.vector.data;
+  int64_t *data64 = vec->as.vector.data;
+  double *reals = vec->as.vector.data;
+  int i;
+
+  if (vec->as.vector.kind == VEC_INT32) {
+    for (i = 0; i < n; i++)
+      keys[i] = to_radix_key(data32[i]);
+  } else if (vec->as.vector.kind == VEC_F64) {
+    for (i = 0; i < n; i++)
+      keys[i] = real_to_radix_key(reals[i]);
+  } else {
+    for (i = 0; i < n; i++)
+      keys[i] = to_radix_key(data64[i]);
+  }
+
+  err_t err = radix_sort_u64(keys, NULL, n);
+  if (!err) {
+    /* the values come from the vector, so they fit its element type */
+    for (i = 0; i < n; i++) {
+      if (vec->as.vector.kind == VEC_INT32)
+        data32[i] = (int32_t)(keys[i] ^ ((uint64_t)1 << 63));
+      else if (vec->as.vector.kind == VEC_F64)
+        reals[i] = radix_key_to_real(keys[i]);
+      else
+        data64[i] = (int64_t)(keys[i] ^ ((uint64_t)1 << 63));
+    }
+  }
+  free(keys);
+  return err;
+}
+
+/**
+ * @brief Sorts the children of a LIST node or the elements of a VECTOR node
+ * in place. Uses LSD radix sort when all elements are integers and introsort
+ * otherwise. A RANGE node is turned into a list first.
+ *
+ * @param seq LIST, VECTOR or RANGE type node
+ * @param descending sort from the largest if nonzero
+ * @return err_t
+ */
+err_t sort_sequence(astnode *seq, int descending) {
+  /* sanity check */
+  RETURN_ERR_IF(!seq || (seq->type != LIST && seq->type != VECTOR &&
+                          seq->type != RANGE),
+                ERR_INTERNAL);
+
+  err_t err;
+  int i, n, all_numbers = 1;
+
+  /* a range is sorted as the list of its elements */
+  if (seq->type == RANGE) {
+    err = materialize_range(seq);
+    RETURN_ERR_IF(err, err);
+  }
+
+  if (seq->type == VECTOR) {
+    err = radix_sort_vector(seq);
+    RETURN_ERR_IF(err, err);
+    n = seq->as.vector.count;
+    size_t size = vector_elem_size(seq->as.vector.kind);
+    char *data = seq->as.vector.data, tmp[sizeof(int64_t)];
+    for (i = 0; descending && i < n / 2; i++) {
+      memcpy(tmp, data + i * size, size);
+      memcpy(data + i * size, data + (n - 1 - i) * size, size);
+      memcpy(data + (n - 1 - i) * size, tmp, size);
+    }
+    return ERR_NO_ERROR;
+  }
+
+  n = seq->as.list.count;
+  for (i = 0; i < n && all_numbers; i++)
+    all_numbers = seq->as.list.children[i]->type == NUMBER;
+
+  if (all_numbers) {
+    err = radix_sort_list(seq);
+    RETURN_ERR_IF(err, err);
+  } else {
+    introsort(seq->as.list.children, n);
+  }
+
+  for (i = 0; descending && i < n / 2; i++) {
+    astnode *tmp = seq->as.list.children[i];
+    seq->as.list.children[i] = seq->as.list.children[n - 1 - i];
+    seq->as.list.children[n - 1 - i] = tmp;
+  }
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Evaluates the optional descending flag argument of SORT and SORT!
+ *
+ * @param list_node List node containing the operator
+ * @param descending out param, the flag
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+static err_t eval_descending(astnode *list_node, int *descending, env *env) {
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *temp = NULL;
+
+  *descending = 0;
+  RETURN_VAL_IF(list_node->as.list.count < 3, ERR_NO_ERROR);
+
+  err = eval_node(list_node->as.list.children[2], &temp, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(temp->type != BOOLEAN, cleanup, ERR_SYNTAX_ERROR);
+  *descending = temp->as.value;
+
+cleanup:
+  free_temp_node_parts(temp);
+  return retval;
+}
+
+/**
+ * @brief Returns a sorted copy of a list or vector, (sort sequence
+ * [descending]). The copy of a list shares the elements of the original.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the sorted TEMPORARY node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_sort(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 2 || list_node->as.list.count > 3,
+                ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int descending;
+  astnode *seq = NULL, *copy = NULL;
+
+  err = eval_descending(list_node, &descending, env);
+  RETURN_ERR_IF(err, err);
+
+  err = eval_node(list_node->as.list.children[1], &seq, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(seq->type != LIST && seq->type != VECTOR &&
+                          seq->type != RANGE,
+                      fail_cleanup, ERR_SYNTAX_ERROR);
+
+  /* a temporary result is ours to sort, others are copied first */
+  if (seq->origin == TEMPORARY) {
+    copy = seq;
+  } else if (seq->type == VECTOR || seq->type == RANGE) {
+    err = make_deep_copy(seq, &copy, TEMPORARY);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+  } else {
+    /* a new array of the same elements, the original order stays intact */
+    copy = get_list_node();
+    CLEANUP_WITH_ERR_IF(!copy, fail_cleanup, ERR_OUT_OF_MEMORY);
+    copy->origin = TEMPORARY;
+    err = reserve_children(copy, seq->as.list.count);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    if (seq->as.list.count)
+      memcpy(copy->as.list.children, seq->as.list.children,
+             seq->as.list.count * sizeof(astnode *));
+    copy->as.list.count = seq->as.list.count;
+  }
+
+  err = sort_sequence(copy, descending);
+  CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+
+  *result_node = copy;
+  return retval;
+fail_cleanup:
+  if (copy != seq)
+    free_temp_node_parts(copy);
+  free_temp_node_parts(seq);
+  return retval;
+}
+
+/**
+ * @brief Sorts a list or vector variable in place and returns the variable,
+ * (sort! variable [descending]).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the sorted variable node, NULL on
+ * failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_sort_in_place(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 2 || list_node->as.list.count > 3,
+                ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int descending;
+  astnode *var_node = NULL;
+
+  err = eval_descending(list_node, &descending, env);
+  RETURN_ERR_IF(err, err);
+
+  err = eval_node(list_node->as.list.children[1], &var_node, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(var_node->origin != VARIABLE, cleanup,
+                      ERR_NOT_A_VARIABLE);
+  CLEANUP_WITH_ERR_IF(var_node->type != LIST && var_node->type != VECTOR &&
+                          var_node->type != RANGE,
+                      cleanup, ERR_SYNTAX_ERROR);
+
+  err = sort_sequence(var_node, descending);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  *result_node = var_node;
+
+cleanup:
+  free_temp_node_parts(var_node);
+  return retval;
+}
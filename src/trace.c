@@ -0,0 +1,185 @@
+#define _POSIX_C_SOURCE 199309L
+#include "trace.h"
+#include "ast.h"
+#include "err.h"
+#include "macros.h"
+#include "operators.h"
+#include "profile.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static struct trace_event *ring = NULL;
+/* count of events recorded, the next one goes to ring[recorded %
+ * TRACE_RING_EVENTS] */
+static uint64_t recorded = 0;
+static uint64_t start_ns = 0;
+static int traced_depth = 0;
+/* operator calls in progress, also those deeper than traced_depth */
+static int call_depth = 0;
+
+/**
+ * @brief Reads the monotonic clock
+ *
+ * @return uint64_t nanoseconds
+ */
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Stores an event in the ring, overwriting the oldest one when it is
+ * full
+ *
+ * @param phase 'B' or 'E'
+ * @param name operator symbol, static
+ * @param line source line
+ * @param form nonzero for top-level forms
+ */
+static void record(char phase, const char *name, int line, char form) {
+  struct trace_event *event = &ring[recorded++ % TRACE_RING_EVENTS];
+  event->ns = now_ns() - start_ns;
+  event->name = name;
+  event->line = line;
+  event->phase = phase;
+  event->form = form;
+}
+
+/**
+ * @brief Allocates the ring of events and turns tracing on
+ *
+ * @param max_depth deepest operator call traced
+ * @return err_t
+ */
+err_t trace_start(int max_depth) {
+  /* sanity check */
+  RETURN_ERR_IF(max_depth < 0, ERR_INTERNAL);
+
+  free(ring);
+  /* touched once, so recording never faults in pages */
+  ring = calloc(TRACE_RING_EVENTS, sizeof(struct trace_event));
+  RETURN_ERR_IF(!ring, ERR_OUT_OF_MEMORY);
+  recorded = 0;
+  call_depth = 0;
+  traced_depth = max_depth;
+  start_ns = now_ns();
+  profiling |= PROFILE_TRACE;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Records the begin of a top-level form, named by its operator
+ *
+ * @param expr the form
+ */
+void trace_form_begin(const astnode *expr) {
+  const char *name = "atom";
+  int index;
+
+  if (!ring)
+    return;
+  if (expr->type == LIST && expr->as.list.count &&
+      expr->as.list.children[0]->type == SYMBOL) {
+    index = find_operator(expr->as.list.children[0]);
+    name = index < 0 ? "unknown" : operators[index].symbol;
+  }
+  record('B', name, expr->span.line, 1);
+}
+
+/**
+ * @brief Records the end of the top-level form begun last
+ */
+void trace_form_end(void) {
+  if (ring)
+    record('E', NULL, 0, 1);
+}
+
+/**
+ * @brief Enters an operator call, records its begin unless it is deeper than
+ * the traced depth
+ *
+ * @param index of the operator in the operators array
+ * @param list_node List node containing the operator
+ */
+void trace_call_begin(int index, const astnode *list_node) {
+  if (++call_depth <= traced_depth && ring)
+    record('B', operators[index].symbol, list_node->span.line, 0);
+}
+
+/**
+ * @brief Leaves the operator call entered last, records its end unless it is
+ * deeper than the traced depth
+ */
+void trace_call_end(void) {
+  if (call_depth-- <= traced_depth && ring)
+    record('E', NULL, 0, 0);
+}
+
+/**
+ * @brief Writes the events in the ring as Chrome trace_event JSON, loadable
+ * by Perfetto and chrome://tracing. Ends whose begin was overwritten are
+ * left out.
+ *
+ * @param path of the file to write
+ * @return err_t
+ */
+err_t trace_write(const char *path) {
+  /* sanity check */
+  RETURN_ERR_IF(!path || !ring, ERR_INTERNAL);
+
+  err_t retval = ERR_NO_ERROR;
+  uint64_t first = recorded > TRACE_RING_EVENTS ? recorded - TRACE_RING_EVENTS
+                                                : 0;
+  const char *separator = "";
+  int open = 0;
+  FILE *out = fopen(path, "w");
+  RETURN_ERR_IF(!out, ERR_FILE_ACCESS_FAILURE);
+
+  /* operator symbols never contain quotes or backslashes, timestamps are in
+   * microseconds */
+  fprintf(out, "{\"traceEvents\": [");
+  for (uint64_t i = first; i < recorded; i++) {
+    const struct trace_event *event = &ring[i % TRACE_RING_EVENTS];
+    const char *category = event->form ? "form" : "operator";
+
+    if (event->phase == 'B') {
+      open++;
+      fprintf(out,
+              "%s\n  {\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"B\", "
+              "\"ts\": %.3f, \"pid\": 1, \"tid\": 1, \"args\": {\"line\": "
+              "%d}}",
+              separator, event->name, category, event->ns / 1e3, event->line);
+    } else if (open) {
+      open--;
+      fprintf(out,
+              "%s\n  {\"cat\": \"%s\", \"ph\": \"E\", \"ts\": %.3f, "
+              "\"pid\": 1, \"tid\": 1}",
+              separator, category, event->ns / 1e3);
+    } else {
+      continue;
+    }
+    separator = ",";
+  }
+  fprintf(out,
+          "\n], \"displayTimeUnit\": \"ms\", \"otherData\": "
+          "{\"events\": %llu, \"overwritten\": %llu}}\n",
+          (unsigned long long)recorded, (unsigned long long)first);
+  CLEANUP_WITH_ERR_IF(ferror(out), cleanup, ERR_FILE_ACCESS_FAILURE);
+
+cleanup:
+  fclose(out);
+  return retval;
+}
+
+/**
+ * @brief Frees the ring and turns tracing off
+ */
+void trace_stop(void) {
+  free(ring);
+  ring = NULL;
+  profiling &= ~PROFILE_TRACE;
+}
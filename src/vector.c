@@ -0,0 +1,606 @@
+#include "vector.h"
+#include "ast.h"
+#include "env.h"
+#include "err.h"
+#include "macros.h"
+#include "memstats.h"
+#include "number.h"
+#include "range.h"
+#include "simd.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Returns the size of one element of the given vector kind in bytes
+ *
+ * @param kind element type
+ * @return size_t
+ */
+size_t vector_elem_size(enum vector_kind kind) {
+  switch (kind) {
+  case VEC_INT64:
+    return sizeof(int64_t);
+  case VEC_F64:
+    return sizeof(double);
+  default:
+    return sizeof(int32_t);
+  }
+}
+
+/**
+ * @brief Returns the i-th element of an integer VECTOR node, no bounds
+ * checking. Elements of a float vector are truncated.
+ *
+ * @param vec VECTOR type node
+ * @param i index of the element
+ * @return int64_t
+ */
+int64_t vector_get(const astnode *vec, int i) {
+  switch (vec->as.vector.kind) {
+  case VEC_INT64:
+    return ((const int64_t *)vec->as.vector.data)[i];
+  case VEC_F64:
+    return (int64_t)((const double *)vec->as.vector.data)[i];
+  default:
+    return ((const int32_t *)vec->as.vector.data)[i];
+  }
+}
+
+/**
+ * @brief Returns the i-th element of a VECTOR node as a double, no bounds
+ * checking
+ *
+ * @param vec VECTOR type node
+ * @param i index of the element
+ * @return double
+ */
+double vector_get_real(const astnode *vec, int i) {
+  if (vec->as.vector.kind == VEC_F64)
+    return ((const double *)vec->as.vector.data)[i];
+  return (double)vector_get(vec, i);
+}
+
+/**
+ * @brief Returns the i-th element of a VECTOR node as a new NUMBER or FLOAT
+ * node, no bounds checking
+ *
+ * @param vec VECTOR type node
+ * @param i index of the element
+ * @return astnode* with UNSET origin or NULL if memory could not be allocated
+ */
+astnode *vector_get_node(const astnode *vec, int i) {
+  if (vec->as.vector.kind == VEC_F64)
+    return get_float_node(vector_get_real(vec, i));
+  return get_number_node(vector_get(vec, i));
+}
+
+/**
+ * @brief Converts a 32-bit vector to 64-bit elements in place
+ *
+ * @param vec VECTOR type node
+ * @return err_t
+ */
+err_t vector_widen(astnode *vec) {
+  /* sanity check */
+  RETURN_ERR_IF(!vec || vec->type != VECTOR, ERR_INTERNAL);
+  RETURN_VAL_IF(vec->as.vector.kind != VEC_INT32, ERR_NO_ERROR);
+
+  int count = vec->as.vector.count;
+  int32_t *old = vec->as.vector.data;
+  int64_t *wide = malloc((count ? count : 1) * sizeof(int64_t));
+  RETURN_ERR_IF(!wide, ERR_OUT_OF_MEMORY);
+
+  for (int i = 0; i < count; i++)
+    wide[i] = old[i];
+
+  free(old);
+  mem_charge(MEM_NODES,
+             (count ? count : 1) * (sizeof(int64_t) - sizeof(int32_t)));
+  vec->as.vector.data = wide;
+  vec->as.vector.kind = VEC_INT64;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Converts an integer vector to double elements in place
+ *
+ * @param vec VECTOR type node
+ * @return err_t
+ */
+err_t vector_to_float(astnode *vec) {
+  /* sanity check */
+  RETURN_ERR_IF(!vec || vec->type != VECTOR, ERR_INTERNAL);
+  RETURN_VAL_IF(vec->as.vector.kind == VEC_F64, ERR_NO_ERROR);
+
+  int count = vec->as.vector.count;
+  double *reals = malloc((count ? count : 1) * sizeof(double));
+  RETURN_ERR_IF(!reals, ERR_OUT_OF_MEMORY);
+
+  for (int i = 0; i < count; i++)
+    reals[i] = (double)vector_get(vec, i);
+
+  /* an INT32 vector doubles its bytes, an INT64 one keeps them */
+  if (vec->as.vector.kind == VEC_INT32)
+    mem_charge(MEM_NODES,
+               (count ? count : 1) * (sizeof(double) - sizeof(int32_t)));
+  free(vec->as.vector.data);
+  vec->as.vector.data = reals;
+  vec->as.vector.kind = VEC_F64;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Stores the value into the i-th element of a VECTOR node.
+ * A 32-bit vector is widened to 64 bits if the value does not fit, a float
+ * vector stores the value converted to double.
+ *
+ * @param vec VECTOR type node
+ * @param i index of the element, must be in bounds
+ * @param value to store
+ * @return err_t
+ */
+err_t vector_set(astnode *vec, int i, int64_t value) {
+  /* sanity check */
+  RETURN_ERR_IF(!vec || vec->type != VECTOR, ERR_INTERNAL);
+  RETURN_ERR_IF(i < 0 || i >= vec->as.vector.count, ERR_INTERNAL);
+
+  err_t err;
+  if (vec->as.vector.kind == VEC_F64) {
+    ((double *)vec->as.vector.data)[i] = (double)value;
+    return ERR_NO_ERROR;
+  }
+  if (vec->as.vector.kind == VEC_INT32 &&
+      (value < INT32_MIN || value > INT32_MAX)) {
+    err = vector_widen(vec);
+    RETURN_ERR_IF(err, err);
+  }
+
+  if (vec->as.vector.kind == VEC_INT64)
+    ((int64_t *)vec->as.vector.data)[i] = value;
+  else
+    ((int32_t *)vec->as.vector.data)[i] = (int32_t)value;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Stores a NUMBER or FLOAT node into the i-th element of a VECTOR node.
+ * An integer vector is converted to doubles when a FLOAT is stored.
+ *
+ * @param vec VECTOR type node
+ * @param i index of the element, must be in bounds
+ * @param value NUMBER or FLOAT node
+ * @return err_t
+ */
+err_t vector_set_node(astnode *vec, int i, const astnode *value) {
+  /* sanity check */
+  RETURN_ERR_IF(!vec || vec->type != VECTOR || !value, ERR_INTERNAL);
+  RETURN_ERR_IF(i < 0 || i >= vec->as.vector.count, ERR_INTERNAL);
+  RETURN_ERR_IF(value->type != NUMBER && value->type != FLOAT,
+                ERR_SYNTAX_ERROR);
+
+  err_t err;
+  RETURN_VAL_IF(value->type == NUMBER, vector_set(vec, i, value->as.value));
+
+  err = vector_to_float(vec);
+  RETURN_ERR_IF(err, err);
+  ((double *)vec->as.vector.data)[i] = value->as.real;
+  return ERR_NO_ERROR;
+}
+
+/**
+ * @brief Converts a LIST node of NUMBER or FLOAT nodes into a new VECTOR node,
+ * a float vector if any item is a FLOAT.
+ * Fails with syntax error when any item is not a number.
+ *
+ * @param list LIST type node
+ * @param out_node out param, the new vector with UNSET origin
+ * @return err_t
+ */
+err_t list_to_vector(const astnode *list, astnode **out_node) {
+  /* sanity check */
+  RETURN_ERR_IF(!list || list->type != LIST || !out_node, ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int count = list->as.list.count;
+  astnode *vec = get_vector_node(VEC_INT32, count);
+  RETURN_ERR_IF(!vec, ERR_OUT_OF_MEMORY);
+
+  for (int i = 0; i < count; i++) {
+    err = vector_set_node(vec, i, list->as.list.children[i]);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+  }
+
+  *out_node = vec;
+  return ERR_NO_ERROR;
+fail_cleanup:
+  free_node(vec);
+  return retval;
+}
+
+/**
+ * @brief Creates a new vector. Called either with a count and an optional
+ * initial value (make-vector 10 0), or with a list or range of numbers to
+ * pack (make-vector '(1 2 3)).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result VECTOR node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_make_vector(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 2 || list_node->as.list.count > 3,
+                ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  err_t err, retval = ERR_NO_ERROR;
+  int count;
+  int64_t init = 0;
+  double real_init = 0;
+  enum vector_kind kind = VEC_INT32;
+  astnode *temp = NULL, *vec = NULL;
+
+  err = eval_node(list_node->as.list.children[1], &temp, env);
+  RETURN_ERR_IF(err, err);
+
+  /* pack a list of numbers */
+  if (temp->type == LIST) {
+    CLEANUP_WITH_ERR_IF(list_node->as.list.count != 2, cleanup,
+                        ERR_SYNTAX_ERROR);
+    err = list_to_vector(temp, &vec);
+    CLEANUP_WITH_ERR_IF(err, cleanup, err);
+    goto done;
+  }
+
+  /* pack the elements of a range */
+  if (temp->type == RANGE) {
+    CLEANUP_WITH_ERR_IF(list_node->as.list.count != 2, cleanup,
+                        ERR_SYNTAX_ERROR);
+    /* ranges are monotonic, the ends decide the element type */
+    int n = temp->as.range.count;
+    int64_t first = n ? range_get(temp, 0) : 0;
+    int64_t last = n ? range_get(temp, n - 1) : 0;
+    kind = first < INT32_MIN || first > INT32_MAX || last < INT32_MIN ||
+                   last > INT32_MAX
+               ? VEC_INT64
+               : VEC_INT32;
+    vec = get_vector_node(kind, n);
+    CLEANUP_WITH_ERR_IF(!vec, cleanup, ERR_OUT_OF_MEMORY);
+    for (int i = 0; i < n; i++) {
+      if (kind == VEC_INT64)
+        ((int64_t *)vec->as.vector.data)[i] = range_get(temp, i);
+      else
+        ((int32_t *)vec->as.vector.data)[i] = (int32_t)range_get(temp, i);
+    }
+    goto done;
+  }
+
+  CLEANUP_WITH_ERR_IF(temp->type != NUMBER || temp->as.value < 0 ||
+                          temp->as.value > INT_MAX,
+                      cleanup, ERR_SYNTAX_ERROR);
+  count = (int)temp->as.value;
+  free_temp_node_parts(temp);
+  temp = NULL;
+
+  if (list_node->as.list.count == 3) {
+    err = eval_node(list_node->as.list.children[2], &temp, env);
+    RETURN_ERR_IF(err, err);
+    CLEANUP_WITH_ERR_IF(temp->type != NUMBER && temp->type != FLOAT, cleanup,
+                        ERR_SYNTAX_ERROR);
+    if (temp->type == FLOAT) {
+      real_init = temp->as.real;
+      kind = VEC_F64;
+    } else {
+      init = temp->as.value;
+      if (init < INT32_MIN || init > INT32_MAX)
+        kind = VEC_INT64;
+    }
+  }
+
+  vec = get_vector_node(kind, count);
+  CLEANUP_WITH_ERR_IF(!vec, cleanup, ERR_OUT_OF_MEMORY);
+  if (kind == VEC_F64) {
+    double *data = vec->as.vector.data;
+    for (int i = 0; i < count; i++)
+      data[i] = real_init;
+  } else if (init && kind == VEC_INT64) {
+    int64_t *data = vec->as.vector.data;
+    for (int i = 0; i < count; i++)
+      data[i] = init;
+  } else if (init) {
+    int32_t *data = vec->as.vector.data;
+    for (int i = 0; i < count; i++)
+      data[i] = (int32_t)init;
+  }
+
+done:
+  vec->origin = TEMPORARY;
+  *result_node = vec;
+cleanup:
+  free_temp_node_parts(temp);
+  return retval;
+}
+
+/**
+ * @brief Returns the element of a vector at the index as a NUMBER or FLOAT
+ * node, (aref vector index).
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result NUMBER or FLOAT node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_aref(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  int index;
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *vec = NULL, *temp = NULL;
+
+  err = eval_node(list_node->as.list.children[1], &vec, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(vec->type != VECTOR, cleanup, ERR_SYNTAX_ERROR);
+
+  err = eval_node(list_node->as.list.children[2], &temp, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  CLEANUP_WITH_ERR_IF(temp->type != NUMBER, cleanup, ERR_SYNTAX_ERROR);
+  CLEANUP_WITH_ERR_IF(temp->as.value < 0 ||
+                          temp->as.value >= vec->as.vector.count,
+                      cleanup, ERR_SYNTAX_ERROR);
+  index = (int)temp->as.value;
+
+  *result_node = vector_get_node(vec, index);
+  CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
+  (*result_node)->origin = TEMPORARY;
+
+cleanup:
+  free_temp_node_parts(vec);
+  free_temp_node_parts(temp);
+  return retval;
+}
+
+/**
+ * @brief Assigns to a vector element, (set (aref vector index) value).
+ * Called by SET, as vector elements are not nodes that could be replaced.
+ * The vector must be a variable.
+ * @param list_node List node of the SET operator
+ * @param result_node out param pointer to the stored NUMBER or FLOAT node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_set_aref(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count != 3, ERR_SYNTAX_ERROR);
+
+  astnode *place = list_node->as.list.children[1];
+  RETURN_ERR_IF(place->type != LIST || place->as.list.count != 3,
+                ERR_SYNTAX_ERROR);
+
+  int index;
+  err_t err, retval = ERR_NO_ERROR;
+  astnode *vec = NULL, *temp = NULL;
+
+  err = eval_node(place->as.list.children[1], &vec, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(vec->type != VECTOR, cleanup, ERR_SYNTAX_ERROR);
+  CLEANUP_WITH_ERR_IF(vec->origin != VARIABLE, cleanup, ERR_NOT_A_VARIABLE);
+
+  err = eval_node(place->as.list.children[2], &temp, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+  CLEANUP_WITH_ERR_IF(temp->type != NUMBER, cleanup, ERR_SYNTAX_ERROR);
+  CLEANUP_WITH_ERR_IF(temp->as.value < 0 ||
+                          temp->as.value >= vec->as.vector.count,
+                      cleanup, ERR_SYNTAX_ERROR);
+  index = (int)temp->as.value;
+  free_temp_node_parts(temp);
+  temp = NULL;
+
+  err = eval_node(list_node->as.list.children[2], &temp, env);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+  err = vector_set_node(vec, index, temp);
+  CLEANUP_WITH_ERR_IF(err, cleanup, err);
+
+  *result_node = vector_get_node(vec, index);
+  CLEANUP_WITH_ERR_IF(!*result_node, cleanup, ERR_OUT_OF_MEMORY);
+  (*result_node)->origin = TEMPORARY;
+
+cleanup:
+  free_temp_node_parts(vec);
+  free_temp_node_parts(temp);
+  return retval;
+}
+
+/**
+ * @brief Fills a buffer of the given kind with values of the operand, so it
+ * can be passed to the packed kernels. The operand is either a NUMBER or
+ * FLOAT node repeated count times or a VECTOR node of count elements.
+ *
+ * @param operand NUMBER, FLOAT or VECTOR node
+ * @param kind element type of the buffer
+ * @param count number of elements
+ * @return void* newly allocated buffer or NULL if out of memory
+ */
+static void *make_operand_buffer(const astnode *operand, enum vector_kind kind,
+                                 int count) {
+  void *buff = malloc((count ? count : 1) * vector_elem_size(kind));
+  RETURN_NULL_IF(!buff);
+
+  if (kind == VEC_F64) {
+    for (int i = 0; i < count; i++)
+      ((double *)buff)[i] = operand->type == VECTOR ? vector_get_real(operand, i)
+                                                    : to_real(operand);
+    return buff;
+  }
+
+  for (int i = 0; i < count; i++) {
+    int64_t value = operand->type == NUMBER ? operand->as.value
+                                            : vector_get(operand, i);
+    if (kind == VEC_INT64)
+      ((int64_t *)buff)[i] = value;
+    else
+      ((int32_t *)buff)[i] = (int32_t)value;
+  }
+  return buff;
+}
+
+/**
+ * @brief Checks whether V+, V- or V* of an int32 vector and an integer
+ * operand has a result outside of int32
+ *
+ * @param op of the element-wise operation
+ * @param acc int32 vector, the left operand
+ * @param operand NUMBER or int32 VECTOR node, the right operand
+ * @return int 1 if any result needs int64, 0 otherwise
+ */
+static int i32_result_overflows(enum simd_op op, const astnode *acc,
+                                const astnode *operand) {
+  const int32_t *left = acc->as.vector.data, *right = NULL;
+  int64_t a, b, value = 0;
+
+  if (op == SIMD_MIN || op == SIMD_MAX)
+    return 0;
+  if (operand->type == VECTOR)
+    right = operand->as.vector.data;
+  else
+    value = operand->as.value;
+
+  for (int i = 0; i < acc->as.vector.count; i++) {
+    a = left[i];
+    b = right ? right[i] : value;
+    /* products of two int32 values always fit int64 */
+    a = op == SIMD_ADD ? a + b : op == SIMD_SUB ? a - b : a * b;
+    if (a < INT32_MIN || a > INT32_MAX)
+      return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Element-wise V+, V-, V*, VMIN and VMAX of vectors. The first argument
+ * must be a vector, the others vectors of the same length or NUMBER or FLOAT
+ * nodes applied to every element. Returns a new vector, a float vector if any
+ * operand is a float and an int64 vector if any operand or result does not
+ * fit int32.
+ * @param list_node List node containing the operator
+ * @param result_node out param pointer to the result VECTOR node with
+ * TEMPORARY origin, NULL on failure
+ * @param env The environment for variable lookup and evaluation
+ * @return err_t
+ */
+err_t oper_vec_arith(astnode *list_node, astnode **result_node, env *env) {
+  /* sanity check */
+  RETURN_ERR_IF(!list_node || list_node->type != LIST || !env || !result_node,
+                ERR_INTERNAL);
+  RETURN_ERR_IF(list_node->as.list.count < 3, ERR_SYNTAX_ERROR);
+  for (int i = 0; i < list_node->as.list.count; i++)
+    RETURN_ERR_IF(!list_node->as.list.children[i], ERR_INTERNAL);
+
+  const char *symbol = list_node->as.list.children[0]->as.symbol;
+  enum simd_op op;
+  if (!strcmp(symbol, "V+"))
+    op = SIMD_ADD;
+  else if (!strcmp(symbol, "V-"))
+    op = SIMD_SUB;
+  else if (!strcmp(symbol, "V*"))
+    op = SIMD_MUL;
+  else if (!strcmp(symbol, "VMIN"))
+    op = SIMD_MIN;
+  else if (!strcmp(symbol, "VMAX"))
+    op = SIMD_MAX;
+  else
+    return ERR_INTERNAL;
+
+  err_t err, retval = ERR_NO_ERROR;
+  int count;
+  void *operand = NULL;
+  astnode *acc = NULL, *temp = NULL;
+
+  err = eval_node(list_node->as.list.children[1], &temp, env);
+  RETURN_ERR_IF(err, err);
+  CLEANUP_WITH_ERR_IF(temp->type != VECTOR, fail_cleanup, ERR_SYNTAX_ERROR);
+
+  /* accumulate into the first vector if it is ours, otherwise into a copy */
+  if (temp->origin == TEMPORARY) {
+    acc = temp;
+  } else {
+    err = make_deep_copy(temp, &acc, TEMPORARY);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+  }
+  temp = NULL;
+  count = acc->as.vector.count;
+
+  for (int i = 2; i < list_node->as.list.count; i++) {
+    err = eval_node(list_node->as.list.children[i], &temp, env);
+    CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    CLEANUP_WITH_ERR_IF(temp->type != NUMBER && temp->type != FLOAT &&
+                            temp->type != VECTOR,
+                        fail_cleanup, ERR_SYNTAX_ERROR);
+    CLEANUP_WITH_ERR_IF(temp->type == VECTOR &&
+                            temp->as.vector.count != count,
+                        fail_cleanup, ERR_SYNTAX_ERROR);
+
+    /* compute in doubles if any operand is a float, else in 64 bits if any
+     * operand needs it */
+    if ((temp->type == VECTOR && temp->as.vector.kind == VEC_F64) ||
+        temp->type == FLOAT) {
+      err = vector_to_float(acc);
+      CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    } else if ((temp->type == VECTOR &&
+                temp->as.vector.kind == VEC_INT64) ||
+               (temp->type == NUMBER &&
+                (temp->as.value < INT32_MIN || temp->as.value > INT32_MAX))) {
+      err = vector_widen(acc);
+      CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    }
+    /* int32 results that do not fit are computed in 64 bits instead */
+    if (acc->as.vector.kind == VEC_INT32 &&
+        i32_result_overflows(op, acc, temp)) {
+      err = vector_widen(acc);
+      CLEANUP_WITH_ERR_IF(err, fail_cleanup, err);
+    }
+
+    if (temp->type == VECTOR && temp->as.vector.kind == acc->as.vector.kind) {
+      operand = NULL;
+    } else {
+      operand = make_operand_buffer(temp, acc->as.vector.kind, count);
+      CLEANUP_WITH_ERR_IF(!operand, fail_cleanup, ERR_OUT_OF_MEMORY);
+    }
+
+    if (acc->as.vector.kind == VEC_F64)
+      simd_binop_f64(op, acc->as.vector.data, acc->as.vector.data,
+                     operand ? operand : temp->as.vector.data, count);
+    else if (acc->as.vector.kind == VEC_INT64)
+      simd_binop_i64(op, acc->as.vector.data, acc->as.vector.data,
+                     operand ? operand : temp->as.vector.data, count);
+    else
+      simd_binop_i32(op, acc->as.vector.data, acc->as.vector.data,
+                     operand ? operand : temp->as.vector.data, count);
+
+    free(operand);
+    operand = NULL;
+    free_temp_node_parts(temp);
+    temp = NULL;
+  }
+
+  *result_node = acc;
+  return retval;
+fail_cleanup:
+  free(operand);
+  free_temp_node_parts(temp);
+  free_temp_node_parts(acc);
+  return retval;
+}
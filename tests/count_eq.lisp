@@ -0,0 +1,8 @@
+(print (count-if-eq 1.0 (list 1 2 1.0 'a)))
+(print (count-if-eq 1 (list 1 2 1.0)))
+(print (count-if-eq 2.0 (range 0 5)))
+(print (count-if-eq 2.5 (range 0 5)))
+(print (count-if-eq 3.0 (make-vector '(1 2 3 3))))
+(print (count-if-eq 3 (make-vector '(1.0 3.0 3.0))))
+(print (count-if-eq 3000000000.0 (make-vector '(3000000000 1))))
+(print (count-if-eq 'a (list 'a 1 'a)))
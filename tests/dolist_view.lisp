@@ -0,0 +1,15 @@
+(set 'xs '(1 2 3))
+(dolist (x (cdr xs)) (push xs 4 5 6 7 8 9) (print x))
+(print xs)
+(set 'xs '(1 2 3))
+(dolist (x (cdr xs)) (set 'xs 5) (print x))
+(print xs)
+(set 'xs '(1 (2 3) 4))
+(dolist (x (nthcdr 1 xs)) (set 'xs '(0)) (print x))
+(set 'xs '(1 2 3))
+(dolist (xs (cdr xs)) (print xs))
+(set 'l (list 1 2 3))
+(dolist (x l) (set 'l (make-matrix 2 3)) (print x))
+(set 'l (list 1 2 3))
+(dolist (x l) (push l x))
+(print l)
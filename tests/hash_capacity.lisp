@@ -0,0 +1,4 @@
+(set 'h (make-hash 100))
+(set (gethash 'a h) 1)
+(print (gethash 'a h))
+(print (make-hash 939524096))
@@ -0,0 +1,14 @@
+(set 'l (list 1 2))
+(print (= (nth 0 l) (set 'l 1)))
+(set 'b 1)
+(print (= b (inc b 1)))
+(set 'c 1)
+(print (< c (inc c 1) 3))
+(set 'd 5)
+(print (max d (dec d 1) 2))
+(set 'e 100000000000000000000)
+(print (= e (inc e 1)))
+(set 'a 1)
+(print (/= a (inc a 1)))
+(set 'l (list 1 2))
+(print (/= (nth 0 l) (set 'l 1) 3))
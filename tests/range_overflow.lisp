@@ -0,0 +1,5 @@
+(print (sum (range -9223372036854775807 9223372036854775807 1000000000000)))
+(print (nth 18446744 (range -9223372036854775807 9223372036854775807 1000000000000)))
+(print (length (range 9223372036854775807 -9223372036854775807 -1000000000000)))
+(print (length (range 0 2147483647)))
+(print (range 0 2147483648))
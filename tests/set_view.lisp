@@ -0,0 +1,6 @@
+(set 'l (list 1 2 3))
+(print (list (cdr l) (set 'l (list 7 8))))
+(print l)
+(set 'l (list (list 1 2) 3 4))
+(print (list (cdr l) (set 'l 5) (cdr (list 6 7))))
+(print l)
@@ -0,0 +1,5 @@
+(print (v* (make-vector '(65536 2)) (make-vector '(65536 2))))
+(print (v+ (make-vector 1 2147483647) 1))
+(print (v- (make-vector 1 -2147483648) 1))
+(print (v+ (make-vector '(2147483646 -5)) 1))
+(print (vmax (make-vector '(2147483647 1)) (make-vector '(5 -2147483648))))
@@ -0,0 +1,7 @@
+(set 'l '(1 2 3 4))
+(print (list (cdr l) (push l 7 8 9 10 11 12 13 14 15 16 17)))
+(print (list (nthcdr 2 l) (push l 18 19 20 21 22 23 24 25 26 27 28 29 30 31 32 33 34) (cdr l)))
+(set 'm '(1 2 3))
+(set 'm (cdr m))
+(print (list (cdr m) (push m 4 5 6 7 8 9 10 11 12)))
+(print l)